@@ -6,6 +6,7 @@
 #include "GLTFBuffer.h"
 #include "GLTFMaterial.h"
 #include <iostream>
+#include <future>
 #include <glm/gtx/string_cast.hpp>
 
 GLTFLoader::GLTFLoader() : skeleton(meshManager, nodeManager, accessorManager, bufferManager) {
@@ -21,6 +22,10 @@ GLTFLoader::~GLTFLoader() {
     // Destructor implementation (if needed)
 }
 
+void GLTFLoader::setImportSettings(const ImportSettings& settings) {
+    importSettings = settings;
+}
+
 void GLTFLoader::loadModel(const std::string& filepath) {
     std::string ext = getFileExtension(filepath);
 
@@ -263,8 +268,20 @@ void GLTFLoader::parseGLTF(yyjson_val* root, const std::string& basePath) {
     if (nodes_val && yyjson_is_arr(nodes_val)) {
         std::cout << "Parsing nodes..." << std::endl;
         nodeManager.parseNodes(nodes_val);
+
+        // Nodes no channel targets never move; the node pass caches them and skips their subtrees
+        std::vector<int> animatedNodes;
+        for (const auto& animation : animationManager.getAnimations()) {
+            for (const auto& channel : animation.channels) animatedNodes.push_back(channel.targetNode);
+        }
+        nodeManager.setAnimatedNodes(animatedNodes);
     }
 
+    // Key reduction budgets errors down the node hierarchy, so the clip stages run once the nodes are in
+    if (importSettings.reduceAnimationKeys) animationManager.reduceKeys(importSettings.keyReduction, nodeManager);
+    if (importSettings.compressAnimations) animationManager.compressAnimations(importSettings.animationCompression);
+    animationManager.resampleAnimations(importSettings.animationSampleRate);
+
     yyjson_val* meshes_val = yyjson_obj_get(root, "meshes");
     if (meshes_val && yyjson_is_arr(meshes_val)) {
         std::cout << "Parsing meshes..." << std::endl;
@@ -277,6 +294,16 @@ void GLTFLoader::parseGLTF(yyjson_val* root, const std::string& basePath) {
         meshManager.parseSkins(skins_val);
     }
 
+    buildRestPose();
+    animationBlender.initialize(animationManager, restPose);
+
+    // The node manager's transform arrays are addressed by flat position; resolve it once, not per frame
+    animatedSlots.clear();
+    for (int node : animationBlender.getAnimatedNodes()) {
+        int flat = nodeManager.getFlatIndex(node);
+        if (flat >= 0) animatedSlots.emplace_back(node, flat);
+    }
+
     yyjson_val* materials_val = yyjson_obj_get(root, "materials");
     yyjson_val* textures_val = yyjson_obj_get(root, "textures");
     yyjson_val* images_val = yyjson_obj_get(root, "images");
@@ -290,9 +317,415 @@ void GLTFLoader::parseGLTF(yyjson_val* root, const std::string& basePath) {
     }
 
     skeleton.initializeSkeleton();
+    optimizeGeometry();
+    buildSceneBounds();
+    if (importSettings.buildRaycastBVH) buildRaycastBVHs();
+
+    // Bone capsules live in the skinned mesh's model space; remember which node carries it
+    skeleton.buildBoneProxies(importSettings.boneProxyMinWeight);
+    skinnedNode = -1;
+    const auto& nodes = nodeManager.getNodes();
+    const auto& geometryPerMesh = skeleton.getPrimitiveGeometry();
+    for (size_t i = 0; i < nodes.size() && skinnedNode < 0; ++i) {
+        auto it = geometryPerMesh.find(nodes[i].meshIndex);
+        if (it == geometryPerMesh.end()) continue;
+        for (const auto& geometry : it->second) {
+            if (!geometry.jointBounds.empty()) skinnedNode = static_cast<int>(i);
+        }
+    }
+}
+
+void GLTFLoader::buildRestPose() {
+    const auto& nodes = nodeManager.getNodes();
+    const auto& meshes = meshManager.getMeshes();
+    const size_t nodeCount = nodes.size();
+    restPose.translations.resize(nodeCount);
+    restPose.rotations.resize(nodeCount);
+    restPose.scales.resize(nodeCount);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        restPose.translations[i] = nodeManager.getNodeTranslation(static_cast<int>(i));
+        restPose.rotations[i] = nodeManager.getNodeRotation(static_cast<int>(i));
+        restPose.scales[i] = nodeManager.getNodeScale(static_cast<int>(i));
+    }
+
+    // One weight per morph target of each node's mesh, from the node's weights or else the mesh's
+    restPose.morphWeights.clear();
+    restPose.morphWeightOffsets.assign(1, 0);
+    for (const auto& node : nodes) {
+        if (node.meshIndex >= 0 && node.meshIndex < static_cast<int>(meshes.size())) {
+            const auto& mesh = meshes[node.meshIndex];
+            size_t targetCount = 0;
+            for (const auto& primitive : mesh.primitives) targetCount = std::max(targetCount, primitive.morphTargets.size());
+            const std::vector<float>& defaults = node.weights.empty() ? mesh.weights : node.weights;
+            for (size_t t = 0; t < targetCount; ++t) restPose.morphWeights.push_back(t < defaults.size() ? defaults[t] : 0.0f);
+        }
+        restPose.morphWeightOffsets.push_back(static_cast<unsigned int>(restPose.morphWeights.size()));
+    }
+    if (restPose.morphWeights.empty()) restPose.morphWeightOffsets.clear();
 }
 
+std::unordered_map<int, std::vector<float>> GLTFLoader::computeLargestMorphWeights() const {
+    // Blending between clips stays within these; additive layers can push past them
+    std::unordered_map<int, std::vector<float>> largestPerMesh;
+    const auto& nodes = nodeManager.getNodes();
+    const auto& offsets = restPose.morphWeightOffsets;
+    std::vector<float> largest;
+    for (size_t node = 0; node + 1 < offsets.size() && node < nodes.size(); ++node) {
+        if (offsets[node + 1] == offsets[node]) continue;
+        largest.assign(offsets[node + 1] - offsets[node], 0.0f);
+        for (size_t t = 0; t < largest.size(); ++t) largest[t] = std::abs(restPose.morphWeights[offsets[node] + t]);
+        for (const auto& animation : animationManager.getAnimations()) {
+            for (const auto& binding : animation.bindings.weights) {
+                const auto& sampler = animation.samplers[binding.sampler];
+                if (binding.target == static_cast<int>(node) && sampler.valuesPerKey == largest.size()) {
+                    GLTFAnimation::growWeightRange(sampler, largest);
+                }
+            }
+        }
+        auto& meshLargest = largestPerMesh[nodes[node].meshIndex];
+        meshLargest.resize(std::max(meshLargest.size(), largest.size()), 0.0f);
+        for (size_t t = 0; t < largest.size(); ++t) meshLargest[t] = std::max(meshLargest[t], largest[t]);
+    }
+    return largestPerMesh;
+}
+
+void GLTFLoader::optimizeGeometry() {
+    const auto largestMorphWeights = computeLargestMorphWeights();
+    const std::vector<float> noMorphWeights;
+    auto& geometryPerMesh = skeleton.getPrimitiveGeometry();
+    for (auto& meshPair : geometryPerMesh) {
+        for (size_t primitiveIndex = 0; primitiveIndex < meshPair.second.size(); ++primitiveIndex) {
+            auto& geometry = meshPair.second[primitiveIndex];
+            if (geometry.indices.empty()) continue;
+
+            // Welding compares only the bind-pose attributes, so it could merge vertices that their morph
+            // targets move apart
+            const bool morphed = !geometry.morphTargets.empty();
+            if (importSettings.weldVertices && !morphed) {
+                size_t verticesBefore = geometry.vertices.size();
+                size_t indicesBefore = geometry.indices.size();
+                GLTFMeshOptimizer::weldVertices(geometry.vertices, geometry.indices, importSettings.weldEpsilon);
+                size_t degenerateTriangles = GLTFMeshOptimizer::removeDegenerateTriangles(geometry.vertices, geometry.indices);
+                GLTFMeshOptimizer::removeUnusedVertices(geometry.vertices, geometry.indices);
+
+                std::cout << "Mesh [" << meshPair.first << "] Primitive [" << primitiveIndex << "] weld: vertices "
+                    << verticesBefore << " -> " << geometry.vertices.size() << ", indices " << indicesBefore << " -> "
+                    << geometry.indices.size() << " (" << degenerateTriangles << " degenerate triangles)" << std::endl;
+                if (geometry.indices.empty()) continue;
+            }
+
+            size_t vertexCount = geometry.vertices.size();
+            unsigned int cacheSize = importSettings.vertexCacheSize;
+            auto cacheBefore = GLTFMeshOptimizer::analyzeVertexCache(geometry.indices, vertexCount, cacheSize);
+            GLTFMeshOptimizer::OverdrawStats overdrawBefore;
+            if (importSettings.optimizeOverdraw) {
+                overdrawBefore = GLTFMeshOptimizer::analyzeOverdraw(geometry.vertices, geometry.indices);
+            }
+
+            if (importSettings.optimizeVertexCache) {
+                GLTFMeshOptimizer::optimizeVertexCache(geometry.indices, vertexCount, cacheSize);
+            }
 
+            if (importSettings.optimizeOverdraw) {
+                GLTFMeshOptimizer::optimizeOverdraw(geometry.indices, geometry.vertices, cacheSize, importSettings.overdrawThreshold);
+                auto overdrawAfter = GLTFMeshOptimizer::analyzeOverdraw(geometry.vertices, geometry.indices);
+
+                std::cout << "Mesh [" << meshPair.first << "] Primitive [" << primitiveIndex << "] overdraw: "
+                    << overdrawBefore.overdraw << " -> " << overdrawAfter.overdraw << std::endl;
+            }
+
+            // Meshlet bounds and normal cones are fixed at the bind shape, which morphing changes
+            if (importSettings.buildMeshlets && !morphed) {
+                GLTFMeshlets::build(geometry, importSettings.meshletMaxVertices, importSettings.meshletMaxTriangles);
+                std::cout << "Mesh [" << meshPair.first << "] Primitive [" << primitiveIndex << "] meshlets: "
+                    << geometry.meshlets.size() << std::endl;
+            }
+
+            if (importSettings.optimizeVertexCache || importSettings.optimizeOverdraw || importSettings.buildMeshlets) {
+                std::vector<unsigned int> remap = GLTFMeshOptimizer::optimizeVertexFetch(geometry.vertices, geometry.indices);
+                GLTFMorphTargets::remapTargets(geometry.morphTargets, remap);
+                auto cacheAfter = GLTFMeshOptimizer::analyzeVertexCache(geometry.indices, vertexCount, cacheSize);
+
+                std::cout << "Mesh [" << meshPair.first << "] Primitive [" << primitiveIndex << "] vertex cache"
+                    << " ACMR: " << cacheBefore.acmr << " -> " << cacheAfter.acmr
+                    << ", ATVR: " << cacheBefore.atvr << " -> " << cacheAfter.atvr << std::endl;
+            }
+
+            // LODs are simplified from the final full-detail indices so they share its vertex order
+            geometry.lods.clear();
+            float extent = GLTFSimplifier::getMeshExtent(geometry.vertices, geometry.indices);
+            size_t targetIndexCount = geometry.indices.size();
+            for (unsigned int level = 1; level <= importSettings.lodLevels; ++level) {
+                targetIndexCount = static_cast<size_t>(targetIndexCount * importSettings.lodReduction) / 3 * 3;
+                if (targetIndexCount == 0) break;
+
+                float error = 0.0f;
+                GLTFMesh::Lod lod;
+                lod.indices = GLTFSimplifier::simplify(geometry.vertices, geometry.indices, targetIndexCount, importSettings.lodMaxError, &error);
+                lod.error = error * extent;
+
+                // Stop once the error bound or locked seams keep a level from getting meaningfully smaller
+                size_t previousCount = geometry.lods.empty() ? geometry.indices.size() : geometry.lods.back().indices.size();
+                if (lod.indices.empty() || lod.indices.size() > previousCount * 9 / 10) break;
+
+                if (importSettings.optimizeVertexCache) {
+                    GLTFMeshOptimizer::optimizeVertexCache(lod.indices, vertexCount, cacheSize);
+                }
+
+                std::cout << "Mesh [" << meshPair.first << "] Primitive [" << primitiveIndex << "] LOD " << level << ": "
+                    << lod.indices.size() / 3 << " triangles, error " << lod.error << std::endl;
+                targetIndexCount = lod.indices.size();
+                geometry.lods.push_back(std::move(lod));
+            }
+
+            auto largest = largestMorphWeights.find(meshPair.first);
+            GLTFMesh::computeBounds(geometry, largest != largestMorphWeights.end() ? largest->second : noMorphWeights);
+        }
+    }
+}
+
+AABB GLTFLoader::computeNodeLocalBounds(int node) const {
+    // Skinned primitives are bounded in whatever pose the joint matrices currently hold
+    AABB bounds;
+    const auto& geometryPerMesh = skeleton.getPrimitiveGeometry();
+    auto it = geometryPerMesh.find(nodeManager.getNodes()[node].meshIndex);
+    if (it == geometryPerMesh.end()) return bounds;
+    for (const auto& geometry : it->second) {
+        bounds.merge(GLTFMesh::getSkinnedBounds(geometry.bounds, geometry.jointBounds, skeleton.getJointMatrices()));
+    }
+    return bounds;
+}
+
+void GLTFLoader::buildSceneBounds() {
+    const auto& nodes = nodeManager.getNodes();
+    const auto& geometryPerMesh = skeleton.getPrimitiveGeometry();
+    nodeLocalBounds.resize(nodes.size());
+    skinnedBoundsNodes.clear();
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        nodeLocalBounds[i] = computeNodeLocalBounds(static_cast<int>(i));
+        auto it = geometryPerMesh.find(nodes[i].meshIndex);
+        if (it == geometryPerMesh.end()) continue;
+        for (const auto& geometry : it->second) {
+            if (!geometry.jointBounds.empty()) {
+                skinnedBoundsNodes.push_back(static_cast<int>(i));
+                break;
+            }
+        }
+    }
+    nodeManager.propagateBounds(nodeLocalBounds);
+
+    std::vector<AABB> itemBounds(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        itemBounds[i] = nodes[i].worldBounds;
+    }
+    sceneBVH.build(itemBounds);
+    if (!sceneBVH.isEmpty()) sceneBVH.printStats();
+}
+
+void GLTFLoader::updateSceneBounds() {
+    // World transforms are current: the animation update runs the node pass before skinning. Only nodes
+    // that moved in that pass, and skinned nodes when a bone moved, are touched.
+    const auto& changed = nodeManager.getChangedNodes();
+    if (changed.empty()) return;
+
+    const auto& nodes = nodeManager.getNodes();
+    const auto& order = nodeManager.getTopologicalOrder();
+    refitNodes.clear();
+    bool bonesMoved = false;
+    for (int flat : changed) {
+        int node = order[flat];
+        bonesMoved = bonesMoved || skeleton.getBoneIndex(node) >= 0;
+        if (!nodeLocalBounds[node].isEmpty()) refitNodes.push_back(node);
+    }
+    if (bonesMoved) {
+        for (int node : skinnedBoundsNodes) {
+            nodeLocalBounds[node] = computeNodeLocalBounds(node);
+            refitNodes.push_back(node);
+        }
+    }
+    nodeManager.refitBounds(nodeLocalBounds, refitNodes);
+
+    // Moving nodes only refit their branch; a node that gained geometry needs a rebuild
+    bool rebuild = sceneBVH.isEmpty();
+    for (size_t i = 0; i < refitNodes.size() && !rebuild; ++i) {
+        const AABB& bounds = nodes[refitNodes[i]].worldBounds;
+        if (!sceneBVH.updateItem(refitNodes[i], bounds) && !bounds.isEmpty()) rebuild = true;
+    }
+
+    if (rebuild) {
+        std::vector<AABB> itemBounds(nodes.size());
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            itemBounds[i] = nodes[i].worldBounds;
+        }
+        sceneBVH.build(itemBounds);
+    }
+    else {
+        sceneBVH.refit();
+    }
+}
+
+void GLTFLoader::buildRaycastBVHs() {
+    const auto& geometryPerMesh = skeleton.getPrimitiveGeometry();
+    raycastBVHs.clear();
+    for (const auto& meshPair : geometryPerMesh) {
+        raycastBVHs[meshPair.first].resize(meshPair.second.size());
+    }
+
+    // One task per primitive; each build also splits its large subtrees across threads
+    std::vector<std::future<void>> builds;
+    for (const auto& meshPair : geometryPerMesh) {
+        auto& bvhs = raycastBVHs[meshPair.first];
+        for (size_t primitiveIndex = 0; primitiveIndex < meshPair.second.size(); ++primitiveIndex) {
+            const auto& geometry = meshPair.second[primitiveIndex];
+            GLTFTriangleBVH& bvh = bvhs[primitiveIndex];
+            builds.push_back(std::async(std::launch::async, [&geometry, &bvh] {
+                std::vector<glm::vec3> positions(geometry.vertices.size());
+                for (size_t i = 0; i < positions.size(); ++i) {
+                    positions[i] = geometry.vertices[i].position;
+                }
+                bvh.build(positions, geometry.indices);
+            }));
+        }
+    }
+    for (auto& build : builds) build.get();
+
+    for (const auto& meshPair : raycastBVHs) {
+        for (size_t primitiveIndex = 0; primitiveIndex < meshPair.second.size(); ++primitiveIndex) {
+            std::cout << "Mesh [" << meshPair.first << "] Primitive [" << primitiveIndex << "] raycast BVH: "
+                << meshPair.second[primitiveIndex].getNodeCount() << " nodes" << std::endl;
+        }
+    }
+    raycastPoseDirty = true; // the BVHs hold the bind pose
+}
+
+void GLTFLoader::updateRaycastPose() {
+    const auto& geometryPerMesh = skeleton.getPrimitiveGeometry();
+    const auto& jointMatrices = skeleton.getJointMatrices();
+    raycastPoseDirty = false;
+    if (jointMatrices.empty()) return;
+
+    for (auto& meshPair : raycastBVHs) {
+        auto it = geometryPerMesh.find(meshPair.first);
+        if (it == geometryPerMesh.end()) continue;
+        for (size_t primitiveIndex = 0; primitiveIndex < meshPair.second.size(); ++primitiveIndex) {
+            const auto& geometry = it->second[primitiveIndex];
+            if (geometry.jointBounds.empty()) continue; // not skinned, the bind pose is the pose
+            GLTFMesh::skinPositions(geometry.vertices, jointMatrices, skinnedPositions);
+            meshPair.second[primitiveIndex].refit(skinnedPositions);
+        }
+    }
+}
+
+bool GLTFLoader::traceRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RayHit* hit) {
+    float length = glm::length(direction);
+    if (!(length > 0.0f) || raycastBVHs.empty()) return false;
+    if (raycastPoseDirty) updateRaycastPose();
+
+    const glm::vec3 worldDirection = direction / length;
+    rayItems.clear();
+    sceneBVH.queryRay(origin, worldDirection, maxDistance, rayItems);
+
+    const auto& nodes = nodeManager.getNodes();
+    float closest = maxDistance;
+    bool found = false;
+    for (const auto& item : rayItems) {
+        if (item.distance >= closest) break; // sorted by entry distance, nothing further can be closer
+
+        auto bvhs = raycastBVHs.find(nodes[item.item].meshIndex);
+        if (bvhs == raycastBVHs.end()) continue;
+
+        // Affine transforms keep the ray parameter, so local hits are already world distances
+        glm::mat4 worldToLocal = glm::inverse(nodeManager.getGlobalTransform(item.item));
+        glm::vec3 localOrigin = glm::vec3(worldToLocal * glm::vec4(origin, 1.0f));
+        glm::vec3 localDirection = glm::vec3(worldToLocal * glm::vec4(worldDirection, 0.0f));
+
+        for (size_t primitiveIndex = 0; primitiveIndex < bvhs->second.size(); ++primitiveIndex) {
+            const GLTFTriangleBVH& bvh = bvhs->second[primitiveIndex];
+            if (!hit) {
+                if (bvh.intersectAny(localOrigin, localDirection, closest)) return true;
+                continue;
+            }
+
+            GLTFTriangleBVH::Hit triangleHit;
+            if (bvh.intersect(localOrigin, localDirection, closest, triangleHit)) {
+                closest = triangleHit.distance;
+                found = true;
+                hit->node = item.item;
+                hit->mesh = nodes[item.item].meshIndex;
+                hit->primitive = static_cast<int>(primitiveIndex);
+                hit->triangle = triangleHit.triangle;
+                hit->barycentrics = triangleHit.barycentrics;
+            }
+        }
+    }
+
+    if (found) {
+        hit->distance = closest;
+        hit->position = origin + worldDirection * closest;
+    }
+    return found;
+}
+
+bool GLTFLoader::raycast(const glm::vec3& origin, const glm::vec3& direction, RayHit& hit, float maxDistance) {
+    return traceRay(origin, direction, maxDistance, &hit);
+}
+
+bool GLTFLoader::isOccluded(const glm::vec3& from, const glm::vec3& to) {
+    // Stop just short of the target so a point on a surface does not occlude itself
+    float distance = glm::length(to - from);
+    return traceRay(from, to - from, distance * 0.9999f, nullptr);
+}
+
+bool GLTFLoader::raycastBones(const glm::vec3& origin, const glm::vec3& direction, GLTFBoneProxies::Hit& hit, float maxDistance) const {
+    float length = glm::length(direction);
+    if (!(length > 0.0f)) return false;
+    glm::vec3 worldDirection = direction / length;
+
+    glm::mat4 worldToModel = skinnedNode >= 0 ? glm::inverse(nodeManager.getGlobalTransform(skinnedNode)) : glm::mat4(1.0f);
+    glm::vec3 modelOrigin = glm::vec3(worldToModel * glm::vec4(origin, 1.0f));
+    glm::vec3 modelDirection = glm::vec3(worldToModel * glm::vec4(worldDirection, 0.0f));
+
+    // Model units per world unit along the ray converts distances both ways
+    float modelScale = glm::length(modelDirection);
+    float modelMaxDistance = maxDistance < FLT_MAX ? maxDistance * modelScale : FLT_MAX;
+    if (!skeleton.getBoneProxies().raycast(modelOrigin, modelDirection, modelMaxDistance, hit)) return false;
+    hit.distance /= modelScale;
+    return true;
+}
+
+void GLTFLoader::overlapBones(const glm::vec3& center, float radius, std::vector<int>& bones) const {
+    glm::mat4 worldToModel = skinnedNode >= 0 ? glm::inverse(nodeManager.getGlobalTransform(skinnedNode)) : glm::mat4(1.0f);
+
+    // Largest axis scale keeps the sphere conservative if the node is not uniformly scaled
+    float scale = 0.0f;
+    for (int axis = 0; axis < 3; ++axis) {
+        scale = std::max(scale, glm::length(glm::vec3(worldToModel[axis])));
+    }
+    skeleton.getBoneProxies().overlapSphere(glm::vec3(worldToModel * glm::vec4(center, 1.0f)), radius * scale, bones);
+}
+
+const GLTFSceneBVH& GLTFLoader::getSceneBVH() const {
+    return sceneBVH;
+}
+
+AABB GLTFLoader::getSceneBounds() const {
+    const auto& bvhNodes = sceneBVH.getNodes();
+    return bvhNodes.empty() ? AABB() : bvhNodes[sceneBVH.getRoot()].bounds;
+}
+
+GLTFMeshOptimizer::OverdrawStats GLTFLoader::analyzeOverdraw(int meshIndex, int primitiveIndex) const {
+    const auto& geometryPerMesh = skeleton.getPrimitiveGeometry();
+    auto it = geometryPerMesh.find(meshIndex);
+    if (it == geometryPerMesh.end() || primitiveIndex < 0 || static_cast<size_t>(primitiveIndex) >= it->second.size()) {
+        throw std::out_of_range("Invalid mesh or primitive index");
+    }
+
+    const auto& geometry = it->second[primitiveIndex];
+    auto stats = GLTFMeshOptimizer::analyzeOverdraw(geometry.vertices, geometry.indices);
+    std::cout << "Mesh [" << meshIndex << "] Primitive [" << primitiveIndex << "] overdraw: " << stats.overdraw
+        << " (" << stats.pixelsShaded << " shaded / " << stats.pixelsCovered << " covered)" << std::endl;
+    return stats;
+}
 
 void GLTFLoader::loadExternalBuffer(const std::string& uri, const std::string& basePath) {
     std::ifstream file(uri, std::ios::binary | std::ios::ate);
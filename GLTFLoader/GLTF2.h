@@ -6,10 +6,12 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <span>
 #include <vector>
 #include "yyjson.h"
 #include "GLTFAccessor.h"
 #include "GLTFAnimation.h"
+#include "GLTFAnimationBlender.h"
 #include "GLTFNode.h"
 #include "GLTFMesh.h"
 #include "GLTFBuffer.h"
@@ -20,16 +22,81 @@
 #include "Camera.h"
 #include <unordered_map>
 #include "GLTFSkeleton.h"
+#include "GLTFMeshOptimizer.h"
+#include "GLTFSimplifier.h"
+#include "GLTFMeshlets.h"
+#include "GLTFSceneBVH.h"
+#include "GLTFFrustumCuller.h"
+#include "GLTFTriangleBVH.h"
 
 class GLTFLoader {
 public:
+    // Import stages run once on the decoded primitives before anything is uploaded
+    struct ImportSettings {
+        bool weldVertices = true;
+        float weldEpsilon = 0.0f;         // 0 welds only bit-identical vertices
+        bool optimizeVertexCache = true;
+        unsigned int vertexCacheSize = 16;
+        bool optimizeOverdraw = true;
+        float overdrawThreshold = 1.05f; // allowed ACMR regression while sorting clusters for overdraw
+        unsigned int lodLevels = 3;       // simplified levels generated below the full-detail mesh
+        float lodReduction = 0.5f;        // triangle count of each level relative to the previous one
+        float lodMaxError = 0.05f;        // stop simplifying past this deviation, relative to the mesh extent
+        bool buildMeshlets = true;
+        unsigned int meshletMaxVertices = 64;
+        unsigned int meshletMaxTriangles = 124;
+        bool buildRaycastBVH = true;      // per-primitive triangle BVHs for raycast() and pick()
+        float boneProxyMinWeight = 0.3f;  // skin weight a vertex needs to shape a bone's capsule
+        float animationSampleRate = 0.0f; // bake clips to this many frames per second for search-free playback; 0 keeps the keys
+        bool reduceAnimationKeys = false; // drop keys that interpolation reproduces within keyReduction's tolerances
+        GLTFAnimation::KeyReductionSettings keyReduction;
+        bool compressAnimations = false;  // quantize LINEAR tracks that fit animationCompression's error budgets
+        GLTFAnimation::CompressionSettings animationCompression;
+    };
+
+    struct RayHit {
+        int node = -1;
+        int mesh = -1;
+        int primitive = -1;
+        int triangle = -1;                        // into the primitive's full-detail triangle list
+        glm::vec2 barycentrics = glm::vec2(0.0f); // weights of the triangle's second and third vertex
+        float distance = FLT_MAX;                 // world units from the ray origin
+        glm::vec3 position = glm::vec3(0.0f);
+    };
+
     GLTFLoader();  // Default constructor
     ~GLTFLoader(); // Destructor
+    // The skeleton and the animation blender point into this object's own managers and rest pose, and the
+    // GL objects are released by the destructor, so a loader stays where it was constructed
+    GLTFLoader(const GLTFLoader&) = delete;
+    GLTFLoader& operator=(const GLTFLoader&) = delete;
+    GLTFLoader(GLTFLoader&&) = delete;
+    GLTFLoader& operator=(GLTFLoader&&) = delete;
+
+    void setImportSettings(const ImportSettings& settings);
+    void setLodPixelError(float pixels); // allowed on-screen deviation before a finer LOD is drawn
+    void setClusterCulling(bool enabled);
+    void setFrustumCulling(bool enabled);
+    const GLTFFrustumCuller::Stats& getCullStats() const; // draw items of the last rendered frame
 
     void loadModel(const std::string& filepath);
     void printAnimationNames() const;
     void printMeshData();
     void printMaterialData();
+    GLTFMeshOptimizer::OverdrawStats analyzeOverdraw(int meshIndex, int primitiveIndex) const;
+    const GLTFSceneBVH& getSceneBVH() const; // items are node indices
+    AABB getSceneBounds() const;
+
+    // Ray queries against the current pose. Skinned primitives are skinned on the CPU the first time they
+    // are queried after the animation has moved them.
+    bool raycast(const glm::vec3& origin, const glm::vec3& direction, RayHit& hit, float maxDistance = FLT_MAX);
+    bool isOccluded(const glm::vec3& from, const glm::vec3& to);
+    // Ray through a window position in pixels (origin at the top left), from the camera
+    bool pick(float windowX, float windowY, RayHit& hit);
+    // Same queries against the bone capsules, for hit detection where triangles are too costly. World space;
+    // hit.distance is in world units.
+    bool raycastBones(const glm::vec3& origin, const glm::vec3& direction, GLTFBoneProxies::Hit& hit, float maxDistance = FLT_MAX) const;
+    void overlapBones(const glm::vec3& center, float radius, std::vector<int>& bones) const;
 
     std::vector<glm::vec3> getPositions() const;
     std::vector<glm::vec3> getNormals() const;
@@ -40,8 +107,19 @@ public:
     glm::mat4 getNodeHierarchyTransform(int nodeIndex) const;
     void initialize();
     void render();
+    // Draws the loaded geometry in another pose: world matrices by node index and a skinning palette, all
+    // placed by modelTransform. How model instances share one set of GL buffers.
+    void renderPose(const std::vector<glm::mat4>& nodeWorlds, std::span<const glm::mat4> jointMatrices, const glm::mat4& modelTransform);
+
+    // Read-only access to the parsed model, for building shared assets
+    const GLTFNode& getNodeManager() const;
+    const GLTFSkeleton& getSkeleton() const;
+    const GLTFAnimation& getAnimationManager() const;
+    const GLTFAnimation::Pose& getRestPose() const; // node TRS and morph weights as loaded
 
     void setAnimation(const std::string& animationName);
+    void crossfadeAnimation(const std::string& animationName, float fadeTime);
+    GLTFAnimationBlender& getAnimationBlender(); // layers; changes show after the next updateAnimation
     void updateAnimation(float deltaTime);
 
 private:
@@ -55,6 +133,13 @@ private:
         uint32_t length;
     };
 
+    // Slice of the shared element buffer; level 0 is the full-detail mesh
+    struct LodRange {
+        size_t firstIndex;
+        size_t indexCount;
+        float error; // model units
+    };
+
     struct PrimitiveBuffers {
         GLuint vao;
         GLuint vboPositions;
@@ -66,23 +151,46 @@ private:
         GLuint vboJoints;
         size_t indexCount;
         int materialIndex;
-        glm::mat4 transform;
+        glm::mat4 transform;  // world transform of nodeIndex at load; draws use the pose they are given
+        int nodeIndex = -1;
+        std::vector<LodRange> lodRanges;
+        std::vector<GLTFMesh::Meshlet> meshlets; // cover the full-detail range only
+        std::vector<int> meshletJoints;
+        AABB bounds; // model space, bind pose
+        std::vector<GLTFMesh::JointBounds> jointBounds;
+        GLTFMorphTargets morphTargets; // blends the vertices streamed to vboPositions; empty if unmorphed
     };
 
     std::vector<Buffer> buffers;
     GLTFAccessor accessorManager;
     GLTFAnimation animationManager;
+    GLTFAnimationBlender animationBlender;
+    GLTFAnimation::Pose restPose; // node TRS and morph weights as loaded, by node index
+    std::vector<std::pair<int, int>> animatedSlots; // the blender's animated nodes as (node index, flat position)
     GLTFNode nodeManager;
     GLTFMesh meshManager;
     GLTFBuffer bufferManager;
     GLTFMaterial materialManager;
     GLTFSkeleton skeleton;
+    GLTFSceneBVH sceneBVH;
+    std::vector<AABB> nodeLocalBounds;
+    std::vector<int> skinnedBoundsNodes; // nodes whose local bounds follow the joint matrices
+    std::vector<int> refitNodes;         // per-frame scratch
+    std::unordered_map<int, std::vector<GLTFTriangleBVH>> raycastBVHs; // parallel to the skeleton's primitive geometry
+    std::vector<GLTFSceneBVH::RayItem> rayItems;                       // per-query scratch
+    std::vector<glm::vec3> skinnedPositions;
+    bool raycastPoseDirty = true;
+    int skinnedNode = -1; // places the bone proxies in the world
 
     std::vector<glm::vec3> positions;
     std::vector<glm::vec3> normals;
     std::vector<glm::vec2> texcoords;
     std::vector<unsigned int> indices;
     std::unordered_map<int, GLuint> textureIDMap;
+    ImportSettings importSettings;
+    float lodPixelError = 1.0f;
+    bool clusterCulling = true;
+    bool frustumCulling = true;
 
     std::string getFileExtension(const std::string& filepath);
     void loadGLBModel(const std::string& filepath);
@@ -91,6 +199,16 @@ private:
     void loadExternalBuffer(const std::string& uri, const std::string& basePath);
     void printGLBHeaderInfo(const GLBHeader& header);
     void printChunkInfo(uint32_t chunkLength, uint32_t chunkType, size_t chunkDataSize);
+    void buildRestPose();
+    // By mesh index: the largest |weight| each morph target takes in the rest pose or any weights channel
+    std::unordered_map<int, std::vector<float>> computeLargestMorphWeights() const;
+    void optimizeGeometry();
+    AABB computeNodeLocalBounds(int node) const;
+    void buildSceneBounds();
+    void updateSceneBounds();
+    void buildRaycastBVHs();
+    void updateRaycastPose();
+    bool traceRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RayHit* hit);
 
     // renderer private variables
     GLuint vao;
@@ -100,10 +218,21 @@ private:
     GLuint eboIndices;
     GLuint shaderProgram;
     std::vector<PrimitiveBuffers> primitiveBuffers;
+    std::vector<GLTFMeshlets::IndexRange> visibleRanges; // per-frame scratch for cluster culling
+    std::vector<GLsizei> drawCounts;
+    std::vector<const void*> drawOffsets;
+    GLTFFrustumCuller frustumCuller;     // one box per primitiveBuffers entry
+    std::vector<unsigned int> visibleDrawItems;
+    std::vector<glm::mat4> drawTransforms; // per primitiveBuffers entry, for the pose being drawn
+    std::vector<glm::mat4> ownNodeWorlds;  // render()'s own pose, gathered from the node manager
+    GLTFFrustumCuller::Stats cullStats;
 
     void initBuffers();
-    void setupVertexArrayObject(PrimitiveBuffers& buffers, const GLTFMesh::Primitive& primitive, int meshIndex);
-    void checkVerts(const GLTFMesh::Primitive& primitive, int meshIndex);
+    const LodRange& selectLod(const PrimitiveBuffers& buffers, const glm::mat4& modelView, float projectionScale) const;
+    void setupVertexArrayObject(PrimitiveBuffers& buffers, const GLTFMesh::Primitive& primitive, int meshIndex, int primitiveIndex);
+    // Re-blends a morphed primitive for its node's weights in pose and streams it, if they changed
+    void updateMorphTargets(PrimitiveBuffers& buffers, const GLTFAnimation::Pose& pose);
+    void checkVerts(const GLTFMesh::Primitive& primitive, int meshIndex, int primitiveIndex);
     //void checkVerts(const GLTFMesh::Primitive& primitive);
     void initializeShaders();
     void initializeTextures();
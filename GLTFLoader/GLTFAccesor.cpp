@@ -10,9 +10,6 @@ void GLTFAccessor::parseAccessors(yyjson_val* accessorsArray) {
 
         yyjson_val* bufferView_val = yyjson_obj_get(accessor_val, "bufferView");
         accessor.bufferView = bufferView_val ? yyjson_get_int(bufferView_val) : -1;
-        if (accessor.bufferView == -1) {
-            std::cerr << "Warning: Accessor [" << idx << "] has an invalid or missing bufferView." << std::endl;
-        }
 
         yyjson_val* byteOffset_val = yyjson_obj_get(accessor_val, "byteOffset");
         accessor.byteOffset = byteOffset_val ? yyjson_get_uint(byteOffset_val) : 0;
@@ -43,7 +40,7 @@ void GLTFAccessor::parseAccessors(yyjson_val* accessorsArray) {
             size_t max_idx, max_max;
             yyjson_val* val;
             yyjson_arr_foreach(max_val, max_idx, max_max, val) {
-                accessor.max.push_back(glm::vec3(yyjson_get_real(val)));
+                accessor.max.push_back(static_cast<float>(yyjson_get_num(val)));
             }
         }
 
@@ -52,14 +49,23 @@ void GLTFAccessor::parseAccessors(yyjson_val* accessorsArray) {
             size_t min_idx, min_max;
             yyjson_val* val;
             yyjson_arr_foreach(min_val, min_idx, min_max, val) {
-                accessor.min.push_back(glm::vec3(yyjson_get_real(val)));
+                accessor.min.push_back(static_cast<float>(yyjson_get_num(val)));
             }
         }
 
         yyjson_val* sparse_val = yyjson_obj_get(accessor_val, "sparse");
-        accessor.sparse = sparse_val ? yyjson_get_bool(sparse_val) : false;
+        accessor.sparse = sparse_val && yyjson_is_obj(sparse_val);
         if (accessor.sparse) {
-            std::cerr << "Warning: Accessor [" << idx << "] has sparse data which is not yet handled." << std::endl;
+            parseSparse(accessor.sparseData, sparse_val);
+            if (accessor.sparseData.indicesBufferView < 0 || accessor.sparseData.valuesBufferView < 0) {
+                std::cerr << "Warning: Accessor [" << idx << "] has sparse data with missing indices or values." << std::endl;
+                accessor.sparse = false;
+            }
+        }
+
+        // A sparse accessor may omit bufferView, in which case the base data is all zeros
+        if (accessor.bufferView == -1 && !accessor.sparse) {
+            std::cerr << "Warning: Accessor [" << idx << "] has an invalid or missing bufferView." << std::endl;
         }
 
         yyjson_val* name_val = yyjson_obj_get(accessor_val, "name");
@@ -77,6 +83,32 @@ void GLTFAccessor::parseAccessors(yyjson_val* accessorsArray) {
     }
 }
 
+void GLTFAccessor::parseSparse(Sparse& sparse, yyjson_val* sparse_val) {
+    yyjson_val* count_val = yyjson_obj_get(sparse_val, "count");
+    sparse.count = count_val ? yyjson_get_uint(count_val) : 0;
+
+    yyjson_val* indices_val = yyjson_obj_get(sparse_val, "indices");
+    if (indices_val && yyjson_is_obj(indices_val)) {
+        yyjson_val* bufferView_val = yyjson_obj_get(indices_val, "bufferView");
+        sparse.indicesBufferView = bufferView_val ? yyjson_get_int(bufferView_val) : -1;
+
+        yyjson_val* byteOffset_val = yyjson_obj_get(indices_val, "byteOffset");
+        sparse.indicesByteOffset = byteOffset_val ? yyjson_get_uint(byteOffset_val) : 0;
+
+        yyjson_val* componentType_val = yyjson_obj_get(indices_val, "componentType");
+        sparse.indicesComponentType = componentType_val ? yyjson_get_int(componentType_val) : -1;
+    }
+
+    yyjson_val* values_val = yyjson_obj_get(sparse_val, "values");
+    if (values_val && yyjson_is_obj(values_val)) {
+        yyjson_val* bufferView_val = yyjson_obj_get(values_val, "bufferView");
+        sparse.valuesBufferView = bufferView_val ? yyjson_get_int(bufferView_val) : -1;
+
+        yyjson_val* byteOffset_val = yyjson_obj_get(values_val, "byteOffset");
+        sparse.valuesByteOffset = byteOffset_val ? yyjson_get_uint(byteOffset_val) : 0;
+    }
+}
+
 void GLTFAccessor::parseBufferViews(yyjson_val* bufferViewsArray) {
     std::cout << "Parsing Buffer Views..." << std::endl; // Debug message
 
@@ -170,9 +202,21 @@ void GLTFAccessor::printAccessorInfo(const Accessor& accessor, size_t index) {
     std::cout << "Normalized: " << (accessor.normalized ? "true" : "false") << std::endl;
     std::cout << "Count: " << accessor.count << std::endl;
     std::cout << "Type: " << getTypeName(accessor.type) << std::endl;
-    std::cout << "Max: " << (accessor.max.empty() ? "N/A" : glm::to_string(accessor.max[0])) << std::endl;
-    std::cout << "Min: " << (accessor.min.empty() ? "N/A" : glm::to_string(accessor.min[0])) << std::endl;
+    std::cout << "Max:";
+    if (accessor.max.empty()) std::cout << " N/A";
+    for (float value : accessor.max) std::cout << " " << value;
+    std::cout << std::endl;
+    std::cout << "Min:";
+    if (accessor.min.empty()) std::cout << " N/A";
+    for (float value : accessor.min) std::cout << " " << value;
+    std::cout << std::endl;
     std::cout << "Sparse: " << (accessor.sparse ? "true" : "false") << std::endl;
+    if (accessor.sparse) {
+        std::cout << "  Sparse Count: " << accessor.sparseData.count << std::endl;
+        std::cout << "  Sparse Indices Buffer View: " << accessor.sparseData.indicesBufferView << std::endl;
+        std::cout << "  Sparse Indices Component Type: " << getComponentTypeName(accessor.sparseData.indicesComponentType) << std::endl;
+        std::cout << "  Sparse Values Buffer View: " << accessor.sparseData.valuesBufferView << std::endl;
+    }
     std::cout << "Name: " << accessor.name << std::endl;
 }
 
@@ -12,6 +12,15 @@
 
 class GLTFAccessor {
 public:
+    struct Sparse {
+        size_t count = 0;
+        int indicesBufferView = -1;
+        size_t indicesByteOffset = 0;
+        int indicesComponentType = -1;
+        int valuesBufferView = -1;
+        size_t valuesByteOffset = 0;
+    };
+
     struct Accessor {
         int bufferView;
         size_t byteOffset;
@@ -19,9 +28,10 @@ public:
         bool normalized;
         size_t count;
         std::string type;
-        std::vector<glm::vec3> max;
-        std::vector<glm::vec3> min;
+        std::vector<float> max; // one value per component
+        std::vector<float> min;
         bool sparse;
+        Sparse sparseData; // only valid when sparse is true
         std::string name;
         yyjson_val* extensions;
         yyjson_val* extras;
@@ -54,6 +64,7 @@ private:
     std::vector<BufferView> bufferViews;
     std::vector<Buffer> buffers;
 
+    void parseSparse(Sparse& sparse, yyjson_val* sparse_val);
     void printAccessorInfo(const Accessor& accessor, size_t index);
     void printBufferViewInfo(const BufferView& bufferView, size_t index);
     void printBufferInfo(const Buffer& buffer, size_t index);
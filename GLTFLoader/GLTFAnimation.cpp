@@ -1,6 +1,9 @@
 #include "GLTFAnimation.h"
 #include <iostream>
 #include "GLTFSkeleton.h"
+#include <chrono>
+#include <random>
+#include <cfloat>
 
 void GLTFAnimation::parseAnimations(yyjson_val* animationsArray, const GLTFAccessor& accessorManager, const GLTFBuffer& bufferManager) {
     std::cout << "Parsing Animations..." << std::endl;
@@ -33,6 +36,7 @@ void GLTFAnimation::parseAnimations(yyjson_val* animationsArray, const GLTFAcces
                         channel.targetNode = -1;
                     }
                     channel.targetPath = yyjson_get_str(yyjson_obj_get(target_val, "path"));
+                    channel.path = parseTargetPath(channel.targetPath);
                 }
                 channel.extensions = yyjson_obj_get(channel_val, "extensions");
                 channel.extras = yyjson_obj_get(channel_val, "extras");
@@ -41,13 +45,24 @@ void GLTFAnimation::parseAnimations(yyjson_val* animationsArray, const GLTFAcces
         }
 
         if (samplers_val) {
+            // What each sampler drives decides how its output is decoded; one pass over the channels
+            std::vector<TargetPath> samplerPaths(yyjson_arr_size(samplers_val), TargetPath::Unknown);
+            for (const auto& channel : animation.channels) {
+                if (channel.sampler >= 0 && channel.sampler < static_cast<int>(samplerPaths.size())) {
+                    samplerPaths[channel.sampler] = channel.path;
+                }
+            }
+
             size_t samp_idx, samp_max;
             yyjson_val* sampler_val;
             yyjson_arr_foreach(samplers_val, samp_idx, samp_max, sampler_val) {
                 Sampler sampler;
                 sampler.input = yyjson_get_int(yyjson_obj_get(sampler_val, "input"));
                 sampler.output = yyjson_get_int(yyjson_obj_get(sampler_val, "output"));
-                sampler.interpolation = yyjson_get_str(yyjson_obj_get(sampler_val, "interpolation"));
+                const char* interpolation = yyjson_get_str(yyjson_obj_get(sampler_val, "interpolation"));
+                sampler.interpolation = interpolation ? interpolation : "LINEAR"; // optional, LINEAR by default
+                if (sampler.interpolation == "STEP") sampler.mode = Interpolation::Step;
+                else if (sampler.interpolation == "CUBICSPLINE") sampler.mode = Interpolation::CubicSpline;
                 sampler.extensions = yyjson_obj_get(sampler_val, "extensions");
                 sampler.extras = yyjson_obj_get(sampler_val, "extras");
 
@@ -55,18 +70,22 @@ void GLTFAnimation::parseAnimations(yyjson_val* animationsArray, const GLTFAcces
                 sampler.inputTimes = bufferManager.getAccessorDataFloat(accessorManager.getAccessors()[sampler.input]);
 
                 // Populate output values based on target path
-                if (std::any_of(animation.channels.begin(), animation.channels.end(),
-                    [&](const Channel& channel) { return channel.sampler == samp_idx && channel.targetPath == "translation"; })) {
-                    sampler.outputValuesVec3 = bufferManager.getAccessorDataVec3(accessorManager.getAccessors()[sampler.output]);
-                }
-                else if (std::any_of(animation.channels.begin(), animation.channels.end(),
-                    [&](const Channel& channel) { return channel.sampler == samp_idx && channel.targetPath == "rotation"; })) {
-                    sampler.outputValuesQuat = bufferManager.getAccessorDataQuat(accessorManager.getAccessors()[sampler.output]);
-                }
-                else if (std::any_of(animation.channels.begin(), animation.channels.end(),
-                    [&](const Channel& channel) { return channel.sampler == samp_idx && channel.targetPath == "scale"; })) {
-                    sampler.outputValuesVec3 = bufferManager.getAccessorDataVec3(accessorManager.getAccessors()[sampler.output]);
+                const auto& outputAccessor = accessorManager.getAccessors()[sampler.output];
+                switch (samplerPaths[samp_idx]) {
+                case TargetPath::Translation:
+                case TargetPath::Scale:
+                    sampler.outputValuesVec3 = bufferManager.getAccessorDataVec3(outputAccessor);
+                    break;
+                case TargetPath::Rotation:
+                    sampler.outputValuesQuat = bufferManager.getAccessorDataQuat(outputAccessor);
+                    break;
+                case TargetPath::Weights:
+                    sampler.outputValuesFloat = bufferManager.getAccessorDataFloat(outputAccessor);
+                    break;
+                default:
+                    break;
                 }
+                prepareSampler(sampler, samplerPaths[samp_idx]);
 
                 animation.samplers.push_back(sampler);
             }
@@ -74,6 +93,10 @@ void GLTFAnimation::parseAnimations(yyjson_val* animationsArray, const GLTFAcces
 
         animation.extensions = yyjson_obj_get(animation_val, "extensions");
         animation.extras = yyjson_obj_get(animation_val, "extras");
+        for (const auto& sampler : animation.samplers) {
+            if (!sampler.inputTimes.empty()) animation.duration = std::max(animation.duration, sampler.inputTimes.back());
+        }
+        compileBindings(animation);
 
         animations.push_back(animation);
     }
@@ -84,6 +107,41 @@ void GLTFAnimation::parseAnimations(yyjson_val* animationsArray, const GLTFAcces
     }
 }
 
+GLTFAnimation::TargetPath GLTFAnimation::parseTargetPath(const std::string& path) {
+    if (path == "translation") return TargetPath::Translation;
+    if (path == "rotation") return TargetPath::Rotation;
+    if (path == "scale") return TargetPath::Scale;
+    if (path == "weights") return TargetPath::Weights;
+    return TargetPath::Unknown;
+}
+
+void GLTFAnimation::compileBindings(Animation& animation) {
+    BindingTable& table = animation.bindings;
+    for (const auto& channel : animation.channels) {
+        if (channel.targetNode < 0 || channel.sampler < 0 || channel.sampler >= static_cast<int>(animation.samplers.size())) continue;
+        const Sampler& sampler = animation.samplers[channel.sampler];
+        if (sampler.inputTimes.empty()) continue;
+
+        Binding binding = { channel.sampler, channel.targetNode };
+        switch (channel.path) {
+        case TargetPath::Translation:
+            if (sampler.evaluateVec3) table.translations.push_back(binding);
+            break;
+        case TargetPath::Rotation:
+            if (sampler.evaluateQuat) table.rotations.push_back(binding);
+            break;
+        case TargetPath::Scale:
+            if (sampler.evaluateVec3) table.scales.push_back(binding);
+            break;
+        case TargetPath::Weights:
+            if (sampler.evaluateWeights) table.weights.push_back(binding);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
 size_t GLTFAnimation::getAnimationCount() const {
     return animations.size();
 }
@@ -92,120 +150,669 @@ const std::vector<GLTFAnimation::Animation>& GLTFAnimation::getAnimations() cons
     return animations;
 }
 
-void GLTFAnimation::updateAnimation(float deltaTime, GLTFNode& nodeManager, GLTFSkeleton& skeleton, GLTFMesh& mesh) {
-    currentTime += deltaTime;
+template <typename WriteTranslation, typename WriteRotation, typename WriteScale, typename Skip>
+void GLTFAnimation::evaluateKeys(const Animation& animation, float time, size_t* cursors,
+    WriteTranslation&& writeTranslation, WriteRotation&& writeRotation, WriteScale&& writeScale, Skip&& skip) {
+    // One tight loop per path: no string compares and no per-channel branch on what is being animated or
+    // how it is interpolated
+    for (const Binding& binding : animation.bindings.translations) {
+        if (skip(binding.target)) continue;
+        const Sampler& sampler = animation.samplers[binding.sampler];
+        writeTranslation(binding.target, sampler.evaluateVec3(sampler, time, cursors[binding.sampler]));
+    }
+    for (const Binding& binding : animation.bindings.rotations) {
+        if (skip(binding.target)) continue;
+        const Sampler& sampler = animation.samplers[binding.sampler];
+        writeRotation(binding.target, sampler.evaluateQuat(sampler, time, cursors[binding.sampler]));
+    }
+    for (const Binding& binding : animation.bindings.scales) {
+        if (skip(binding.target)) continue;
+        const Sampler& sampler = animation.samplers[binding.sampler];
+        writeScale(binding.target, sampler.evaluateVec3(sampler, time, cursors[binding.sampler]));
+    }
+}
 
-    // Get the duration of the current animation
-    float animationDuration = animations[currentAnimation].samplers[0].inputTimes.back();
+template <typename WriteTranslation, typename WriteRotation, typename WriteScale, typename Skip>
+void GLTFAnimation::evaluateFrames(const Animation& animation, float time,
+    WriteTranslation&& writeTranslation, WriteRotation&& writeRotation, WriteScale&& writeScale, Skip&& skip) {
+    // Direct index into the dense frames, then one blend per track
+    const ResampledClip& clip = animation.resampled;
+    float position = glm::clamp(time, 0.0f, clip.duration) * clip.framesPerSecond;
+    size_t frame = std::min(static_cast<size_t>(position), clip.frameCount - 2);
+    float t = position - static_cast<float>(frame);
+
+    size_t count = animation.bindings.translations.size();
+    const glm::vec3* from = clip.translations.data() + frame * count;
+    for (size_t k = 0; k < count; ++k) {
+        if (skip(animation.bindings.translations[k].target)) continue;
+        writeTranslation(animation.bindings.translations[k].target, glm::mix(from[k], from[k + count], t));
+    }
+    count = animation.bindings.rotations.size();
+    const glm::quat* fromRotation = clip.rotations.data() + frame * count;
+    for (size_t k = 0; k < count; ++k) {
+        if (skip(animation.bindings.rotations[k].target)) continue;
+        writeRotation(animation.bindings.rotations[k].target, glm::normalize(fromRotation[k] * (1.0f - t) + fromRotation[k + count] * t));
+    }
+    count = animation.bindings.scales.size();
+    from = clip.scales.data() + frame * count;
+    for (size_t k = 0; k < count; ++k) {
+        if (skip(animation.bindings.scales[k].target)) continue;
+        writeScale(animation.bindings.scales[k].target, glm::mix(from[k], from[k + count], t));
+    }
+}
 
-    // Reset currentTime if it surpasses the animation duration to loop the animation
-    if (currentTime > animationDuration) {
-        currentTime = std::fmod(currentTime, animationDuration);
+template <typename WriteTranslation, typename WriteRotation, typename WriteScale, typename Skip>
+void GLTFAnimation::evaluateBindings(const Animation& animation, float time, size_t* cursors,
+    WriteTranslation&& writeTranslation, WriteRotation&& writeRotation, WriteScale&& writeScale, Skip&& skip) {
+    if (animation.resampled.frameCount > 0) evaluateFrames(animation, time, writeTranslation, writeRotation, writeScale, skip);
+    else evaluateKeys(animation, time, cursors, writeTranslation, writeRotation, writeScale, skip);
+}
+
+void GLTFAnimation::resampleAnimations(float frameRate) {
+    if (frameRate <= 0.0f) return;
+    for (auto& animation : animations) resample(animation, frameRate);
+}
+
+void GLTFAnimation::resample(Animation& animation, float frameRate) {
+    const BindingTable& bindings = animation.bindings;
+    ResampledClip clip;
+    clip.duration = animation.duration;
+    if (clip.duration <= 0.0f) return;
+
+    // Round to whole frames and stretch the rate slightly so the last frame lands on the clip's end
+    clip.frameCount = static_cast<size_t>(std::ceil(clip.duration * frameRate)) + 1;
+    clip.framesPerSecond = static_cast<float>(clip.frameCount - 1) / clip.duration;
+    clip.translations.resize(clip.frameCount * bindings.translations.size());
+    clip.rotations.resize(clip.frameCount * bindings.rotations.size());
+    clip.scales.resize(clip.frameCount * bindings.scales.size());
+
+    auto frameTime = [&](size_t frame) { return static_cast<float>(frame) / clip.framesPerSecond; };
+    auto bakeVec3 = [&](const std::vector<Binding>& tracks, std::vector<glm::vec3>& frames) {
+        for (size_t k = 0; k < tracks.size(); ++k) {
+            const Sampler& sampler = animation.samplers[tracks[k].sampler];
+            size_t cursor = 0;
+            for (size_t f = 0; f < clip.frameCount; ++f) frames[f * tracks.size() + k] = sampler.evaluateVec3(sampler, frameTime(f), cursor);
+        }
+    };
+    bakeVec3(bindings.translations, clip.translations);
+    bakeVec3(bindings.scales, clip.scales);
+    for (size_t k = 0; k < bindings.rotations.size(); ++k) {
+        const Sampler& sampler = animation.samplers[bindings.rotations[k].sampler];
+        const size_t stride = bindings.rotations.size();
+        size_t cursor = 0;
+        for (size_t f = 0; f < clip.frameCount; ++f) {
+            glm::quat q = sampler.evaluateQuat(sampler, frameTime(f), cursor);
+            if (f > 0 && glm::dot(q, clip.rotations[(f - 1) * stride + k]) < 0.0f) q = -q;
+            clip.rotations[f * stride + k] = q;
+        }
     }
 
-    //std::cout << "Updating animation at " << currentTime << " / " << animationDuration << std::endl;
-    for (const auto& channel : animations[currentAnimation].channels) {
-        const auto& sampler = animations[currentAnimation].samplers[channel.sampler];
+    // Measure against the source at each source key and a few points inside every frame
+    size_t sourceBytes = 0;
+    for (const auto& sampler : animation.samplers) {
+        sourceBytes += sampler.inputTimes.size() * sizeof(float) + sampler.outputValuesVec3.size() * sizeof(glm::vec3)
+            + sampler.outputValuesQuat.size() * sizeof(glm::quat) + sampler.hermiteVec3.size() * sizeof(glm::vec3)
+            + sampler.hermiteQuat.size() * sizeof(glm::vec4) + sampler.quantized.getMemoryUsage();
+    }
+    size_t bakedBytes = clip.translations.size() * sizeof(glm::vec3) + clip.rotations.size() * sizeof(glm::quat)
+        + clip.scales.size() * sizeof(glm::vec3);
+    animation.resampled = std::move(clip);
+
+    float maxDistance = 0.0f;
+    float maxAngle = 0.0f;
+    Pose source, baked;
+    int nodeCount = 0;
+    for (const auto& channel : animation.channels) nodeCount = std::max(nodeCount, channel.targetNode + 1);
+    for (Pose* pose : { &source, &baked }) {
+        pose->translations.assign(nodeCount, glm::vec3(0.0f));
+        pose->rotations.assign(nodeCount, glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+        pose->scales.assign(nodeCount, glm::vec3(1.0f));
+    }
+    std::vector<float> checkTimes;
+    for (const auto& sampler : animation.samplers) checkTimes.insert(checkTimes.end(), sampler.inputTimes.begin(), sampler.inputTimes.end());
+    for (size_t f = 0; f + 1 < animation.resampled.frameCount; ++f) {
+        for (int step = 1; step < 4; ++step) checkTimes.push_back((static_cast<float>(f) + step * 0.25f) / animation.resampled.framesPerSecond);
+    }
+    std::sort(checkTimes.begin(), checkTimes.end());
+
+    std::vector<size_t> cursors(animation.samplers.size(), 0);
+    auto keepAll = [](int) { return false; };
+    for (float time : checkTimes) {
+        evaluateKeys(animation, time, cursors.data(),
+            [&](int node, const glm::vec3& value) { source.translations[node] = value; },
+            [&](int node, const glm::quat& value) { source.rotations[node] = value; },
+            [&](int node, const glm::vec3& value) { source.scales[node] = value; }, keepAll);
+        evaluateFrames(animation, time,
+            [&](int node, const glm::vec3& value) { baked.translations[node] = value; },
+            [&](int node, const glm::quat& value) { baked.rotations[node] = value; },
+            [&](int node, const glm::vec3& value) { baked.scales[node] = value; }, keepAll);
+        for (int node = 0; node < nodeCount; ++node) {
+            maxDistance = std::max(maxDistance, glm::length(source.translations[node] - baked.translations[node]));
+            maxDistance = std::max(maxDistance, glm::length(source.scales[node] - baked.scales[node]));
+            float cosHalf = std::min(1.0f, std::abs(glm::dot(source.rotations[node], baked.rotations[node])));
+            maxAngle = std::max(maxAngle, 2.0f * std::acos(cosHalf));
+        }
+    }
 
-       // std::cout << "Channel Target Node: " << channel.targetNode
-       //     << ", Target Path: " << channel.targetPath << std::endl;
+    std::cout << "Resampled " << animation.name << " to " << animation.resampled.framesPerSecond << " fps, "
+        << animation.resampled.frameCount << " frames: " << sourceBytes << " -> " << sourceBytes + bakedBytes << " bytes (+"
+        << bakedBytes << "), max error " << maxDistance << " units, " << maxAngle << " rad" << std::endl;
+}
 
-        
+namespace {
+    // Angle between two rotations. Taken from the relative rotation's axis part rather than acos of the dot
+    // product, which float rounds to zero below about a milliradian.
+    float rotationAngle(const glm::quat& a, const glm::quat& b) {
+        glm::quat relative = glm::conjugate(a) * b;
+        return 2.0f * std::atan2(glm::length(glm::vec3(relative.x, relative.y, relative.z)), std::abs(relative.w));
+    }
+}
 
-        if (channel.targetPath == "translation") {
-            glm::vec3 interpolatedValue = interpolateVec3(sampler.inputTimes, sampler.outputValuesVec3, currentTime);
-            //std::cout << "Interpolated Translation: " << glm::to_string(interpolatedValue) << std::endl;
-            nodeManager.setNodeTranslation(channel.targetNode, interpolatedValue);
+void GLTFAnimation::compressAnimations(const CompressionSettings& settings) {
+    size_t compressedTracks = 0, keptTracks = 0, bytesBefore = 0, bytesAfter = 0;
+    for (auto& animation : animations) compress(animation, settings, compressedTracks, keptTracks, bytesBefore, bytesAfter);
+    std::cout << "Compressed " << compressedTracks << " animation tracks, kept " << keptTracks << " at full precision: "
+        << bytesBefore << " -> " << bytesAfter << " bytes" << std::endl;
+}
+
+void GLTFAnimation::compress(Animation& animation, const CompressionSettings& settings, size_t& compressedTracks,
+    size_t& keptTracks, size_t& bytesBefore, size_t& bytesAfter) {
+    // A track's budget is the tightest over the nodes it drives
+    std::vector<float> budgets(animation.samplers.size(), -1.0f);
+    auto addTargets = [&](const std::vector<Binding>& tracks, float budget) {
+        for (const Binding& binding : tracks) {
+            auto scale = settings.nodeErrorScale.find(binding.target);
+            float nodeBudget = budget * (scale != settings.nodeErrorScale.end() ? scale->second : 1.0f);
+            float& trackBudget = budgets[binding.sampler];
+            trackBudget = trackBudget < 0.0f ? nodeBudget : std::min(trackBudget, nodeBudget);
         }
-        else if (channel.targetPath == "rotation") {
-            glm::quat interpolatedValue = interpolateQuat(sampler.inputTimes, sampler.outputValuesQuat, currentTime);
-            //std::cout << "Interpolated Rotation: " << glm::to_string(interpolatedValue) << std::endl;
-            nodeManager.setNodeRotation(channel.targetNode, interpolatedValue);
+    };
+    addTargets(animation.bindings.translations, settings.translationError);
+    addTargets(animation.bindings.rotations, settings.rotationError);
+    addTargets(animation.bindings.scales, settings.translationError);
+
+    for (size_t s = 0; s < animation.samplers.size(); ++s) {
+        Sampler& sampler = animation.samplers[s];
+        const size_t sourceBytes = sampler.inputTimes.size() * sizeof(float) + sampler.outputValuesVec3.size() * sizeof(glm::vec3)
+            + sampler.outputValuesQuat.size() * sizeof(glm::quat) + sampler.hermiteVec3.size() * sizeof(glm::vec3)
+            + sampler.hermiteQuat.size() * sizeof(glm::vec4);
+        bytesBefore += sourceBytes;
+        if (budgets[s] < 0.0f) {
+            bytesAfter += sourceBytes; // drives nothing that is played back
+            continue;
         }
-        else if (channel.targetPath == "scale") {
-            glm::vec3 interpolatedValue = interpolateVec3(sampler.inputTimes, sampler.outputValuesVec3, currentTime);
-            //std::cout << "Interpolated Scale: " << glm::to_string(interpolatedValue) << std::endl;
-            nodeManager.setNodeScale(channel.targetNode, interpolatedValue);
+
+        // Only LINEAR keys map onto the curve's interpolation; STEP and CUBICSPLINE stay as they are
+        const bool isQuat = sampler.evaluateQuat != nullptr;
+        bool built = sampler.mode == Interpolation::Linear && (isQuat
+            ? sampler.quantized.buildRotation(sampler.inputTimes, sampler.outputValuesQuat, settings.frameRate)
+            : sampler.quantized.buildVec3(sampler.inputTimes, sampler.outputValuesVec3, settings.frameRate));
+
+        // Compare at every key and halfway to the next; frame rounding of the key times is included
+        float maxError = 0.0f;
+        size_t sourceCursor = 0, quantizedCursor = 0;
+        for (size_t k = 0; built && k < sampler.inputTimes.size(); ++k) {
+            for (int half = 0; half < 2; ++half) {
+                if (half == 1 && k + 1 == sampler.inputTimes.size()) break;
+                float time = half == 0 ? sampler.inputTimes[k] : 0.5f * (sampler.inputTimes[k] + sampler.inputTimes[k + 1]);
+                if (isQuat) {
+                    maxError = std::max(maxError, rotationAngle(evaluateLinearQuat(sampler, time, sourceCursor),
+                        sampler.quantized.sampleRotation(time, quantizedCursor)));
+                }
+                else {
+                    maxError = std::max(maxError, glm::length(evaluateLinearVec3(sampler, time, sourceCursor)
+                        - sampler.quantized.sampleVec3(time, quantizedCursor)));
+                }
+            }
+        }
+
+        if (!built || maxError > budgets[s]) {
+            sampler.quantized.clear();
+            bytesAfter += sourceBytes;
+            ++keptTracks;
+            continue;
         }
+        if (isQuat) sampler.evaluateQuat = evaluateQuantizedQuat;
+        else sampler.evaluateVec3 = evaluateQuantizedVec3;
+        std::vector<float>().swap(sampler.inputTimes);
+        std::vector<glm::vec3>().swap(sampler.outputValuesVec3);
+        std::vector<glm::quat>().swap(sampler.outputValuesQuat);
+        bytesAfter += sampler.quantized.getMemoryUsage();
+        ++compressedTracks;
     }
+}
 
-    // Update node transformations
-    auto& nodes = nodeManager.getNodes();
-    for (auto& node : nodes) {
-       // nodeManager.updateNodeTransformation(node);
-        //std::cout << "Node: " << node.name << ", Transformation: " << glm::to_string(node.transformation) << std::endl;
+namespace {
+    float keyError(const glm::vec3& a, const glm::vec3& b) { return glm::length(a - b); }
+    float keyError(const glm::quat& a, const glm::quat& b) { return rotationAngle(a, b); }
+    glm::vec3 interpolateKeys(const glm::vec3& a, const glm::vec3& b, float t) { return glm::mix(a, b, t); }
+    glm::quat interpolateKeys(const glm::quat& a, const glm::quat& b, float t) { return glm::slerp(a, b, t); }
+
+    // Whether one segment from key first to key last reproduces every key it would skip. A linear segment
+    // strays furthest from the original polyline at the original keys, so those are the only checks needed.
+    template <typename T>
+    bool segmentFits(const std::vector<float>& times, const std::vector<T>& values, size_t first, size_t last, float tolerance) {
+        const float span = times[last] - times[first];
+        for (size_t k = first + 1; k < last; ++k) {
+            float t = span > 0.0f ? (times[k] - times[first]) / span : 0.0f;
+            if (keyError(interpolateKeys(values[first], values[last], t), values[k]) > tolerance) return false;
+        }
+        return true;
     }
 
-    // Update skeleton with the new node transformations
-    skeleton.updateSkeleton(nodes);
+    // Greedy removal: from each kept key, extend one segment as far as it still fits. The end is found by
+    // doubling the span and then bisecting, so long still stretches cost O(n log n) rather than O(n^2).
+    template <typename T>
+    void reduceTrack(std::vector<float>& times, std::vector<T>& values, bool step, float tolerance) {
+        if (times.size() < 3 || values.size() != times.size()) return;
+
+        std::vector<size_t> kept = { 0 };
+        const size_t last = times.size() - 1;
+        size_t anchor = 0;
+        while (anchor < last) {
+            size_t end = anchor + 1;
+            if (step) {
+                // A STEP key is only needed where the held value changes
+                while (end < last && keyError(values[end], values[anchor]) <= tolerance) ++end;
+            }
+            else {
+                // A segment to the very next key always fits; fails stays past the end until one does not
+                size_t fails = last + 1;
+                for (size_t span = 2; end < last; span *= 2) {
+                    size_t candidate = std::min(anchor + span, last);
+                    if (!segmentFits(times, values, anchor, candidate, tolerance)) {
+                        fails = candidate;
+                        break;
+                    }
+                    end = candidate;
+                }
+                while (fails <= last && fails - end > 1) {
+                    size_t middle = end + (fails - end) / 2;
+                    if (segmentFits(times, values, anchor, middle, tolerance)) end = middle;
+                    else fails = middle;
+                }
+            }
+            kept.push_back(end);
+            anchor = end;
+        }
 
-    // Update mesh vertices with the new joint transformations
-    //mesh.updateVertices(skeleton.getBoneTransforms());
+        for (size_t k = 0; k < kept.size(); ++k) {
+            times[k] = times[kept[k]];
+            values[k] = values[kept[k]];
+        }
+        times.resize(kept.size());
+        values.resize(kept.size());
+        times.shrink_to_fit();
+        values.shrink_to_fit();
+    }
 }
 
+void GLTFAnimation::reduceKeys(const KeyReductionSettings& settings, const GLTFNode& nodeManager) {
+    const auto& nodes = nodeManager.getNodes();
+    const auto& order = nodeManager.getTopologicalOrder();
 
-glm::vec3 GLTFAnimation::interpolateVec3(const std::vector<float>& inputTimes, const std::vector<glm::vec3>& outputValues, float currentTime) {
-    if (inputTimes.empty() || outputValues.empty()) return glm::vec3(0.0f);
-
-    size_t count = inputTimes.size();
-    if (currentTime <= inputTimes.front()) return outputValues.front();
-    if (currentTime >= inputTimes.back()) return outputValues.back();
+    // Rest length of the longest limb below each node: a rotation error of r radians moves a node at
+    // distance d by up to r * d. Node scale is ignored.
+    std::vector<float> reach(nodes.size(), 0.0f);
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        int parent = nodes[*it].parentIndex;
+        if (parent >= 0) reach[parent] = std::max(reach[parent], glm::length(nodes[*it].translation) + reach[*it]);
+    }
 
-    for (size_t i = 0; i < count - 1; ++i) {
-        if (currentTime >= inputTimes[i] && currentTime <= inputTimes[i + 1]) {
-            float t = (currentTime - inputTimes[i]) / (inputTimes[i + 1] - inputTimes[i]);
-            glm::vec3 result = glm::mix(outputValues[i], outputValues[i + 1], t);
+    for (auto& animation : animations) {
+        // Channels per node, then the most channels on any root-to-leaf chain through each node
+        std::vector<int> channelCount(nodes.size(), 0);
+        for (const auto& channel : animation.channels) {
+            if (channel.targetNode >= 0 && channel.targetNode < static_cast<int>(nodes.size())) ++channelCount[channel.targetNode];
+        }
+        std::vector<int> above(nodes.size(), 0), below(nodes.size(), 0);
+        for (int node : order) {
+            int parent = nodes[node].parentIndex;
+            above[node] = (parent >= 0 ? above[parent] : 0) + channelCount[node];
+        }
+        for (auto it = order.rbegin(); it != order.rend(); ++it) {
+            below[*it] += channelCount[*it];
+            int parent = nodes[*it].parentIndex;
+            if (parent >= 0) below[parent] = std::max(below[parent], below[*it]);
+        }
 
-           // std::cout << "Interpolating Vec3: time = " << currentTime << ", t = " << t
-            //    << ", start = " << glm::to_string(outputValues[i])
-             //   << ", end = " << glm::to_string(outputValues[i + 1])
-              //  << ", result = " << glm::to_string(result) << std::endl;
+        // A sampler shared by several channels is reduced once, to the tightest of their tolerances
+        std::vector<float> tolerances(animation.samplers.size(), -1.0f);
+        for (const auto& channel : animation.channels) {
+            if (channel.sampler < 0 || channel.sampler >= static_cast<int>(animation.samplers.size())) continue;
+            if (channel.targetNode < 0 || channel.targetNode >= static_cast<int>(nodes.size())) continue;
+
+            const int node = channel.targetNode;
+            const float share = 1.0f / static_cast<float>(std::max(1, above[node] + below[node] - channelCount[node]));
+            const float limbError = reach[node] > 0.0f ? settings.positionError / reach[node] : FLT_MAX;
+            float tolerance;
+            switch (channel.path) {
+            case TargetPath::Translation: tolerance = settings.positionError * share; break;
+            case TargetPath::Rotation: tolerance = std::min(settings.rotationError, limbError) * share; break;
+            case TargetPath::Scale: tolerance = std::min(settings.scaleError, limbError) * share; break;
+            default: continue;
+            }
+            float& samplerTolerance = tolerances[channel.sampler];
+            samplerTolerance = samplerTolerance < 0.0f ? tolerance : std::min(samplerTolerance, tolerance);
+        }
 
-            return result;
+        size_t keysBefore = 0, keysAfter = 0;
+        for (size_t s = 0; s < animation.samplers.size(); ++s) {
+            Sampler& sampler = animation.samplers[s];
+            keysBefore += sampler.inputTimes.size();
+            // CUBICSPLINE keys carry tangents that a removed key would change, so they are left alone
+            if (tolerances[s] >= 0.0f && sampler.mode != Interpolation::CubicSpline) {
+                const bool step = sampler.mode == Interpolation::Step;
+                if (sampler.evaluateQuat) reduceTrack(sampler.inputTimes, sampler.outputValuesQuat, step, tolerances[s]);
+                else if (sampler.evaluateVec3) reduceTrack(sampler.inputTimes, sampler.outputValuesVec3, step, tolerances[s]);
+            }
+            keysAfter += sampler.inputTimes.size();
         }
+        std::cout << "Reduced keys of " << animation.name << ": " << keysBefore << " -> " << keysAfter << std::endl;
     }
+}
 
-    return outputValues.back(); // fallback
+namespace {
+    // The linear lookup used before cursors, kept as the benchmark baseline
+    glm::vec3 interpolateLinearScan(const std::vector<float>& inputTimes, const std::vector<glm::vec3>& outputValues, float time) {
+        if (time <= inputTimes.front()) return outputValues.front();
+        if (time >= inputTimes.back()) return outputValues.back();
+        for (size_t i = 0; i + 1 < inputTimes.size(); ++i) {
+            if (time >= inputTimes[i] && time <= inputTimes[i + 1]) {
+                float t = (time - inputTimes[i]) / (inputTimes[i + 1] - inputTimes[i]);
+                return glm::mix(outputValues[i], outputValues[i + 1], t);
+            }
+        }
+        return outputValues.back();
+    }
 }
 
+size_t GLTFAnimation::findKey(const std::vector<float>& inputTimes, float time, size_t& cursor) {
+    // Forward playback stays in the cached segment or moves to the next one; anything else (seeks, loops,
+    // large time steps) falls back to a binary search
+    const size_t last = inputTimes.size() - 2;
+    size_t key = cursor <= last ? cursor : last;
+    if (inputTimes[key] <= time) {
+        if (time < inputTimes[key + 1]) return cursor = key;
+        if (key < last && time < inputTimes[key + 2]) return cursor = key + 1;
+        auto upper = std::upper_bound(inputTimes.begin() + key + 1, inputTimes.end(), time);
+        key = static_cast<size_t>(upper - inputTimes.begin()) - 1;
+    }
+    else {
+        auto upper = std::upper_bound(inputTimes.begin(), inputTimes.begin() + key, time);
+        key = upper == inputTimes.begin() ? 0 : static_cast<size_t>(upper - inputTimes.begin()) - 1;
+    }
+    return cursor = std::min(key, last);
+}
 
-glm::quat GLTFAnimation::interpolateQuat(const std::vector<float>& inputTimes, const std::vector<glm::quat>& outputValues, float currentTime) {
-    if (inputTimes.empty() || outputValues.empty()) return glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+namespace {
+    // Hermite basis rearranged as a cubic in s, with tangents already scaled by the segment duration
+    template <typename T>
+    void hermiteCoefficients(const T& p0, const T& m0, const T& p1, const T& m1, T* out) {
+        out[0] = 2.0f * p0 + m0 - 2.0f * p1 + m1;
+        out[1] = -3.0f * p0 - 2.0f * m0 + 3.0f * p1 - m1;
+        out[2] = m0;
+        out[3] = p0;
+    }
 
-    size_t count = inputTimes.size();
-    if (currentTime <= inputTimes.front()) return outputValues.front();
-    if (currentTime >= inputTimes.back()) return outputValues.back();
+    template <typename T>
+    T evaluateCubic(const T* coefficients, float s) {
+        return ((coefficients[0] * s + coefficients[1]) * s + coefficients[2]) * s + coefficients[3];
+    }
+}
 
-    for (size_t i = 0; i < count - 1; ++i) {
-        if (currentTime >= inputTimes[i] && currentTime <= inputTimes[i + 1]) {
-            float t = (currentTime - inputTimes[i]) / (inputTimes[i + 1] - inputTimes[i]);
-            glm::quat result = glm::slerp(outputValues[i], outputValues[i + 1], t);
+void GLTFAnimation::prepareSampler(Sampler& sampler, TargetPath path) {
+    const size_t keyCount = sampler.inputTimes.size();
+    if (path == TargetPath::Weights) {
+        // Every key holds one weight per morph target; the count follows from the output size
+        const size_t perKey = keyCount * (sampler.mode == Interpolation::CubicSpline ? 3 : 1);
+        if (perKey == 0 || sampler.outputValuesFloat.empty() || sampler.outputValuesFloat.size() % perKey != 0) {
+            if (perKey > 0) std::cerr << "Weights sampler has " << sampler.outputValuesFloat.size() << " outputs for " << keyCount << " keys" << std::endl;
+            return;
+        }
+        sampler.valuesPerKey = sampler.outputValuesFloat.size() / perKey;
+        switch (sampler.mode) {
+        case Interpolation::Step: sampler.evaluateWeights = evaluateStepWeights; break;
+        case Interpolation::CubicSpline: sampler.evaluateWeights = evaluateCubicWeights; break;
+        default: sampler.evaluateWeights = evaluateLinearWeights; break;
+        }
+        return;
+    }
 
-           // std::cout << "Interpolating Quat: time = " << currentTime << ", t = " << t
-            //    << ", start = " << glm::to_string(outputValues[i])
-             //   << ", end = " << glm::to_string(outputValues[i + 1])
-             //   << ", result = " << glm::to_string(result) << std::endl;
+    const bool isQuat = path == TargetPath::Rotation;
+    if (keyCount == 0 || (isQuat ? sampler.outputValuesQuat.empty() : sampler.outputValuesVec3.empty())) return;
 
-            return result;
+    if (sampler.mode == Interpolation::CubicSpline) {
+        // Outputs come as (in-tangent, value, out-tangent) per key
+        auto expand = [&](auto& triplets, auto& values, auto& hermite, auto toCoefficient) {
+            if (triplets.size() < keyCount * 3) {
+                std::cerr << "CUBICSPLINE sampler has " << triplets.size() << " outputs for " << keyCount << " keys" << std::endl;
+                triplets.clear();
+                return;
+            }
+            values.resize(keyCount);
+            for (size_t k = 0; k < keyCount; ++k) values[k] = triplets[k * 3 + 1];
+            hermite.resize((keyCount - 1) * 4);
+            for (size_t k = 0; k + 1 < keyCount; ++k) {
+                float duration = sampler.inputTimes[k + 1] - sampler.inputTimes[k];
+                hermiteCoefficients(toCoefficient(triplets[k * 3 + 1]), toCoefficient(triplets[k * 3 + 2]) * duration,
+                    toCoefficient(triplets[k * 3 + 4]), toCoefficient(triplets[k * 3 + 3]) * duration, &hermite[k * 4]);
+            }
+        };
+        if (isQuat) {
+            std::vector<glm::quat> triplets = std::move(sampler.outputValuesQuat);
+            expand(triplets, sampler.outputValuesQuat, sampler.hermiteQuat, [](const glm::quat& q) { return glm::vec4(q.x, q.y, q.z, q.w); });
+            if (triplets.empty()) sampler.outputValuesQuat.clear();
         }
+        else {
+            std::vector<glm::vec3> triplets = std::move(sampler.outputValuesVec3);
+            expand(triplets, sampler.outputValuesVec3, sampler.hermiteVec3, [](const glm::vec3& v) { return v; });
+            if (triplets.empty()) sampler.outputValuesVec3.clear();
+        }
+        if (isQuat ? sampler.outputValuesQuat.empty() : sampler.outputValuesVec3.empty()) return;
+    }
+
+    switch (sampler.mode) {
+    case Interpolation::Step:
+        sampler.evaluateVec3 = evaluateStepVec3;
+        sampler.evaluateQuat = evaluateStepQuat;
+        break;
+    case Interpolation::CubicSpline:
+        sampler.evaluateVec3 = evaluateCubicVec3;
+        sampler.evaluateQuat = evaluateCubicQuat;
+        break;
+    default:
+        sampler.evaluateVec3 = evaluateLinearVec3;
+        sampler.evaluateQuat = evaluateLinearQuat;
+        break;
+    }
+    if (isQuat) sampler.evaluateVec3 = nullptr;
+    else sampler.evaluateQuat = nullptr;
+}
+
+glm::vec3 GLTFAnimation::evaluateLinearVec3(const Sampler& sampler, float time, size_t& cursor) {
+    const auto& inputTimes = sampler.inputTimes;
+    const auto& outputValues = sampler.outputValuesVec3;
+    if (time <= inputTimes.front()) return outputValues.front();
+    if (time >= inputTimes.back()) return outputValues.back();
+
+    size_t i = findKey(inputTimes, time, cursor);
+    float t = (time - inputTimes[i]) / (inputTimes[i + 1] - inputTimes[i]);
+    return glm::mix(outputValues[i], outputValues[i + 1], t);
+}
+
+glm::vec3 GLTFAnimation::evaluateStepVec3(const Sampler& sampler, float time, size_t& cursor) {
+    const auto& inputTimes = sampler.inputTimes;
+    if (time <= inputTimes.front()) return sampler.outputValuesVec3.front();
+    if (time >= inputTimes.back()) return sampler.outputValuesVec3.back();
+    return sampler.outputValuesVec3[findKey(inputTimes, time, cursor)];
+}
+
+glm::vec3 GLTFAnimation::evaluateCubicVec3(const Sampler& sampler, float time, size_t& cursor) {
+    const auto& inputTimes = sampler.inputTimes;
+    if (time <= inputTimes.front()) return sampler.outputValuesVec3.front();
+    if (time >= inputTimes.back()) return sampler.outputValuesVec3.back();
+
+    size_t i = findKey(inputTimes, time, cursor);
+    float s = (time - inputTimes[i]) / (inputTimes[i + 1] - inputTimes[i]);
+    return evaluateCubic(&sampler.hermiteVec3[i * 4], s);
+}
+
+glm::quat GLTFAnimation::evaluateLinearQuat(const Sampler& sampler, float time, size_t& cursor) {
+    const auto& inputTimes = sampler.inputTimes;
+    const auto& outputValues = sampler.outputValuesQuat;
+    if (time <= inputTimes.front()) return outputValues.front();
+    if (time >= inputTimes.back()) return outputValues.back();
+
+    size_t i = findKey(inputTimes, time, cursor);
+    float t = (time - inputTimes[i]) / (inputTimes[i + 1] - inputTimes[i]);
+    return glm::slerp(outputValues[i], outputValues[i + 1], t);
+}
+
+glm::quat GLTFAnimation::evaluateStepQuat(const Sampler& sampler, float time, size_t& cursor) {
+    const auto& inputTimes = sampler.inputTimes;
+    if (time <= inputTimes.front()) return sampler.outputValuesQuat.front();
+    if (time >= inputTimes.back()) return sampler.outputValuesQuat.back();
+    return sampler.outputValuesQuat[findKey(inputTimes, time, cursor)];
+}
+
+glm::quat GLTFAnimation::evaluateCubicQuat(const Sampler& sampler, float time, size_t& cursor) {
+    const auto& inputTimes = sampler.inputTimes;
+    if (time <= inputTimes.front()) return sampler.outputValuesQuat.front();
+    if (time >= inputTimes.back()) return sampler.outputValuesQuat.back();
+
+    // The spec interpolates the components and renormalizes
+    size_t i = findKey(inputTimes, time, cursor);
+    float s = (time - inputTimes[i]) / (inputTimes[i + 1] - inputTimes[i]);
+    glm::vec4 q = evaluateCubic(&sampler.hermiteQuat[i * 4], s);
+    return glm::normalize(glm::quat(q.w, q.x, q.y, q.z));
+}
+
+
+glm::vec3 GLTFAnimation::evaluateQuantizedVec3(const Sampler& sampler, float time, size_t& cursor) {
+    return sampler.quantized.sampleVec3(time, cursor);
+}
+
+glm::quat GLTFAnimation::evaluateQuantizedQuat(const Sampler& sampler, float time, size_t& cursor) {
+    return sampler.quantized.sampleRotation(time, cursor);
+}
+
+void GLTFAnimation::evaluateLinearWeights(const Sampler& sampler, float time, size_t& cursor, float* out) {
+    const auto& inputTimes = sampler.inputTimes;
+    const size_t count = sampler.valuesPerKey;
+    const float* values = sampler.outputValuesFloat.data();
+    if (time <= inputTimes.front()) {
+        std::copy(values, values + count, out);
+        return;
+    }
+    if (time >= inputTimes.back()) {
+        std::copy(values + (inputTimes.size() - 1) * count, values + inputTimes.size() * count, out);
+        return;
     }
 
-    return outputValues.back(); // fallback
+    size_t i = findKey(inputTimes, time, cursor);
+    float t = (time - inputTimes[i]) / (inputTimes[i + 1] - inputTimes[i]);
+    const float* from = values + i * count;
+    const float* to = from + count;
+    for (size_t c = 0; c < count; ++c) out[c] = from[c] + (to[c] - from[c]) * t;
 }
 
+void GLTFAnimation::evaluateStepWeights(const Sampler& sampler, float time, size_t& cursor, float* out) {
+    const auto& inputTimes = sampler.inputTimes;
+    size_t key;
+    if (time <= inputTimes.front()) key = 0;
+    else if (time >= inputTimes.back()) key = inputTimes.size() - 1;
+    else key = findKey(inputTimes, time, cursor);
+    const float* values = sampler.outputValuesFloat.data() + key * sampler.valuesPerKey;
+    std::copy(values, values + sampler.valuesPerKey, out);
+}
 
-void GLTFAnimation::setAnimation(const std::string& animationName) {
+void GLTFAnimation::evaluateCubicWeights(const Sampler& sampler, float time, size_t& cursor, float* out) {
+    // Keys are laid out as (in-tangents, values, out-tangents), each valuesPerKey long
+    const auto& inputTimes = sampler.inputTimes;
+    const size_t count = sampler.valuesPerKey;
+    const float* keys = sampler.outputValuesFloat.data();
+    if (time <= inputTimes.front() || time >= inputTimes.back()) {
+        const size_t key = time <= inputTimes.front() ? 0 : inputTimes.size() - 1;
+        const float* values = keys + (key * 3 + 1) * count;
+        std::copy(values, values + count, out);
+        return;
+    }
+
+    size_t i = findKey(inputTimes, time, cursor);
+    float duration = inputTimes[i + 1] - inputTimes[i];
+    float s = (time - inputTimes[i]) / duration;
+    float coefficients[4];
+    const float* p0 = keys + (i * 3 + 1) * count;
+    const float* m0 = keys + (i * 3 + 2) * count;
+    const float* m1 = keys + (i * 3 + 3) * count;
+    const float* p1 = keys + (i * 3 + 4) * count;
+    for (size_t c = 0; c < count; ++c) {
+        hermiteCoefficients(p0[c], m0[c] * duration, p1[c], m1[c] * duration, coefficients);
+        out[c] = evaluateCubic(coefficients, s);
+    }
+}
+
+int GLTFAnimation::findAnimation(const std::string& animationName) const {
     for (size_t i = 0; i < animations.size(); ++i) {
-        if (animations[i].name == animationName) {
-            std::cout << "Setting the model's animation to " << animationName << std::endl;
-            //printAnimationInfo(animations[i], i);
-            currentAnimation = i;
-            currentTime = 0.0f;
-            break;
+        if (animations[i].name == animationName) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void GLTFAnimation::growWeightRange(const Sampler& sampler, std::vector<float>& largest) {
+    const size_t count = sampler.valuesPerKey;
+    const size_t keyCount = sampler.inputTimes.size();
+    const float* keys = sampler.outputValuesFloat.data();
+    if (count == 0 || largest.size() < count) return;
+    if (sampler.mode != Interpolation::CubicSpline) {
+        for (size_t i = 0; i < keyCount * count && i < sampler.outputValuesFloat.size(); ++i) {
+            largest[i % count] = std::max(largest[i % count], std::abs(keys[i]));
+        }
+        return;
+    }
+    // The Hermite basis puts the segment between its end values plus at most 4/27 of each scaled tangent
+    if (sampler.outputValuesFloat.size() < keyCount * 3 * count) return;
+    for (size_t i = 0; i < keyCount; ++i) {
+        const float duration = i + 1 < keyCount ? sampler.inputTimes[i + 1] - sampler.inputTimes[i] : 0.0f;
+        for (size_t c = 0; c < count; ++c) {
+            float bound = std::abs(keys[(i * 3 + 1) * count + c]);
+            if (i + 1 < keyCount) {
+                bound = std::max(bound, std::abs(keys[(i * 3 + 4) * count + c]));
+                bound += 4.0f / 27.0f * duration * (std::abs(keys[(i * 3 + 2) * count + c]) + std::abs(keys[(i * 3 + 3) * count + c]));
+            }
+            largest[c] = std::max(largest[c], bound);
         }
     }
 }
 
+float GLTFAnimation::getDuration(size_t animationIndex) const {
+    return animations[animationIndex].duration;
+}
+
+void GLTFAnimation::sampleAnimation(size_t animationIndex, float time, Pose& pose, std::vector<size_t>& cursors,
+    const std::vector<unsigned char>* skipNodes) const {
+    const Animation& animation = animations[animationIndex];
+    cursors.resize(animation.samplers.size(), 0);
+    const int nodeCount = static_cast<int>(pose.translations.size());
+    const int skipCount = skipNodes ? static_cast<int>(skipNodes->size()) : 0;
+    auto skip = [&](int node) { return node < skipCount && (*skipNodes)[node] != 0; };
+    evaluateBindings(animation, time, cursors.data(),
+        [&](int node, const glm::vec3& value) { if (node < nodeCount) pose.translations[node] = value; },
+        [&](int node, const glm::quat& value) { if (node < nodeCount) pose.rotations[node] = value; },
+        [&](int node, const glm::vec3& value) { if (node < nodeCount) pose.scales[node] = value; }, skip);
+
+    // Weights always play from their keys; resampling bakes only the node transforms
+    if (pose.morphWeightOffsets.size() <= static_cast<size_t>(nodeCount)) return;
+    for (const Binding& binding : animation.bindings.weights) {
+        if (binding.target >= nodeCount || skip(binding.target)) continue;
+        const Sampler& sampler = animation.samplers[binding.sampler];
+        const unsigned int first = pose.morphWeightOffsets[binding.target];
+        if (pose.morphWeightOffsets[binding.target + 1] - first != sampler.valuesPerKey) continue;
+        sampler.evaluateWeights(sampler, time, cursors[binding.sampler], pose.morphWeights.data() + first);
+    }
+}
+
 void GLTFAnimation::printAnimationInfo(const Animation& animation, size_t index) {
     std::cout << "Animation Info [" << index << "]:" << std::endl;
     std::cout << "Name: " << animation.name << std::endl;
@@ -232,3 +839,53 @@ void GLTFAnimation::printAnimationInfo(const Animation& animation, size_t index)
         std::cout << "    Extras: " << (sampler.extras ? "Yes" : "No") << std::endl;
     }
 }
+
+void GLTFAnimation::runKeyframeBenchmark(size_t keyCount, size_t channelCount, int frames) {
+    // Mocap-like clips: keys at 30 Hz with slightly uneven spacing, played back at 60 Hz
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> jitter(0.9f, 1.1f);
+    std::vector<std::vector<float>> times(channelCount);
+    std::vector<std::vector<glm::vec3>> values(channelCount);
+    for (size_t c = 0; c < channelCount; ++c) {
+        float time = 0.0f;
+        for (size_t k = 0; k < keyCount; ++k) {
+            times[c].push_back(time);
+            values[c].push_back(glm::vec3(static_cast<float>(k), static_cast<float>(c), time));
+            time += jitter(rng) / 30.0f;
+        }
+    }
+    float duration = times[0].back();
+
+    std::vector<Sampler> samplers(channelCount);
+    for (size_t c = 0; c < channelCount; ++c) {
+        samplers[c].inputTimes = times[c];
+        samplers[c].outputValuesVec3 = values[c];
+        prepareSampler(samplers[c], TargetPath::Translation);
+    }
+    std::vector<size_t> cursors(channelCount, 0);
+    std::vector<float> seekTimes(frames);
+    std::uniform_real_distribution<float> anyTime(0.0f, duration);
+    for (float& time : seekTimes) time = anyTime(rng);
+
+    auto time = [&](auto&& lookup) {
+        glm::vec3 sum(0.0f);
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int frame = 0; frame < frames; ++frame) {
+            for (size_t c = 0; c < channelCount; ++c) sum += lookup(frame, c);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        double nanoseconds = std::chrono::duration<double, std::nano>(end - start).count() / (static_cast<double>(frames) * channelCount);
+        return std::make_pair(nanoseconds, sum);
+    };
+    auto playbackTime = [&](int frame) { return std::fmod(frame / 60.0f, duration); };
+
+    auto linear = time([&](int frame, size_t c) { return interpolateLinearScan(times[c], values[c], playbackTime(frame)); });
+    auto cursor = time([&](int frame, size_t c) { return evaluateLinearVec3(samplers[c], playbackTime(frame), cursors[c]); });
+    auto seek = time([&](int frame, size_t c) { return evaluateLinearVec3(samplers[c], seekTimes[frame], cursors[c]); });
+
+    std::cout << "Keyframe lookup, " << channelCount << " channels x " << keyCount << " keys (" << duration << " s):" << std::endl;
+    std::cout << "  linear scan " << linear.first << " ns per lookup" << std::endl;
+    std::cout << "  cursor      " << cursor.first << " ns per lookup (x" << linear.first / cursor.first
+        << "), results " << (linear.second == cursor.second ? "match" : "differ") << std::endl;
+    std::cout << "  random seek " << seek.first << " ns per lookup" << std::endl;
+}
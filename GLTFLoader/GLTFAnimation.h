@@ -7,53 +7,187 @@
 #include <glm/fwd.hpp>
 #include "GLTFNode.h"
 #include "GLTFSkeleton.h"
-#include <algorithm> // any_of
+#include "GLTFQuantizedCurve.h"
+#include <algorithm> // upper_bound
+#include <unordered_map>
 
 class GLTFAnimation {
 public:
+    enum class TargetPath { Translation, Rotation, Scale, Weights, Unknown };
+
     struct Channel {
         int sampler;
         int targetNode;
         std::string targetPath;
+        TargetPath path = TargetPath::Unknown;
         yyjson_val* extensions;
         yyjson_val* extras;
     };
 
+    enum class Interpolation { Linear, Step, CubicSpline };
+
     struct Sampler {
         int input;
         int output;
         std::string interpolation;
+        Interpolation mode = Interpolation::Linear;
         yyjson_val* extensions;
         yyjson_val* extras;
         std::vector<float> inputTimes;
-        std::vector<glm::vec3> outputValuesVec3;
+        std::vector<glm::vec3> outputValuesVec3; // one value per key; CUBICSPLINE tangents are split off
         std::vector<glm::quat> outputValuesQuat;
+        // Morph weights: valuesPerKey consecutive values per key, as (in-tangents, values, out-tangents)
+        // for CUBICSPLINE
+        std::vector<float> outputValuesFloat;
+        size_t valuesPerKey = 0;
+        // CUBICSPLINE only: per segment, the Hermite curve as cubic coefficients (a, b, c, d) in the
+        // segment's normalized time, four consecutive entries per segment
+        std::vector<glm::vec3> hermiteVec3;
+        std::vector<glm::vec4> hermiteQuat;
+        // Set by compressAnimations for tracks within budget; their float keys are freed
+        GLTFQuantizedCurve quantized;
+        // Picked at load from the mode and the output type; null if the sampler cannot be evaluated
+        glm::vec3(*evaluateVec3)(const Sampler& sampler, float time, size_t& cursor) = nullptr;
+        glm::quat(*evaluateQuat)(const Sampler& sampler, float time, size_t& cursor) = nullptr;
+        void(*evaluateWeights)(const Sampler& sampler, float time, size_t& cursor, float* out) = nullptr; // writes valuesPerKey floats
+    };
+
+    // A channel resolved at load: which sampler drives which node
+    struct Binding {
+        int sampler;
+        int target; // node index
+    };
+
+    // Every usable channel of a clip, grouped by what it animates so evaluation runs one loop per path
+    struct BindingTable {
+        std::vector<Binding> translations;
+        std::vector<Binding> rotations;
+        std::vector<Binding> scales;
+        std::vector<Binding> weights; // the target node's mesh is morphed
+    };
+
+    // A clip sampled at a fixed rate, for playback without any key search. Frame-major per path: frame f
+    // of track k (the k-th binding of that path) is at [f * trackCount + k], so one frame is contiguous.
+    struct ResampledClip {
+        size_t frameCount = 0; // 0 when the clip is played from its source keys
+        float framesPerSecond = 0.0f;
+        float duration = 0.0f;
+        std::vector<glm::vec3> translations;
+        std::vector<glm::quat> rotations; // neighbouring frames share a hemisphere, so nlerp is safe
+        std::vector<glm::vec3> scales;
     };
 
     struct Animation {
         std::string name;
         std::vector<Channel> channels;
         std::vector<Sampler> samplers;
+        BindingTable bindings;
+        ResampledClip resampled;
+        float duration = 0.0f; // last key time over all samplers
         yyjson_val* extensions;
         yyjson_val* extras;
     };
 
+    // Error budgets for compressAnimations. A track is kept at full precision if quantizing it would move
+    // any of its target nodes further than the budget, scaled per node through nodeErrorScale (node index
+    // -> multiplier, e.g. below 1 for fingers and faces, above 1 for bones nobody looks at).
+    struct CompressionSettings {
+        float frameRate = 60.0f;          // key times are rounded to frames at this rate
+        float translationError = 0.001f;  // units, for translations and scales
+        float rotationError = 0.001f;     // radians
+        std::unordered_map<int, float> nodeErrorScale;
+    };
+
+    // Tolerances for reduceKeys. positionError bounds how far any node may drift from its unreduced path,
+    // counting what its ancestors' channels contribute. rotationError and scaleError (relative) cap a
+    // joint's own orientation and size where there is nothing below it to move.
+    struct KeyReductionSettings {
+        float positionError = 0.001f;
+        float rotationError = 0.001f;
+        float scaleError = 0.001f;
+    };
+
+    // Local TRS per node index, for evaluating an animation outside the node manager (model instances)
+    struct Pose {
+        std::vector<glm::vec3> translations;
+        std::vector<glm::quat> rotations;
+        std::vector<glm::vec3> scales;
+        // Morph target weights of every node whose mesh has targets, back to back: node n's are
+        // [morphWeightOffsets[n], morphWeightOffsets[n + 1]). Both stay empty when nothing is morphed.
+        std::vector<float> morphWeights;
+        std::vector<unsigned int> morphWeightOffsets; // node count + 1 entries
+    };
+
     //void parseAnimations(yyjson_val* animationsArray);
     void parseAnimations(yyjson_val* animationsArray, const GLTFAccessor& accessorManager, const GLTFBuffer& bufferManager);
     size_t getAnimationCount() const;
     const std::vector<Animation>& getAnimations() const;
 
-    void updateAnimation(float deltaTime, GLTFNode& nodeManager, GLTFSkeleton& skeleton, GLTFMesh& mesh);
-    void setAnimation(const std::string& animationName);
+    int findAnimation(const std::string& animationName) const; // -1 if there is none by that name
+    float getDuration(size_t animationIndex) const;
+    // Writes the channels of one animation at time into pose; nodes without channels are left alone.
+    // cursors holds the last key segment per sampler, so each caller keeps its own. Morph weights are
+    // written where the pose has room for them and the channel's value count matches the node's. Nodes
+    // with a non-zero skipNodes entry are not sampled and keep what pose holds (animation LOD).
+    void sampleAnimation(size_t animationIndex, float time, Pose& pose, std::vector<size_t>& cursors,
+        const std::vector<unsigned char>* skipNodes = nullptr) const;
+    // Grows largest[t] to the largest |weight| a weights sampler can produce for target t, over its keys
+    // and, for CUBICSPLINE, the overshoot its tangents allow. largest needs valuesPerKey entries.
+    static void growWeightRange(const Sampler& sampler, std::vector<float>& largest);
+
+    // Bakes every clip to frameRate frames per second. Playback then indexes the frame directly and does
+    // one lerp/nlerp per channel. The source keys are kept. Prints the memory added and the largest
+    // deviation from the source curves.
+    void resampleAnimations(float frameRate);
+    // Drops keys that interpolation from their neighbours reproduces within tolerance. LINEAR and STEP
+    // tracks are reduced, CUBICSPLINE tracks are kept. Each channel gets its share of the end-effector
+    // budget from the rest hierarchy: a rotation's share shrinks with the length of the limb below it,
+    // and channels stacked on one chain split the budget between them. Prints key counts per clip.
+    void reduceKeys(const KeyReductionSettings& settings, const GLTFNode& nodeManager);
+    // Replaces LINEAR tracks with quantized curves where they stay within the error budget. Sampling then
+    // decodes the keys on the fly. Prints how many tracks were compressed and the memory before and after.
+    void compressAnimations(const CompressionSettings& settings);
+
+    // Times keyframe lookup on synthetic clips: the old linear scan, cursors during playback, and seeks
+    static void runKeyframeBenchmark(size_t keyCount = 10000, size_t channelCount = 64, int frames = 2000);
 
 private:
     std::vector<Animation> animations;
-    size_t currentAnimation = 0;
-    float currentTime = 0.0f;
 
     void printAnimationInfo(const Animation& animation, size_t index);
-    glm::vec3 interpolateVec3(const std::vector<float>& input, const std::vector<glm::vec3>& output, float currentTime);
-    glm::quat interpolateQuat(const std::vector<float>& input, const std::vector<glm::quat>& output, float currentTime);
+    static TargetPath parseTargetPath(const std::string& path);
+    static void resample(Animation& animation, float frameRate);
+    static void compress(Animation& animation, const CompressionSettings& settings, size_t& compressedTracks,
+        size_t& keptTracks, size_t& bytesBefore, size_t& bytesAfter);
+    static void compileBindings(Animation& animation);
+    // Interpolates every binding at time and hands each value to the writer for its path. Resampled clips
+    // read their frames, others their source keys. Bindings whose target skip(node) accepts are not
+    // evaluated at all.
+    template <typename WriteTranslation, typename WriteRotation, typename WriteScale, typename Skip>
+    static void evaluateBindings(const Animation& animation, float time, size_t* cursors,
+        WriteTranslation&& writeTranslation, WriteRotation&& writeRotation, WriteScale&& writeScale, Skip&& skip);
+    template <typename WriteTranslation, typename WriteRotation, typename WriteScale, typename Skip>
+    static void evaluateKeys(const Animation& animation, float time, size_t* cursors,
+        WriteTranslation&& writeTranslation, WriteRotation&& writeRotation, WriteScale&& writeScale, Skip&& skip);
+    template <typename WriteTranslation, typename WriteRotation, typename WriteScale, typename Skip>
+    static void evaluateFrames(const Animation& animation, float time,
+        WriteTranslation&& writeTranslation, WriteRotation&& writeRotation, WriteScale&& writeScale, Skip&& skip);
+    // Segment i with input[i] <= time < input[i + 1], for time strictly inside the clip. Resumes from
+    // cursor, which is amortized O(1) during playback, and updates it.
+    static size_t findKey(const std::vector<float>& input, float time, size_t& cursor);
+    // Splits CUBICSPLINE triplets, builds the Hermite coefficients and picks the evaluators
+    static void prepareSampler(Sampler& sampler, TargetPath path);
+    static glm::vec3 evaluateLinearVec3(const Sampler& sampler, float time, size_t& cursor);
+    static glm::vec3 evaluateStepVec3(const Sampler& sampler, float time, size_t& cursor);
+    static glm::vec3 evaluateCubicVec3(const Sampler& sampler, float time, size_t& cursor);
+    static glm::quat evaluateLinearQuat(const Sampler& sampler, float time, size_t& cursor);
+    static glm::quat evaluateStepQuat(const Sampler& sampler, float time, size_t& cursor);
+    static glm::quat evaluateCubicQuat(const Sampler& sampler, float time, size_t& cursor);
+    static glm::vec3 evaluateQuantizedVec3(const Sampler& sampler, float time, size_t& cursor);
+    static glm::quat evaluateQuantizedQuat(const Sampler& sampler, float time, size_t& cursor);
+    static void evaluateLinearWeights(const Sampler& sampler, float time, size_t& cursor, float* out);
+    static void evaluateStepWeights(const Sampler& sampler, float time, size_t& cursor, float* out);
+    static void evaluateCubicWeights(const Sampler& sampler, float time, size_t& cursor, float* out);
 
     bool showDebug = false;
 };
@@ -0,0 +1,242 @@
+#include "GLTFAnimationBlender.h"
+#include "GLTFTransformKernels.h"
+#include <algorithm>
+#include <cmath>
+
+void GLTFAnimationBlender::initialize(const GLTFAnimation& animationManager, const GLTFAnimation::Pose& rest) {
+    animations = &animationManager;
+    restPose = &rest;
+    pose = rest;
+    sample = rest;
+    weights.assign(rest.translations.size(), 0.0f);
+    baseClips.clear();
+    baseClips.reserve(kMaxBaseClips);
+    layers.clear();
+
+    animatedNodes.clear();
+    const int nodeCount = static_cast<int>(rest.translations.size());
+    for (const auto& animation : animationManager.getAnimations()) {
+        for (const auto& channel : animation.channels) {
+            if (channel.targetNode >= 0 && channel.targetNode < nodeCount) animatedNodes.push_back(channel.targetNode);
+        }
+    }
+    std::sort(animatedNodes.begin(), animatedNodes.end());
+    animatedNodes.erase(std::unique(animatedNodes.begin(), animatedNodes.end()), animatedNodes.end());
+}
+
+GLTFAnimationBlender::Playback GLTFAnimationBlender::startPlayback(int animation) const {
+    Playback playback;
+    if (animations && animation >= 0 && animation < static_cast<int>(animations->getAnimationCount())) {
+        playback.animation = animation;
+        playback.cursors.assign(animations->getAnimations()[animation].samplers.size(), 0);
+    }
+    return playback;
+}
+
+void GLTFAnimationBlender::crossfadeTo(int animation, float fadeTime) {
+    if (fadeTime <= 0.0f) {
+        baseClips.clear();
+    }
+    else {
+        // Starting from the rest pose, the rest pose itself is what fades out; alone, the new clip's
+        // share would be 1 on the first update whatever its weight
+        if (baseClips.empty()) {
+            Playback rest = startPlayback(-1);
+            rest.weight = 1.0f;
+            baseClips.push_back(std::move(rest));
+        }
+        // Everything playing fades out on the same schedule as the new clip fades in
+        for (auto& clip : baseClips) {
+            clip.targetWeight = 0.0f;
+            clip.fadeRate = clip.weight / fadeTime;
+        }
+        if (baseClips.size() == kMaxBaseClips) baseClips.erase(baseClips.begin());
+    }
+
+    Playback next = startPlayback(animation);
+    next.targetWeight = 1.0f;
+    next.weight = fadeTime > 0.0f ? 0.0f : 1.0f;
+    next.fadeRate = fadeTime > 0.0f ? 1.0f / fadeTime : 0.0f;
+    baseClips.push_back(std::move(next));
+}
+
+int GLTFAnimationBlender::getCurrentAnimation() const {
+    return baseClips.empty() ? -1 : baseClips.back().animation;
+}
+
+void GLTFAnimationBlender::setTime(float time) {
+    if (!baseClips.empty()) baseClips.back().time = time;
+}
+
+float GLTFAnimationBlender::getTime() const {
+    return baseClips.empty() ? 0.0f : baseClips.back().time;
+}
+
+int GLTFAnimationBlender::addLayer(int animation, BlendMode mode, const std::vector<float>& mask, float weight) {
+    Layer layer;
+    layer.playback = startPlayback(animation);
+    layer.playback.weight = weight;
+    layer.playback.targetWeight = weight;
+    layer.mode = mode;
+    layer.mask = mask;
+    layer.mask.resize(mask.empty() ? 0 : pose.translations.size(), 0.0f);
+    if (mode == BlendMode::Additive) {
+        sampleClip(layer.playback);
+        layer.reference = sample;
+        std::fill(layer.playback.cursors.begin(), layer.playback.cursors.end(), 0);
+    }
+    layers.push_back(std::move(layer));
+    return static_cast<int>(layers.size()) - 1;
+}
+
+void GLTFAnimationBlender::setLayerWeight(int layer, float weight, float fadeTime) {
+    if (layer < 0 || layer >= static_cast<int>(layers.size())) return;
+    Playback& playback = layers[layer].playback;
+    playback.targetWeight = weight;
+    if (fadeTime > 0.0f) {
+        playback.fadeRate = std::abs(weight - playback.weight) / fadeTime;
+    }
+    else {
+        playback.weight = weight;
+        playback.fadeRate = 0.0f;
+    }
+}
+
+size_t GLTFAnimationBlender::getLayerCount() const {
+    return layers.size();
+}
+
+std::vector<float> GLTFAnimationBlender::buildSubtreeMask(const std::vector<int>& parents, int root) {
+    std::vector<float> mask(parents.size(), 0.0f);
+    for (size_t node = 0; node < parents.size(); ++node) {
+        for (int ancestor = static_cast<int>(node); ancestor >= 0; ancestor = parents[ancestor]) {
+            if (ancestor == root) {
+                mask[node] = 1.0f;
+                break;
+            }
+        }
+    }
+    return mask;
+}
+
+void GLTFAnimationBlender::advance(Playback& playback, float deltaTime) const {
+    if (playback.weight < playback.targetWeight) playback.weight = std::min(playback.targetWeight, playback.weight + playback.fadeRate * deltaTime);
+    else if (playback.weight > playback.targetWeight) playback.weight = std::max(playback.targetWeight, playback.weight - playback.fadeRate * deltaTime);
+
+    if (playback.animation < 0) return;
+    playback.time += deltaTime;
+    float duration = animations->getDuration(playback.animation);
+    if (duration > 0.0f && playback.time > duration) {
+        playback.time = std::fmod(playback.time, duration);
+    }
+}
+
+void GLTFAnimationBlender::sampleClip(Playback& playback) {
+    // Nodes the clip does not animate keep their rest values, like a single clip played on its own
+    std::copy(restPose->translations.begin(), restPose->translations.end(), sample.translations.begin());
+    std::copy(restPose->rotations.begin(), restPose->rotations.end(), sample.rotations.begin());
+    std::copy(restPose->scales.begin(), restPose->scales.end(), sample.scales.begin());
+    std::copy(restPose->morphWeights.begin(), restPose->morphWeights.end(), sample.morphWeights.begin());
+    if (playback.animation >= 0) animations->sampleAnimation(playback.animation, playback.time, sample, playback.cursors);
+}
+
+void GLTFAnimationBlender::blendSample() {
+    const size_t count = pose.translations.size();
+    GLTFTransformKernels::blendVec3(pose.translations.data(), sample.translations.data(), weights.data(), count);
+    GLTFTransformKernels::blendQuat(pose.rotations.data(), sample.rotations.data(), weights.data(), count);
+    GLTFTransformKernels::blendVec3(pose.scales.data(), sample.scales.data(), weights.data(), count);
+    blendMorphWeights(nullptr);
+}
+
+void GLTFAnimationBlender::addSample(const GLTFAnimation::Pose& reference) {
+    // Only animated nodes can differ from the reference
+    for (int node : animatedNodes) {
+        float w = weights[node];
+        if (w <= 0.0f) continue;
+        pose.translations[node] += (sample.translations[node] - reference.translations[node]) * w;
+
+        glm::quat delta = glm::conjugate(reference.rotations[node]) * sample.rotations[node];
+        if (delta.w < 0.0f) delta = -delta;
+        delta = glm::normalize(glm::quat(1.0f, 0.0f, 0.0f, 0.0f) * (1.0f - w) + delta * w);
+        pose.rotations[node] = glm::normalize(pose.rotations[node] * delta);
+
+        const glm::vec3& referenceScale = reference.scales[node];
+        for (int c = 0; c < 3; ++c) {
+            if (referenceScale[c] != 0.0f) pose.scales[node][c] *= 1.0f + (sample.scales[node][c] / referenceScale[c] - 1.0f) * w;
+        }
+    }
+    blendMorphWeights(&reference);
+}
+
+void GLTFAnimationBlender::blendMorphWeights(const GLTFAnimation::Pose* reference) {
+    const auto& offsets = pose.morphWeightOffsets;
+    for (size_t node = 0; node + 1 < offsets.size(); ++node) {
+        const float w = weights[node];
+        if (w <= 0.0f) continue;
+        for (unsigned int i = offsets[node]; i < offsets[node + 1]; ++i) {
+            float target = reference ? pose.morphWeights[i] + sample.morphWeights[i] - reference->morphWeights[i] : sample.morphWeights[i];
+            pose.morphWeights[i] += (target - pose.morphWeights[i]) * w;
+        }
+    }
+}
+
+void GLTFAnimationBlender::update(float deltaTime) {
+    if (!animations) return;
+
+    for (auto& clip : baseClips) advance(clip, deltaTime);
+    if (baseClips.size() > 1) {
+        // Clips that finished fading out are dropped; the current one stays
+        auto current = baseClips.end() - 1;
+        baseClips.erase(std::remove_if(baseClips.begin(), current,
+            [](const Playback& clip) { return clip.weight <= 0.0f && clip.targetWeight <= 0.0f; }), current);
+    }
+    for (auto& layer : layers) advance(layer.playback, deltaTime);
+
+    // Base: a running weighted average, each clip blended in by its share of the weight so far
+    std::copy(restPose->translations.begin(), restPose->translations.end(), pose.translations.begin());
+    std::copy(restPose->rotations.begin(), restPose->rotations.end(), pose.rotations.begin());
+    std::copy(restPose->scales.begin(), restPose->scales.end(), pose.scales.begin());
+    std::copy(restPose->morphWeights.begin(), restPose->morphWeights.end(), pose.morphWeights.begin());
+    float totalWeight = 0.0f;
+    for (auto& clip : baseClips) {
+        if (clip.weight <= 0.0f) continue;
+        totalWeight += clip.weight;
+        sampleClip(clip);
+        std::fill(weights.begin(), weights.end(), clip.weight / totalWeight);
+        blendSample();
+    }
+
+    for (auto& layer : layers) {
+        const float layerWeight = layer.playback.weight;
+        if (layerWeight <= 0.0f || layer.playback.animation < 0) continue;
+        sampleClip(layer.playback);
+        if (layer.mask.empty()) std::fill(weights.begin(), weights.end(), layerWeight);
+        else for (size_t node = 0; node < weights.size(); ++node) weights[node] = layer.mask[node] * layerWeight;
+
+        if (layer.mode == BlendMode::Additive) addSample(layer.reference);
+        else blendSample();
+    }
+}
+
+const GLTFAnimation::Pose& GLTFAnimationBlender::getPose() const {
+    return pose;
+}
+
+const std::vector<int>& GLTFAnimationBlender::getAnimatedNodes() const {
+    return animatedNodes;
+}
+
+size_t GLTFAnimationBlender::getMemoryUsage() const {
+    auto poseBytes = [](const GLTFAnimation::Pose& p) {
+        return p.translations.capacity() * sizeof(glm::vec3) + p.rotations.capacity() * sizeof(glm::quat)
+            + p.scales.capacity() * sizeof(glm::vec3) + p.morphWeights.capacity() * sizeof(float)
+            + p.morphWeightOffsets.capacity() * sizeof(unsigned int);
+    };
+    size_t bytes = poseBytes(pose) + poseBytes(sample) + weights.capacity() * sizeof(float)
+        + animatedNodes.capacity() * sizeof(int) + baseClips.capacity() * sizeof(Playback) + layers.capacity() * sizeof(Layer);
+    for (const auto& clip : baseClips) bytes += clip.cursors.capacity() * sizeof(size_t);
+    for (const auto& layer : layers) {
+        bytes += layer.playback.cursors.capacity() * sizeof(size_t) + layer.mask.capacity() * sizeof(float) + poseBytes(layer.reference);
+    }
+    return bytes;
+}
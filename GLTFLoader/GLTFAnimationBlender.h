@@ -0,0 +1,77 @@
+#ifndef GLTF_ANIMATION_BLENDER_H
+#define GLTF_ANIMATION_BLENDER_H
+
+#include <vector>
+#include "GLTFAnimation.h"
+
+// Mixes clips of one GLTFAnimation into a local pose. A base motion crossfades between clips; layers go on
+// top of it in the order they were added, each either replacing or adding to what is below and optionally
+// masked to part of the hierarchy. Whole poses are blended through GLTFTransformKernels. Scratch space is
+// sized when clips and layers are set, so update does not allocate.
+class GLTFAnimationBlender {
+public:
+    enum class BlendMode { Override, Additive };
+
+    // Both are referenced, not copied, so instances of one asset share them; they must outlive the blender
+    void initialize(const GLTFAnimation& animations, const GLTFAnimation::Pose& restPose);
+
+    // Fades the base motion from whatever is playing to animation over fadeTime seconds; 0 snaps. Any index
+    // that is not a clip fades to the rest pose.
+    void crossfadeTo(int animation, float fadeTime);
+    int getCurrentAnimation() const; // the clip being faded to, -1 for the rest pose
+    void setTime(float time);        // of the current clip
+    float getTime() const;
+
+    // mask weighs the layer per node index, empty for every node (see buildSubtreeMask). Additive layers
+    // add their clip's change from its first frame, so the clip should start in a neutral pose.
+    int addLayer(int animation, BlendMode mode, const std::vector<float>& mask = {}, float weight = 1.0f);
+    void setLayerWeight(int layer, float weight, float fadeTime = 0.0f);
+    size_t getLayerCount() const;
+    // 1 for root and everything below it, 0 elsewhere; e.g. the spine for an upper-body layer
+    static std::vector<float> buildSubtreeMask(const std::vector<int>& parents, int root);
+
+    // Advances every clip (looping) and every fade, then blends the pose
+    void update(float deltaTime);
+    const GLTFAnimation::Pose& getPose() const;
+    // Nodes any clip animates. The pose holds the rest values for all others.
+    const std::vector<int>& getAnimatedNodes() const;
+    size_t getMemoryUsage() const;
+
+private:
+    struct Playback {
+        int animation = -1;
+        float time = 0.0f;
+        float weight = 0.0f;
+        float targetWeight = 0.0f;
+        float fadeRate = 0.0f; // weight per second towards targetWeight
+        std::vector<size_t> cursors;
+    };
+
+    struct Layer {
+        Playback playback;
+        BlendMode mode = BlendMode::Override;
+        std::vector<float> mask;
+        GLTFAnimation::Pose reference; // Additive only: the clip's first frame
+    };
+
+    static const size_t kMaxBaseClips = 4; // the oldest fade is dropped past this
+
+    const GLTFAnimation* animations = nullptr;
+    const GLTFAnimation::Pose* restPose = nullptr;
+    GLTFAnimation::Pose pose;
+    GLTFAnimation::Pose sample;  // one clip at a time
+    std::vector<float> weights;  // per node, for the kernels
+    std::vector<Playback> baseClips; // the last one is the current clip
+    std::vector<Layer> layers;
+    std::vector<int> animatedNodes;
+
+    Playback startPlayback(int animation) const;
+    void advance(Playback& playback, float deltaTime) const;
+    void sampleClip(Playback& playback); // into sample, over the rest pose
+    void blendSample(); // pose towards sample by weights
+    void addSample(const GLTFAnimation::Pose& reference);
+    // Morph weights by node weight: towards sample, or by sample's offset from reference when additive
+    void blendMorphWeights(const GLTFAnimation::Pose* reference);
+};
+
+#endif // GLTF_ANIMATION_BLENDER_H
@@ -0,0 +1,270 @@
+#include "GLTFBoneProxies.h"
+#include "GLTFSimd.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+    // Largest scale of the upper 3x3, so posed radii stay conservative under non-uniform scale
+    inline float maxAxisScale(const glm::mat4& m) {
+        float xx = glm::dot(glm::vec3(m[0]), glm::vec3(m[0]));
+        float yy = glm::dot(glm::vec3(m[1]), glm::vec3(m[1]));
+        float zz = glm::dot(glm::vec3(m[2]), glm::vec3(m[2]));
+        return std::sqrt(std::max(xx, std::max(yy, zz)));
+    }
+
+    inline float distanceToSegmentSquared(const glm::vec3& point, const glm::vec3& a, const glm::vec3& b) {
+        glm::vec3 ab = b - a;
+        float lengthSquared = glm::dot(ab, ab);
+        float t = lengthSquared > 0.0f ? glm::clamp(glm::dot(point - a, ab) / lengthSquared, 0.0f, 1.0f) : 0.0f;
+        glm::vec3 d = point - (a + ab * t);
+        return glm::dot(d, d);
+    }
+
+    inline float intersectSphere(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& center, float radius) {
+        glm::vec3 oc = origin - center;
+        float b = glm::dot(oc, direction);
+        float c = glm::dot(oc, oc) - radius * radius;
+        float h = b * b - c;
+        return h < 0.0f ? -1.0f : -b - std::sqrt(h);
+    }
+
+    // Ray (unit direction) against a capsule: the cylinder body first, then whichever cap the ray reaches.
+    // Returns a negative distance on a miss; callers handle origins inside the capsule separately.
+    float intersectCapsule(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& a, const glm::vec3& b, float radius) {
+        glm::vec3 ba = b - a;
+        glm::vec3 oa = origin - a;
+        float baba = glm::dot(ba, ba);
+        if (baba <= 1e-12f) return intersectSphere(origin, direction, a, radius);
+
+        float bard = glm::dot(ba, direction);
+        float baoa = glm::dot(ba, oa);
+        float rdoa = glm::dot(direction, oa);
+        float oaoa = glm::dot(oa, oa);
+        float qa = baba - bard * bard;
+        float qb = baba * rdoa - baoa * bard;
+        float qc = baba * oaoa - baoa * baoa - radius * radius * baba;
+        float h = qb * qb - qa * qc;
+        if (h < 0.0f) return -1.0f;
+
+        // A ray parallel to the axis can only enter through a cap; pick it by where the origin projects
+        float y = baoa;
+        if (qa > 1e-12f) {
+            float t = (-qb - std::sqrt(h)) / qa;
+            y = baoa + t * bard;
+            if (y > 0.0f && y < baba) return t;
+        }
+        return intersectSphere(origin, direction, y <= 0.0f ? a : b, radius);
+    }
+}
+
+void GLTFBoneProxies::build(const std::vector<const std::vector<Vertex>*>& vertexSets, size_t boneCount, float minWeight) {
+    clear();
+
+    std::vector<std::vector<glm::vec3>> bonePoints(boneCount);
+    for (const auto* vertices : vertexSets) {
+        for (const Vertex& vertex : *vertices) {
+            for (int k = 0; k < 4; ++k) {
+                int joint = vertex.joints[k];
+                if (vertex.weights[k] < minWeight || joint < 0 || joint >= static_cast<int>(boneCount)) continue;
+                bonePoints[joint].push_back(vertex.position);
+            }
+        }
+    }
+
+    for (size_t bone = 0; bone < boneCount; ++bone) {
+        const auto& points = bonePoints[bone];
+        if (points.empty()) continue;
+
+        // Axis along the direction of greatest spread (power iteration on the covariance)
+        glm::vec3 mean(0.0f);
+        for (const auto& point : points) mean += point;
+        mean /= static_cast<float>(points.size());
+
+        glm::mat3 covariance(0.0f);
+        for (const auto& point : points) {
+            glm::vec3 d = point - mean;
+            covariance += glm::outerProduct(d, d);
+        }
+
+        glm::vec3 axis(covariance[0][0], covariance[1][1], covariance[2][2]);
+        int largest = axis.x >= axis.y ? (axis.x >= axis.z ? 0 : 2) : (axis.y >= axis.z ? 1 : 2);
+        axis = glm::vec3(0.0f);
+        axis[largest] = 1.0f;
+        for (int iteration = 0; iteration < 32; ++iteration) {
+            glm::vec3 next = covariance * axis;
+            float length = glm::length(next);
+            if (length <= 0.0f) break;
+            axis = next / length;
+        }
+
+        // Radius from the spread around the axis; the segment then spans the points minus the caps
+        float minT = FLT_MAX;
+        float maxT = -FLT_MAX;
+        float radiusSquared = 0.0f;
+        for (const auto& point : points) {
+            glm::vec3 d = point - mean;
+            float t = glm::dot(d, axis);
+            minT = std::min(minT, t);
+            maxT = std::max(maxT, t);
+            glm::vec3 radial = d - axis * t;
+            radiusSquared = std::max(radiusSquared, glm::dot(radial, radial));
+        }
+        float radius = std::sqrt(radiusSquared);
+        float startT = std::min(minT + radius, (minT + maxT) * 0.5f);
+        float endT = std::max(maxT - radius, (minT + maxT) * 0.5f);
+        glm::vec3 a = mean + axis * startT;
+        glm::vec3 b = mean + axis * endT;
+
+        // Points beyond the segment ends can poke out of the caps; grow the radius to contain them
+        for (const auto& point : points) {
+            radiusSquared = std::max(radiusSquared, distanceToSegmentSquared(point, a, b));
+        }
+
+        bindPoints.push_back(glm::vec4(a, 1.0f));
+        bindPoints.push_back(glm::vec4(b, 1.0f));
+        bindRadii.push_back(std::sqrt(radiusSquared));
+        capsuleBones.push_back(static_cast<int>(bone));
+    }
+
+    posedPoints = bindPoints;
+    posedRadii = bindRadii;
+    std::cout << "Bone proxies: " << capsuleBones.size() << " capsules for " << boneCount << " bones" << std::endl;
+}
+
+void GLTFBoneProxies::clear() {
+    bindPoints.clear();
+    posedPoints.clear();
+    bindRadii.clear();
+    posedRadii.clear();
+    capsuleBones.clear();
+}
+
+bool GLTFBoneProxies::isEmpty() const {
+    return capsuleBones.empty();
+}
+
+void GLTFBoneProxies::update(const std::vector<glm::mat4>& jointMatrices) {
+    if (capsuleBones.empty()) return;
+    switch (GLTFSimd::getLevel()) {
+    case GLTFSimd::Level::AVX2: updateAVX2(jointMatrices); break;
+    case GLTFSimd::Level::SSE: updateSSE(jointMatrices); break;
+    default: updateScalar(jointMatrices); break;
+    }
+}
+
+void GLTFBoneProxies::updateScalar(const std::vector<glm::mat4>& jointMatrices) {
+    for (size_t i = 0; i < capsuleBones.size(); ++i) {
+        int bone = capsuleBones[i];
+        if (bone >= static_cast<int>(jointMatrices.size())) continue;
+        const glm::mat4& m = jointMatrices[bone];
+        posedPoints[i * 2 + 0] = m * bindPoints[i * 2 + 0];
+        posedPoints[i * 2 + 1] = m * bindPoints[i * 2 + 1];
+        posedRadii[i] = bindRadii[i] * maxAxisScale(m);
+    }
+}
+
+void GLTFBoneProxies::updateSSE(const std::vector<glm::mat4>& jointMatrices) {
+#if defined(GLTF_SIMD_X86)
+    // Column-major: each posed point is c0 * x + c1 * y + c2 * z + c3 with the columns kept in registers
+    for (size_t i = 0; i < capsuleBones.size(); ++i) {
+        int bone = capsuleBones[i];
+        if (bone >= static_cast<int>(jointMatrices.size())) continue;
+        const float* m = &jointMatrices[bone][0][0];
+        __m128 c0 = _mm_loadu_ps(m + 0);
+        __m128 c1 = _mm_loadu_ps(m + 4);
+        __m128 c2 = _mm_loadu_ps(m + 8);
+        __m128 c3 = _mm_loadu_ps(m + 12);
+
+        for (size_t k = i * 2; k < i * 2 + 2; ++k) {
+            __m128 p = _mm_loadu_ps(&bindPoints[k].x);
+            __m128 result = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(c0, _mm_shuffle_ps(p, p, 0x00)), _mm_mul_ps(c1, _mm_shuffle_ps(p, p, 0x55))),
+                _mm_add_ps(_mm_mul_ps(c2, _mm_shuffle_ps(p, p, 0xAA)), c3));
+            _mm_storeu_ps(&posedPoints[k].x, result);
+        }
+        posedRadii[i] = bindRadii[i] * maxAxisScale(jointMatrices[bone]);
+    }
+#else
+    updateScalar(jointMatrices);
+#endif
+}
+
+GLTF_TARGET_AVX2 void GLTFBoneProxies::updateAVX2(const std::vector<glm::mat4>& jointMatrices) {
+#if defined(GLTF_SIMD_X86)
+    // Both endpoints of a capsule in one register: columns are broadcast to both halves and each half
+    // splats its own endpoint's x, y and z
+    for (size_t i = 0; i < capsuleBones.size(); ++i) {
+        int bone = capsuleBones[i];
+        if (bone >= static_cast<int>(jointMatrices.size())) continue;
+        const float* m = &jointMatrices[bone][0][0];
+        __m256 c0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 0));
+        __m256 c1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 4));
+        __m256 c2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 8));
+        __m256 c3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 12));
+
+        __m256 ab = _mm256_loadu_ps(&bindPoints[i * 2].x);
+        __m256 result = _mm256_fmadd_ps(c0, _mm256_permute_ps(ab, 0x00),
+            _mm256_fmadd_ps(c1, _mm256_permute_ps(ab, 0x55),
+                _mm256_fmadd_ps(c2, _mm256_permute_ps(ab, 0xAA), c3)));
+        _mm256_storeu_ps(&posedPoints[i * 2].x, result);
+        posedRadii[i] = bindRadii[i] * maxAxisScale(jointMatrices[bone]);
+    }
+#else
+    updateScalar(jointMatrices);
+#endif
+}
+
+bool GLTFBoneProxies::raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Hit& hit) const {
+    float length = glm::length(direction);
+    if (!(length > 0.0f)) return false;
+    glm::vec3 unitDirection = direction / length;
+
+    float closest = maxDistance;
+    int closestBone = -1;
+    for (size_t i = 0; i < capsuleBones.size(); ++i) {
+        glm::vec3 a = glm::vec3(posedPoints[i * 2 + 0]);
+        glm::vec3 b = glm::vec3(posedPoints[i * 2 + 1]);
+        float radius = posedRadii[i];
+
+        float distance;
+        if (distanceToSegmentSquared(origin, a, b) <= radius * radius) {
+            distance = 0.0f;
+        }
+        else {
+            distance = intersectCapsule(origin, unitDirection, a, b, radius);
+            if (distance < 0.0f) continue;
+        }
+
+        if (distance < closest) {
+            closest = distance;
+            closestBone = capsuleBones[i];
+        }
+    }
+
+    if (closestBone < 0) return false;
+    hit.bone = closestBone;
+    hit.distance = closest;
+    return true;
+}
+
+void GLTFBoneProxies::overlapSphere(const glm::vec3& center, float radius, std::vector<int>& bones) const {
+    for (size_t i = 0; i < capsuleBones.size(); ++i) {
+        float reach = radius + posedRadii[i];
+        if (distanceToSegmentSquared(center, glm::vec3(posedPoints[i * 2 + 0]), glm::vec3(posedPoints[i * 2 + 1])) <= reach * reach) {
+            bones.push_back(capsuleBones[i]);
+        }
+    }
+}
+
+size_t GLTFBoneProxies::size() const {
+    return capsuleBones.size();
+}
+
+GLTFBoneProxies::Capsule GLTFBoneProxies::getCapsule(size_t index) const {
+    return Capsule{ capsuleBones[index], glm::vec3(posedPoints[index * 2]), glm::vec3(posedPoints[index * 2 + 1]), posedRadii[index] };
+}
+
+GLTFBoneProxies::Capsule GLTFBoneProxies::getBindCapsule(size_t index) const {
+    return Capsule{ capsuleBones[index], glm::vec3(bindPoints[index * 2]), glm::vec3(bindPoints[index * 2 + 1]), bindRadii[index] };
+}
@@ -0,0 +1,55 @@
+#ifndef GLTF_BONE_PROXIES_H
+#define GLTF_BONE_PROXIES_H
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "Vertex.h"
+
+// One capsule per bone, fitted at load to the bind-pose vertices the bone drives, then carried along by the
+// joint matrices. Much cheaper than triangle tests for gameplay hit detection on animated characters.
+// Everything is in the skinned mesh's model space, the same space the joint matrices map into.
+class GLTFBoneProxies {
+public:
+    struct Capsule {
+        int bone = -1; // index into the skeleton's bones and joint matrices
+        glm::vec3 a = glm::vec3(0.0f);
+        glm::vec3 b = glm::vec3(0.0f);
+        float radius = 0.0f;
+    };
+
+    struct Hit {
+        int bone = -1;
+        float distance = 0.0f; // along the normalized ray; 0 when the origin starts inside
+    };
+
+    // Vertices count towards a bone when it carries at least minWeight of them. Bones without any such
+    // vertices get no capsule.
+    void build(const std::vector<const std::vector<Vertex>*>& vertexSets, size_t boneCount, float minWeight);
+    void clear();
+    bool isEmpty() const;
+
+    // Poses every capsule from the joint matrices, using the widest SIMD kernel the CPU supports
+    void update(const std::vector<glm::mat4>& jointMatrices);
+
+    bool raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Hit& hit) const;
+    // Bones whose capsules touch the sphere
+    void overlapSphere(const glm::vec3& center, float radius, std::vector<int>& bones) const;
+
+    size_t size() const;
+    Capsule getCapsule(size_t index) const; // current pose
+    Capsule getBindCapsule(size_t index) const;
+
+private:
+    // Endpoints as (a, b) pairs with w = 1, so one capsule is 8 contiguous floats for the SIMD kernels
+    std::vector<glm::vec4> bindPoints;
+    std::vector<glm::vec4> posedPoints;
+    std::vector<float> bindRadii;
+    std::vector<float> posedRadii;
+    std::vector<int> capsuleBones;
+
+    void updateScalar(const std::vector<glm::mat4>& jointMatrices);
+    void updateSSE(const std::vector<glm::mat4>& jointMatrices);
+    void updateAVX2(const std::vector<glm::mat4>& jointMatrices);
+};
+
+#endif // GLTF_BONE_PROXIES_H
@@ -0,0 +1,68 @@
+#ifndef GLTF_BOUNDS_H
+#define GLTF_BOUNDS_H
+
+#include <cfloat>
+#include <glm/glm.hpp>
+
+// Axis-aligned bounding box. A default-constructed box is empty and takes the shape of whatever is merged
+// into it. (glm::min) is parenthesized so the windows.h min/max macros cannot expand here.
+struct AABB {
+    glm::vec3 min = glm::vec3(FLT_MAX);
+    glm::vec3 max = glm::vec3(-FLT_MAX);
+
+    bool isEmpty() const {
+        return min.x > max.x || min.y > max.y || min.z > max.z;
+    }
+
+    void expand(const glm::vec3& point) {
+        min = (glm::min)(min, point);
+        max = (glm::max)(max, point);
+    }
+
+    void merge(const AABB& other) {
+        if (other.isEmpty()) return;
+        min = (glm::min)(min, other.min);
+        max = (glm::max)(max, other.max);
+    }
+
+    glm::vec3 center() const { return (min + max) * 0.5f; }
+    glm::vec3 size() const { return max - min; }
+
+    float surfaceArea() const {
+        if (isEmpty()) return 0.0f;
+        glm::vec3 d = max - min;
+        return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+
+    // Box around this box after an affine transform (Arvo 1990)
+    AABB transformed(const glm::mat4& m) const {
+        if (isEmpty()) return AABB();
+        AABB result;
+        result.min = result.max = glm::vec3(m[3]);
+        for (int column = 0; column < 3; ++column) {
+            glm::vec3 a = glm::vec3(m[column]) * min[column];
+            glm::vec3 b = glm::vec3(m[column]) * max[column];
+            result.min += (glm::min)(a, b);
+            result.max += (glm::max)(a, b);
+        }
+        return result;
+    }
+
+    // Slab test against a ray given as origin and 1 / direction. tNear is the entry distance, clamped to 0.
+    bool intersectRay(const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance, float& tNear) const {
+        if (isEmpty()) return false;
+        glm::vec3 t0 = (min - origin) * inverseDirection;
+        glm::vec3 t1 = (max - origin) * inverseDirection;
+        glm::vec3 tMin = (glm::min)(t0, t1);
+        glm::vec3 tMax = (glm::max)(t0, t1);
+        float enter = (glm::max)((glm::max)(tMin.x, tMin.y), (glm::max)(tMin.z, 0.0f));
+        float exit = (glm::min)((glm::min)(tMax.x, tMax.y), (glm::min)(tMax.z, maxDistance));
+        tNear = enter;
+        return enter <= exit;
+    }
+
+    bool operator==(const AABB& other) const { return min == other.min && max == other.max; }
+    bool operator!=(const AABB& other) const { return !(*this == other); }
+};
+
+#endif // GLTF_BOUNDS_H
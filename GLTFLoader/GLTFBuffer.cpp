@@ -133,6 +133,7 @@ std::vector<glm::vec3> GLTFBuffer::getPositions(const GLTFAccessor::Accessor& ac
     std::vector<glm::vec3> data;
 
     if (accessor.bufferView < 0 || accessor.bufferView >= bufferViews.size()) {
+        if (loadSparseWithoutBase(accessor, data)) return data;
         std::cerr << "Error: Invalid bufferView index in accessor." << std::endl;
         return data;
     }
@@ -155,6 +156,7 @@ std::vector<glm::vec3> GLTFBuffer::getPositions(const GLTFAccessor::Accessor& ac
         std::memcpy(&data[i], &buffer.data[offset], sizeof(glm::vec3));
     }
 
+    applySparse(accessor, data);
     return data;
 }
 
@@ -162,6 +164,7 @@ std::vector<glm::vec3> GLTFBuffer::getNormals(const GLTFAccessor::Accessor& acce
     std::vector<glm::vec3> data;
 
     if (accessor.bufferView < 0 || accessor.bufferView >= bufferViews.size()) {
+        if (loadSparseWithoutBase(accessor, data)) return data;
         std::cerr << "Error: Invalid bufferView index in accessor." << std::endl;
         return data;
     }
@@ -184,6 +187,7 @@ std::vector<glm::vec3> GLTFBuffer::getNormals(const GLTFAccessor::Accessor& acce
         std::memcpy(&data[i], &buffer.data[offset], sizeof(glm::vec3));
     }
 
+    applySparse(accessor, data);
     return data;
 }
 
@@ -191,6 +195,7 @@ std::vector<glm::vec2> GLTFBuffer::getTexcoords(const GLTFAccessor::Accessor& ac
     std::vector<glm::vec2> data;
 
     if (accessor.bufferView < 0 || accessor.bufferView >= bufferViews.size()) {
+        if (loadSparseWithoutBase(accessor, data)) return data;
         std::cerr << "Error: Invalid bufferView index in accessor." << std::endl;
         return data;
     }
@@ -213,6 +218,7 @@ std::vector<glm::vec2> GLTFBuffer::getTexcoords(const GLTFAccessor::Accessor& ac
         std::memcpy(&data[i], &buffer.data[offset], sizeof(glm::vec2));
     }
 
+    applySparse(accessor, data);
     return data;
 }
 
@@ -228,20 +234,18 @@ std::vector<unsigned int> GLTFBuffer::getIndices(const GLTFAccessor::Accessor& a
     const Buffer& buffer = buffers[bufferView.buffer];
 
     size_t byteOffset = accessor.byteOffset + bufferView.byteOffset;
-    size_t stride = sizeof(unsigned short);  // Assuming UNSIGNED_SHORT for indices
+    size_t stride = getComponentSize(accessor.componentType); // UNSIGNED_BYTE, UNSIGNED_SHORT or UNSIGNED_INT
     size_t count = accessor.count;
 
     data.resize(count);
 
     for (size_t i = 0; i < count; ++i) {
         size_t offset = byteOffset + i * stride;
-        if (offset + sizeof(unsigned short) > buffer.data.size()) {
+        if (offset + stride > buffer.data.size()) {
             std::cerr << "Error: Buffer overflow when accessing data." << std::endl;
             break;
         }
-        unsigned short index;
-        std::memcpy(&index, &buffer.data[offset], sizeof(unsigned short));
-        data[i] = index;
+        data[i] = readIndex(&buffer.data[offset], accessor.componentType);
     }
 
     return data;
@@ -249,6 +253,13 @@ std::vector<unsigned int> GLTFBuffer::getIndices(const GLTFAccessor::Accessor& a
 
 std::vector<glm::vec4> GLTFBuffer::getColors(const GLTFAccessor::Accessor& accessor) const {
     std::vector<glm::vec4> colors;
+
+    if (accessor.bufferView < 0 || accessor.bufferView >= bufferViews.size()) {
+        if (loadSparseWithoutBase(accessor, colors)) return colors;
+        std::cerr << "Error: Invalid bufferView index in accessor." << std::endl;
+        return colors;
+    }
+
     const auto& bufferView = bufferViews[accessor.bufferView];
     const auto& buffer = buffers[bufferView.buffer];
     const unsigned char* data = buffer.data.data() + bufferView.byteOffset + accessor.byteOffset;
@@ -260,12 +271,20 @@ std::vector<glm::vec4> GLTFBuffer::getColors(const GLTFAccessor::Accessor& acces
         std::memcpy(&colors[i], data + i * stride, sizeof(glm::vec4));
     }
 
+    applySparse(accessor, colors);
     return colors;
 }
 
 std::vector<glm::vec4> GLTFBuffer::getJoints(const GLTFAccessor::Accessor& jointsAccessor) const {
     size_t numComponents = getNumComponents(jointsAccessor.type);
 
+    if (jointsAccessor.bufferView < 0 || jointsAccessor.bufferView >= bufferViews.size()) {
+        std::vector<glm::vec4> joints;
+        if (loadSparseWithoutBase(jointsAccessor, joints)) return joints;
+        std::cerr << "Error: Invalid bufferView index in accessor." << std::endl;
+        return joints;
+    }
+
     const auto& jointsBufferView = bufferViews[jointsAccessor.bufferView];
     const auto& jointsBuffer = buffers[jointsBufferView.buffer];
 
@@ -301,12 +320,20 @@ std::vector<glm::vec4> GLTFBuffer::getJoints(const GLTFAccessor::Accessor& joint
             joints[i] = joint;
         }
     }
+    applySparse(jointsAccessor, joints);
     return joints;
 }
 
 std::vector<glm::vec4> GLTFBuffer::getWeights(const GLTFAccessor::Accessor& accessor) const {
     size_t numComponents = getNumComponents(accessor.type);
 
+    if (accessor.bufferView < 0 || accessor.bufferView >= bufferViews.size()) {
+        std::vector<glm::vec4> weights;
+        if (loadSparseWithoutBase(accessor, weights)) return weights;
+        std::cerr << "Error: Invalid bufferView index in accessor." << std::endl;
+        return weights;
+    }
+
     const auto& bufferView = bufferViews[accessor.bufferView];
     const auto& buffer = buffers[bufferView.buffer];
 
@@ -337,6 +364,7 @@ std::vector<glm::vec4> GLTFBuffer::getWeights(const GLTFAccessor::Accessor& acce
         }
         weights.push_back(weight);
     }
+    applySparse(accessor, weights);
     return weights;
 }
 
@@ -369,6 +397,7 @@ std::vector<float> GLTFBuffer::getAccessorDataFloat(const GLTFAccessor::Accessor
     std::vector<float> data;
 
     if (accessor.bufferView < 0 || accessor.bufferView >= bufferViews.size()) {
+        if (loadSparseWithoutBase(accessor, data)) return data;
         std::cerr << "Error: Invalid bufferView index in accessor." << std::endl;
         return data;
     }
@@ -382,6 +411,7 @@ std::vector<float> GLTFBuffer::getAccessorDataFloat(const GLTFAccessor::Accessor
     data.resize(count);
     std::memcpy(data.data(), buffer.data.data() + byteOffset, count * sizeof(float));
 
+    applySparse(accessor, data);
     return data;
 }
 
@@ -389,6 +419,7 @@ std::vector<glm::vec3> GLTFBuffer::getAccessorDataVec3(const GLTFAccessor::Acces
     std::vector<glm::vec3> data;
 
     if (accessor.bufferView < 0 || accessor.bufferView >= bufferViews.size()) {
+        if (loadSparseWithoutBase(accessor, data)) return data;
         std::cerr << "Error: Invalid bufferView index in accessor." << std::endl;
         return data;
     }
@@ -402,6 +433,7 @@ std::vector<glm::vec3> GLTFBuffer::getAccessorDataVec3(const GLTFAccessor::Acces
     data.resize(count);
     std::memcpy(data.data(), buffer.data.data() + byteOffset, count * sizeof(glm::vec3));
 
+    applySparse(accessor, data);
     return data;
 }
 
@@ -409,6 +441,7 @@ std::vector<glm::quat> GLTFBuffer::getAccessorDataQuat(const GLTFAccessor::Acces
     std::vector<glm::quat> data;
 
     if (accessor.bufferView < 0 || accessor.bufferView >= bufferViews.size()) {
+        if (loadSparseWithoutBase(accessor, data)) return data;
         std::cerr << "Error: Invalid bufferView index in accessor." << std::endl;
         return data;
     }
@@ -422,6 +455,7 @@ std::vector<glm::quat> GLTFBuffer::getAccessorDataQuat(const GLTFAccessor::Acces
     data.resize(count);
     std::memcpy(data.data(), buffer.data.data() + byteOffset, count * sizeof(glm::quat));
 
+    applySparse(accessor, data);
     return data;
 }
 
@@ -431,4 +465,174 @@ size_t GLTFBuffer::getNumComponents(const std::string& accessorType) const {
     if (accessorType == "VEC3") return 3;
     if (accessorType == "VEC4") return 4;
     throw std::runtime_error("Unsupported accessor type");
-}
\ No newline at end of file
+}
+
+size_t GLTFBuffer::getComponentSize(int componentType) const {
+    switch (componentType) {
+    case GL_BYTE:
+    case GL_UNSIGNED_BYTE: return 1;
+    case GL_SHORT:
+    case GL_UNSIGNED_SHORT: return 2;
+    case GL_UNSIGNED_INT:
+    case GL_FLOAT: return 4;
+    default: throw std::runtime_error("Unsupported component type");
+    }
+}
+
+float GLTFBuffer::readComponent(const unsigned char* data, int componentType, bool normalized) const {
+    switch (componentType) {
+    case GL_FLOAT: {
+        float value;
+        std::memcpy(&value, data, sizeof(float));
+        return value;
+    }
+    case GL_BYTE: {
+        int8_t value = static_cast<int8_t>(data[0]);
+        return normalized ? (value == -128 ? -1.0f : value / 127.0f) : static_cast<float>(value);
+    }
+    case GL_UNSIGNED_BYTE:
+        return normalized ? data[0] / 255.0f : static_cast<float>(data[0]);
+    case GL_SHORT: {
+        int16_t value;
+        std::memcpy(&value, data, sizeof(int16_t));
+        return normalized ? (value == -32768 ? -1.0f : value / 32767.0f) : static_cast<float>(value);
+    }
+    case GL_UNSIGNED_SHORT: {
+        uint16_t value;
+        std::memcpy(&value, data, sizeof(uint16_t));
+        return normalized ? value / 65535.0f : static_cast<float>(value);
+    }
+    case GL_UNSIGNED_INT: {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(uint32_t));
+        return static_cast<float>(value);
+    }
+    default:
+        throw std::runtime_error("Unsupported component type");
+    }
+}
+
+unsigned int GLTFBuffer::readIndex(const unsigned char* data, int componentType) const {
+    switch (componentType) {
+    case GL_UNSIGNED_BYTE:
+        return data[0];
+    case GL_UNSIGNED_SHORT: {
+        uint16_t value;
+        std::memcpy(&value, data, sizeof(uint16_t));
+        return value;
+    }
+    case GL_UNSIGNED_INT: {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(uint32_t));
+        return value;
+    }
+    default:
+        throw std::runtime_error("Unsupported index component type");
+    }
+}
+
+bool GLTFBuffer::readSparseElements(const GLTFAccessor::Accessor& accessor, std::vector<unsigned int>& indices, std::vector<float>& values) const {
+    const auto& sparse = accessor.sparseData;
+    if (sparse.indicesBufferView < 0 || sparse.indicesBufferView >= bufferViews.size() ||
+        sparse.valuesBufferView < 0 || sparse.valuesBufferView >= bufferViews.size()) {
+        std::cerr << "Error: Invalid sparse bufferView index in accessor." << std::endl;
+        return false;
+    }
+
+    const BufferView& indicesView = bufferViews[sparse.indicesBufferView];
+    const BufferView& valuesView = bufferViews[sparse.valuesBufferView];
+    const Buffer& indicesBuffer = buffers[indicesView.buffer];
+    const Buffer& valuesBuffer = buffers[valuesView.buffer];
+
+    size_t numComponents = getNumComponents(accessor.type);
+    size_t indexSize = getComponentSize(sparse.indicesComponentType);
+    size_t valueSize = getComponentSize(accessor.componentType);
+
+    size_t indicesStart = indicesView.byteOffset + sparse.indicesByteOffset;
+    size_t valuesStart = valuesView.byteOffset + sparse.valuesByteOffset;
+    if (indicesStart + sparse.count * indexSize > indicesBuffer.data.size() ||
+        valuesStart + sparse.count * numComponents * valueSize > valuesBuffer.data.size()) {
+        std::cerr << "Error: Buffer overflow when accessing sparse data." << std::endl;
+        return false;
+    }
+
+    const unsigned char* indicesData = indicesBuffer.data.data() + indicesStart;
+    const unsigned char* valuesData = valuesBuffer.data.data() + valuesStart;
+
+    indices.resize(sparse.count);
+    values.resize(sparse.count * numComponents);
+    for (size_t i = 0; i < sparse.count; ++i) {
+        indices[i] = readIndex(indicesData + i * indexSize, sparse.indicesComponentType);
+        for (size_t c = 0; c < numComponents; ++c) {
+            values[i * numComponents + c] = readComponent(valuesData + (i * numComponents + c) * valueSize, accessor.componentType, accessor.normalized);
+        }
+    }
+    return true;
+}
+
+template <typename T>
+void GLTFBuffer::applySparse(const GLTFAccessor::Accessor& accessor, std::vector<T>& data) const {
+    if (!accessor.sparse) return;
+
+    std::vector<unsigned int> indices;
+    std::vector<float> values;
+    if (!readSparseElements(accessor, indices, values)) return;
+
+    // Substitute only the listed elements; the rest of the dense data stays as decoded
+    size_t numComponents = getNumComponents(accessor.type);
+    size_t components = numComponents < sizeof(T) / sizeof(float) ? numComponents : sizeof(T) / sizeof(float);
+    for (size_t i = 0; i < indices.size(); ++i) {
+        if (indices[i] >= data.size()) {
+            std::cerr << "Error: Sparse index " << indices[i] << " out of range for accessor with count " << data.size() << std::endl;
+            continue;
+        }
+        float* target = reinterpret_cast<float*>(&data[indices[i]]);
+        for (size_t c = 0; c < components; ++c) {
+            target[c] = values[i * numComponents + c];
+        }
+    }
+}
+
+template <typename T>
+bool GLTFBuffer::loadSparseWithoutBase(const GLTFAccessor::Accessor& accessor, std::vector<T>& data) const {
+    if (!accessor.sparse) return false;
+
+    // Without a bufferView the base data is defined to be all zeros
+    data.resize(accessor.count);
+    std::memset(data.data(), 0, data.size() * sizeof(T));
+    applySparse(accessor, data);
+    return true;
+}
+
+GLTFBuffer::SparseVec3 GLTFBuffer::getSparseVec3(const GLTFAccessor::Accessor& accessor) const {
+    SparseVec3 result;
+    result.count = accessor.count;
+
+    if (accessor.sparse && accessor.bufferView < 0) {
+        std::vector<float> values;
+        if (!readSparseElements(accessor, result.indices, values)) {
+            result.indices.clear();
+            return result;
+        }
+
+        size_t numComponents = getNumComponents(accessor.type);
+        result.values.resize(result.indices.size(), glm::vec3(0.0f));
+        size_t components = numComponents < 3 ? numComponents : 3;
+        for (size_t i = 0; i < result.indices.size(); ++i) {
+            for (size_t c = 0; c < components; ++c) {
+                result.values[i][c] = values[i * numComponents + c];
+            }
+        }
+        return result;
+    }
+
+    // Dense base data: decode once and keep only the elements that actually move something
+    std::vector<glm::vec3> dense = getPositions(accessor);
+    for (size_t i = 0; i < dense.size(); ++i) {
+        if (dense[i] != glm::vec3(0.0f)) {
+            result.indices.push_back(static_cast<unsigned int>(i));
+            result.values.push_back(dense[i]);
+        }
+    }
+    return result;
+}
@@ -34,6 +34,14 @@ public:
         yyjson_val* extras;
     };
 
+    // Non-zero elements of a VEC3 accessor. For sparse accessors without a base bufferView
+    // this is exactly the sparse substitution list, so it never has to be made dense.
+    struct SparseVec3 {
+        size_t count = 0; // element count of the full accessor
+        std::vector<unsigned int> indices;
+        std::vector<glm::vec3> values;
+    };
+
     void parseBuffers(yyjson_val* buffersArray, const std::string& basePath);
     void parseBufferViews(yyjson_val* bufferViewsArray);
     std::vector<Buffer>& getBuffers();
@@ -50,6 +58,7 @@ public:
     std::vector<float> getAccessorDataFloat(const GLTFAccessor::Accessor& accessor) const;
     std::vector<glm::vec3> getAccessorDataVec3(const GLTFAccessor::Accessor& accessor) const;
     std::vector<glm::quat> getAccessorDataQuat(const GLTFAccessor::Accessor& accessor) const;
+    SparseVec3 getSparseVec3(const GLTFAccessor::Accessor& accessor) const;
     void loadEmbeddedBufferData(const std::vector<unsigned char>& binChunkData);
 
 private:
@@ -59,6 +68,12 @@ private:
     void printBufferInfo(const Buffer& buffer, size_t index) const;
     void printBufferViewInfo(const BufferView& bufferView, size_t index) const;
     size_t getNumComponents(const std::string& accessorType) const;
+    size_t getComponentSize(int componentType) const;
+    float readComponent(const unsigned char* data, int componentType, bool normalized) const;
+    unsigned int readIndex(const unsigned char* data, int componentType) const;
+    bool readSparseElements(const GLTFAccessor::Accessor& accessor, std::vector<unsigned int>& indices, std::vector<float>& values) const;
+    template <typename T> void applySparse(const GLTFAccessor::Accessor& accessor, std::vector<T>& data) const;
+    template <typename T> bool loadSparseWithoutBase(const GLTFAccessor::Accessor& accessor, std::vector<T>& data) const;
     bool showDebug = false;
 };
 
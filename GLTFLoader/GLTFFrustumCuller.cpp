@@ -0,0 +1,136 @@
+#include "GLTFFrustumCuller.h"
+#include "GLTFSimd.h"
+
+GLTFFrustumCuller::Frustum GLTFFrustumCuller::extractFrustum(const glm::mat4& viewProjection) {
+    glm::vec4 row[4];
+    for (int i = 0; i < 4; ++i) {
+        row[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    }
+
+    Frustum frustum;
+    frustum.planes[0] = row[3] + row[0]; // left
+    frustum.planes[1] = row[3] - row[0]; // right
+    frustum.planes[2] = row[3] + row[1]; // bottom
+    frustum.planes[3] = row[3] - row[1]; // top
+    frustum.planes[4] = row[3] + row[2]; // near
+    frustum.planes[5] = row[3] - row[2]; // far
+    for (auto& plane : frustum.planes) {
+        float length = glm::length(glm::vec3(plane));
+        if (length > 0.0f) plane /= length;
+    }
+    return frustum;
+}
+
+void GLTFFrustumCuller::resize(size_t boxCount) {
+    count = boxCount;
+    size_t padded = (boxCount + 7) & ~static_cast<size_t>(7);
+
+    // Padding lanes hold empty boxes, which fail every plane test
+    minX.assign(padded, FLT_MAX); minY.assign(padded, FLT_MAX); minZ.assign(padded, FLT_MAX);
+    maxX.assign(padded, -FLT_MAX); maxY.assign(padded, -FLT_MAX); maxZ.assign(padded, -FLT_MAX);
+}
+
+void GLTFFrustumCuller::setBox(size_t index, const AABB& box) {
+    minX[index] = box.min.x; minY[index] = box.min.y; minZ[index] = box.min.z;
+    maxX[index] = box.max.x; maxY[index] = box.max.y; maxZ[index] = box.max.z;
+}
+
+size_t GLTFFrustumCuller::size() const {
+    return count;
+}
+
+void GLTFFrustumCuller::cull(const Frustum& frustum, std::vector<unsigned int>& visible) const {
+    visible.clear();
+    switch (GLTFSimd::getLevel()) {
+    case GLTFSimd::Level::AVX2: cullAVX2(frustum, visible); break;
+    case GLTFSimd::Level::SSE: cullSSE(frustum, visible); break;
+    default: cullScalar(frustum, visible); break;
+    }
+}
+
+// All kernels use the positive vertex test: the box corner furthest along the plane normal is behind the
+// plane only if the whole box is. The normal's signs are the same for every box, so picking that corner is
+// just a choice between the min and max arrays per plane.
+
+void GLTFFrustumCuller::cullScalar(const Frustum& frustum, std::vector<unsigned int>& visible) const {
+    for (size_t i = 0; i < count; ++i) {
+        bool inside = true;
+        for (const auto& plane : frustum.planes) {
+            float x = plane.x >= 0.0f ? maxX[i] : minX[i];
+            float y = plane.y >= 0.0f ? maxY[i] : minY[i];
+            float z = plane.z >= 0.0f ? maxZ[i] : minZ[i];
+            if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f) {
+                inside = false;
+                break;
+            }
+        }
+        if (inside) visible.push_back(static_cast<unsigned int>(i));
+    }
+}
+
+void GLTFFrustumCuller::cullSSE(const Frustum& frustum, std::vector<unsigned int>& visible) const {
+#if defined(GLTF_SIMD_X86)
+    const float* xs[6]; const float* ys[6]; const float* zs[6];
+    for (int p = 0; p < 6; ++p) {
+        xs[p] = frustum.planes[p].x >= 0.0f ? maxX.data() : minX.data();
+        ys[p] = frustum.planes[p].y >= 0.0f ? maxY.data() : minY.data();
+        zs[p] = frustum.planes[p].z >= 0.0f ? maxZ.data() : minZ.data();
+    }
+
+    const __m128 zero = _mm_setzero_ps();
+    for (size_t i = 0; i < count; i += 4) {
+        __m128 outside = _mm_setzero_ps();
+        for (int p = 0; p < 6; ++p) {
+            const glm::vec4& plane = frustum.planes[p];
+            __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), _mm_loadu_ps(xs[p] + i)),
+                           _mm_mul_ps(_mm_set1_ps(plane.y), _mm_loadu_ps(ys[p] + i))),
+                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), _mm_loadu_ps(zs[p] + i)), _mm_set1_ps(plane.w)));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, zero));
+        }
+
+        int mask = ~_mm_movemask_ps(outside) & 0xF;
+        while (mask) {
+            int lane = 0;
+            while (!(mask & (1 << lane))) lane++;
+            mask &= mask - 1;
+            if (i + lane < count) visible.push_back(static_cast<unsigned int>(i + lane));
+        }
+    }
+#else
+    cullScalar(frustum, visible);
+#endif
+}
+
+GLTF_TARGET_AVX2 void GLTFFrustumCuller::cullAVX2(const Frustum& frustum, std::vector<unsigned int>& visible) const {
+#if defined(GLTF_SIMD_X86)
+    const float* xs[6]; const float* ys[6]; const float* zs[6];
+    for (int p = 0; p < 6; ++p) {
+        xs[p] = frustum.planes[p].x >= 0.0f ? maxX.data() : minX.data();
+        ys[p] = frustum.planes[p].y >= 0.0f ? maxY.data() : minY.data();
+        zs[p] = frustum.planes[p].z >= 0.0f ? maxZ.data() : minZ.data();
+    }
+
+    const __m256 zero = _mm256_setzero_ps();
+    for (size_t i = 0; i < count; i += 8) {
+        __m256 outside = _mm256_setzero_ps();
+        for (int p = 0; p < 6; ++p) {
+            const glm::vec4& plane = frustum.planes[p];
+            __m256 distance = _mm256_fmadd_ps(_mm256_set1_ps(plane.x), _mm256_loadu_ps(xs[p] + i), _mm256_set1_ps(plane.w));
+            distance = _mm256_fmadd_ps(_mm256_set1_ps(plane.y), _mm256_loadu_ps(ys[p] + i), distance);
+            distance = _mm256_fmadd_ps(_mm256_set1_ps(plane.z), _mm256_loadu_ps(zs[p] + i), distance);
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, zero, _CMP_LT_OQ));
+        }
+
+        int mask = ~_mm256_movemask_ps(outside) & 0xFF;
+        while (mask) {
+            int lane = 0;
+            while (!(mask & (1 << lane))) lane++;
+            mask &= mask - 1;
+            if (i + lane < count) visible.push_back(static_cast<unsigned int>(i + lane));
+        }
+    }
+#else
+    cullScalar(frustum, visible);
+#endif
+}
@@ -0,0 +1,40 @@
+#ifndef GLTF_FRUSTUM_CULLER_H
+#define GLTF_FRUSTUM_CULLER_H
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "GLTFBounds.h"
+
+// Tests many world-space boxes against the view frustum at once. Boxes are stored as six separate float
+// arrays (structure of arrays) so SSE and AVX2 kernels can test 4 or 8 boxes per iteration.
+class GLTFFrustumCuller {
+public:
+    struct Frustum {
+        glm::vec4 planes[6]; // xyz = inward normal, w = distance; normalized
+    };
+
+    struct Stats {
+        size_t submitted = 0;
+        size_t culled = 0;
+    };
+
+    // Gribb & Hartmann plane extraction. Pass projection * view for world space, or a full MVP for model space.
+    static Frustum extractFrustum(const glm::mat4& viewProjection);
+
+    void resize(size_t boxCount);
+    void setBox(size_t index, const AABB& box);
+    size_t size() const;
+
+    // Writes the indices of the boxes that intersect the frustum, in increasing order. Empty boxes are culled.
+    void cull(const Frustum& frustum, std::vector<unsigned int>& visible) const;
+
+private:
+    std::vector<float> minX, minY, minZ, maxX, maxY, maxZ; // padded to a multiple of 8 with empty boxes
+    size_t count = 0;
+
+    void cullScalar(const Frustum& frustum, std::vector<unsigned int>& visible) const;
+    void cullSSE(const Frustum& frustum, std::vector<unsigned int>& visible) const;
+    void cullAVX2(const Frustum& frustum, std::vector<unsigned int>& visible) const;
+};
+
+#endif // GLTF_FRUSTUM_CULLER_H
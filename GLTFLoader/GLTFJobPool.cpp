@@ -0,0 +1,101 @@
+#include "GLTFJobPool.h"
+#include <algorithm>
+
+GLTFJobPool::GLTFJobPool(unsigned int threadCount) {
+    if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned int i = 0; i < threadCount; ++i) queues.push_back(std::make_unique<Queue>());
+    for (unsigned int i = 1; i < threadCount; ++i) workers.emplace_back(&GLTFJobPool::workerLoop, this, i);
+}
+
+GLTFJobPool::~GLTFJobPool() {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopping = true;
+    }
+    jobReady.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+unsigned int GLTFJobPool::getThreadCount() const {
+    return static_cast<unsigned int>(queues.size());
+}
+
+void GLTFJobPool::parallelFor(size_t count, size_t chunkSize, const std::function<void(size_t, size_t)>& function) {
+    if (count == 0) return;
+    chunkSize = std::max<size_t>(1, chunkSize);
+    const size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+    if (workers.empty() || chunkCount == 1) {
+        function(0, count);
+        return;
+    }
+
+    std::lock_guard<std::mutex> call(callMutex);
+    // Published before any chunk is queued; a thread reads it only after taking a chunk
+    body = &function;
+    remainingChunks.store(chunkCount);
+    const size_t threadCount = queues.size();
+    for (size_t thread = 0; thread < threadCount; ++thread) {
+        size_t first = chunkCount * thread / threadCount;
+        size_t last = chunkCount * (thread + 1) / threadCount;
+        std::lock_guard<std::mutex> lock(queues[thread]->mutex);
+        for (size_t chunk = first; chunk < last; ++chunk) {
+            queues[thread]->chunks.emplace_back(chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize));
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        ++generation;
+    }
+    jobReady.notify_all();
+
+    runChunks(0);
+    std::unique_lock<std::mutex> lock(jobMutex);
+    jobDone.wait(lock, [this] { return remainingChunks.load() == 0; });
+}
+
+void GLTFJobPool::workerLoop(unsigned int index) {
+    unsigned long long seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobReady.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+        runChunks(index);
+    }
+}
+
+void GLTFJobPool::runChunks(unsigned int index) {
+    std::pair<size_t, size_t> chunk;
+    while (takeChunk(index, chunk)) {
+        (*body)(chunk.first, chunk.second);
+        if (remainingChunks.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            jobDone.notify_all();
+        }
+    }
+}
+
+bool GLTFJobPool::takeChunk(unsigned int index, std::pair<size_t, size_t>& chunk) {
+    // Own work in order from the front; steal from the back of the others, away from where their owner is
+    {
+        Queue& own = *queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.chunks.empty()) {
+            chunk = own.chunks.front();
+            own.chunks.pop_front();
+            return true;
+        }
+    }
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+        Queue& victim = *queues[(index + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.chunks.empty()) {
+            chunk = victim.chunks.back();
+            victim.chunks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,54 @@
+#ifndef GLTF_JOB_POOL_H
+#define GLTF_JOB_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Persistent worker threads for per-frame data-parallel work, where starting threads through std::async
+// every frame would cost more than the work. Each thread owns a queue of chunks; one that runs dry steals
+// from the others, so chunks of uneven cost still finish together.
+class GLTFJobPool {
+public:
+    // threadCount includes the calling thread; 0 uses every hardware thread
+    explicit GLTFJobPool(unsigned int threadCount = 0);
+    ~GLTFJobPool();
+    GLTFJobPool(const GLTFJobPool&) = delete;
+    GLTFJobPool& operator=(const GLTFJobPool&) = delete;
+
+    // Calls body(begin, end) over [0, count) in chunks of up to chunkSize and returns once all are done. The
+    // calling thread works too. Each thread starts on a contiguous run of chunks, so neighbouring items stay
+    // on one core unless stolen. Calls from several threads run one after another.
+    void parallelFor(size_t count, size_t chunkSize, const std::function<void(size_t, size_t)>& body);
+    unsigned int getThreadCount() const;
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::pair<size_t, size_t>> chunks;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<Queue>> queues; // by thread, 0 is the caller of parallelFor
+
+    std::mutex callMutex;
+    std::mutex jobMutex;
+    std::condition_variable jobReady;
+    std::condition_variable jobDone;
+    const std::function<void(size_t, size_t)>* body = nullptr;
+    unsigned long long generation = 0;
+    bool stopping = false;
+    std::atomic<size_t> remainingChunks{ 0 };
+
+    void workerLoop(unsigned int index);
+    void runChunks(unsigned int index);
+    bool takeChunk(unsigned int index, std::pair<size_t, size_t>& chunk);
+};
+
+#endif // GLTF_JOB_POOL_H
@@ -1,5 +1,6 @@
 #include "GLTFMesh.h"
 #include <iostream>
+#include <unordered_map>
 
 void GLTFMesh::parseMeshes(yyjson_val* meshesArray) {
     size_t idx, max;
@@ -20,6 +21,15 @@ void GLTFMesh::parseMeshes(yyjson_val* meshesArray) {
             }
         }
 
+        yyjson_val* weights_val = yyjson_obj_get(mesh_val, "weights");
+        if (weights_val && yyjson_is_arr(weights_val)) {
+            size_t weight_idx, weight_max;
+            yyjson_val* weight_val;
+            yyjson_arr_foreach(weights_val, weight_idx, weight_max, weight_val) {
+                mesh.weights.push_back(static_cast<float>(yyjson_get_num(weight_val)));
+            }
+        }
+
         mesh.extensions = yyjson_obj_get(mesh_val, "extensions");
         mesh.extras = yyjson_obj_get(mesh_val, "extras");
 
@@ -99,18 +109,13 @@ void GLTFMesh::parsePrimitive(Primitive& primitive, yyjson_val* primitive_val) {
 
 void GLTFMesh::parseMorphTarget(MorphTarget& morphTarget, yyjson_val* morph_val) {
     yyjson_val* pos_acc = yyjson_obj_get(morph_val, "POSITION");
-    if (pos_acc) {
-        // Load positions
-        // This is a placeholder, replace with actual data loading
-        morphTarget.positions.push_back(glm::vec3(0.0f)); // Replace with actual loading logic
-    }
+    morphTarget.positionAccessor = pos_acc ? yyjson_get_int(pos_acc) : -1;
 
     yyjson_val* norm_acc = yyjson_obj_get(morph_val, "NORMAL");
-    if (norm_acc) {
-        // Load normals
-        // This is a placeholder, replace with actual data loading
-        morphTarget.normals.push_back(glm::vec3(0.0f)); // Replace with actual loading logic
-    }
+    morphTarget.normalAccessor = norm_acc ? yyjson_get_int(norm_acc) : -1;
+
+    yyjson_val* tan_acc = yyjson_obj_get(morph_val, "TANGENT");
+    morphTarget.tangentAccessor = tan_acc ? yyjson_get_int(tan_acc) : -1;
 }
 
 bool GLTFMesh::hasMorphTargets(int meshIndex, int primitiveIndex) const {
@@ -124,36 +129,6 @@ bool GLTFMesh::hasMorphTargets(int meshIndex, int primitiveIndex) const {
     return !mesh.primitives[primitiveIndex].morphTargets.empty();
 }
 
-const std::vector<glm::vec3>& GLTFMesh::getMorphTargetPositions(int meshIndex, int primitiveIndex, int targetIndex) const {
-    if (meshIndex < 0 || meshIndex >= meshes.size()) {
-        throw std::out_of_range("Invalid mesh index");
-    }
-    const Mesh& mesh = meshes[meshIndex];
-    if (primitiveIndex < 0 || primitiveIndex >= mesh.primitives.size()) {
-        throw std::out_of_range("Invalid primitive index");
-    }
-    const Primitive& primitive = mesh.primitives[primitiveIndex];
-    if (targetIndex < 0 || targetIndex >= primitive.morphTargets.size()) {
-        throw std::out_of_range("Invalid morph target index");
-    }
-    return primitive.morphTargets[targetIndex].positions;
-}
-
-const std::vector<glm::vec3>& GLTFMesh::getMorphTargetNormals(int meshIndex, int primitiveIndex, int targetIndex) const {
-    if (meshIndex < 0 || meshIndex >= meshes.size()) {
-        throw std::out_of_range("Invalid mesh index");
-    }
-    const Mesh& mesh = meshes[meshIndex];
-    if (primitiveIndex < 0 || primitiveIndex >= mesh.primitives.size()) {
-        throw std::out_of_range("Invalid primitive index");
-    }
-    const Primitive& primitive = mesh.primitives[primitiveIndex];
-    if (targetIndex < 0 || targetIndex >= primitive.morphTargets.size()) {
-        throw std::out_of_range("Invalid morph target index");
-    }
-    return primitive.morphTargets[targetIndex].normals;
-}
-
 const std::vector<GLTFMesh::MorphTarget>& GLTFMesh::getMorphTargets(int meshIndex, int primitiveIndex) const {
     if (meshIndex < 0 || meshIndex >= meshes.size()) {
         throw std::out_of_range("Invalid mesh index");
@@ -175,6 +150,68 @@ const std::vector<GLTFMesh::Primitive> GLTFMesh::getPrimitives() const {
     return allPrimitives;
 }
 
+void GLTFMesh::computeBounds(PrimitiveGeometry& geometry, const std::vector<float>& largestMorphWeights) {
+    geometry.bounds = AABB();
+    geometry.jointBounds.clear();
+
+    std::unordered_map<int, size_t> jointSlots;
+    for (unsigned int index : geometry.indices) {
+        if (index >= geometry.vertices.size()) continue;
+        const Vertex& vertex = geometry.vertices[index];
+        geometry.bounds.expand(vertex.position);
+
+        for (int k = 0; k < 4; ++k) {
+            if (vertex.weights[k] <= 0.0f) continue;
+            auto slot = jointSlots.find(vertex.joints[k]);
+            if (slot == jointSlots.end()) {
+                slot = jointSlots.emplace(vertex.joints[k], geometry.jointBounds.size()).first;
+                geometry.jointBounds.push_back({ vertex.joints[k], AABB() });
+            }
+            geometry.jointBounds[slot->second].bounds.expand(vertex.position);
+        }
+    }
+
+    // Morphing moves vertices before skinning, so every box that holds them grows by the same margin
+    float displacement = GLTFMorphTargets::getMaxDisplacement(geometry.morphTargets, largestMorphWeights);
+    if (displacement > 0.0f && !geometry.bounds.isEmpty()) {
+        glm::vec3 margin(displacement);
+        geometry.bounds.min -= margin;
+        geometry.bounds.max += margin;
+        for (auto& joint : geometry.jointBounds) {
+            joint.bounds.min -= margin;
+            joint.bounds.max += margin;
+        }
+    }
+}
+
+AABB GLTFMesh::getSkinnedBounds(const AABB& bindBounds, const std::vector<JointBounds>& jointBounds, std::span<const glm::mat4> jointMatrices) {
+    if (jointBounds.empty() || jointMatrices.empty()) return bindBounds;
+
+    AABB bounds;
+    for (const auto& joint : jointBounds) {
+        if (joint.joint < 0 || joint.joint >= static_cast<int>(jointMatrices.size())) continue;
+        bounds.merge(joint.bounds.transformed(jointMatrices[joint.joint]));
+    }
+    return bounds.isEmpty() ? bindBounds : bounds;
+}
+
+void GLTFMesh::skinPositions(const std::vector<Vertex>& vertices, const std::vector<glm::mat4>& jointMatrices, std::vector<glm::vec3>& positions) {
+    positions.resize(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        const Vertex& vertex = vertices[i];
+        glm::vec4 skinned(0.0f);
+        float totalWeight = 0.0f;
+        for (int k = 0; k < 4; ++k) {
+            int joint = vertex.joints[k];
+            if (vertex.weights[k] <= 0.0f || joint < 0 || joint >= static_cast<int>(jointMatrices.size())) continue;
+            skinned += jointMatrices[joint] * glm::vec4(vertex.position, 1.0f) * vertex.weights[k];
+            totalWeight += vertex.weights[k];
+        }
+        // Unweighted vertices stay in the bind pose rather than collapsing to the origin
+        positions[i] = totalWeight > 0.0f ? glm::vec3(skinned) : vertex.position;
+    }
+}
+
 void GLTFMesh::printMeshInfo(const Mesh& mesh, size_t index) const {
     std::cout << "Mesh Info [" << index << "]:" << std::endl;
     std::cout << "Name: " << (mesh.name.empty() ? "None" : mesh.name) << std::endl;
@@ -192,8 +229,9 @@ void GLTFMesh::printMeshInfo(const Mesh& mesh, size_t index) const {
         for (size_t j = 0; j < primitive.morphTargets.size(); ++j) {
             const auto& morphTarget = primitive.morphTargets[j];
             std::cout << "      Morph Target [" << j << "]:" << std::endl;
-            std::cout << "        Positions: " << morphTarget.positions.size() << std::endl;
-            std::cout << "        Normals: " << morphTarget.normals.size() << std::endl;
+            std::cout << "        Position Accessor: " << morphTarget.positionAccessor << std::endl;
+            std::cout << "        Normal Accessor: " << morphTarget.normalAccessor << std::endl;
+            std::cout << "        Tangent Accessor: " << morphTarget.tangentAccessor << std::endl;
         }
         std::cout << "    Extensions: " << (primitive.extensions ? "Yes" : "No") << std::endl;
         std::cout << "    Extras: " << (primitive.extras ? "Yes" : "No") << std::endl;
@@ -2,18 +2,23 @@
 #define GLTFMESH_H
 #define GLM_ENABLE_EXPERIMENTAL
 
+#include <span>
 #include <string>
 #include <vector>
 #include <glm/glm.hpp>
 #include <glm/gtx/string_cast.hpp>
 #include "yyjson.h"
 #include "Vertex.h"
+#include "GLTFBounds.h"
+#include "GLTFMorphTargets.h"
 
 class GLTFMesh {
 public:
+    // Accessors of one morph target's attribute deltas; decoded with the rest of the vertex data
     struct MorphTarget {
-        std::vector<glm::vec3> positions;
-        std::vector<glm::vec3> normals;
+        int positionAccessor = -1;
+        int normalAccessor = -1;
+        int tangentAccessor = -1;
     };
 
     struct Primitive {
@@ -30,9 +35,50 @@ public:
         yyjson_val* extras = nullptr;
     };
 
+    // Simplified index list over the same vertices as the full-detail primitive, so it skins with the
+    // same joint matrices. error is the geometric deviation from the original surface in model units.
+    struct Lod {
+        std::vector<unsigned int> indices;
+        float error = 0.0f;
+    };
+
+    // Small cluster of neighbouring triangles occupying a contiguous range of the full-detail indices.
+    // Bounds are in bind-pose model space; skinned meshlets list the joints that move them.
+    struct Meshlet {
+        unsigned int triangleOffset = 0;
+        unsigned int triangleCount = 0;
+        unsigned int vertexCount = 0;
+        glm::vec3 center = glm::vec3(0.0f);
+        float radius = 0.0f;
+        glm::vec3 coneAxis = glm::vec3(0.0f);
+        float coneCutoff = 1.0f;       // sine of the normal cone spread; 1 disables backface rejection
+        unsigned int jointOffset = 0;  // into PrimitiveGeometry::meshletJoints
+        unsigned int jointCount = 0;
+    };
+
+    // Bind-pose box of the vertices a joint influences, used to bound the skinned pose
+    struct JointBounds {
+        int joint;
+        AABB bounds;
+    };
+
+    // Decoded vertex and index data for one primitive, after the import stages have run
+    struct PrimitiveGeometry {
+        int materialIndex = -1;
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+        std::vector<Lod> lods; // increasingly coarse, not including the full-detail indices
+        std::vector<Meshlet> meshlets;
+        std::vector<int> meshletJoints;
+        AABB bounds;                          // bind pose, model space
+        std::vector<JointBounds> jointBounds; // empty for unskinned primitives
+        std::vector<GLTFMorphTargets::Target> morphTargets; // indexed like the final vertices
+    };
+
     struct Mesh {
         std::string name;
         std::vector<Primitive> primitives;
+        std::vector<float> weights; // default morph target weights, one per target
         yyjson_val* extensions = nullptr;
         yyjson_val* extras = nullptr;
     };
@@ -51,12 +97,19 @@ public:
 
     // New helper functions
     bool hasMorphTargets(int meshIndex, int primitiveIndex) const;
-    const std::vector<glm::vec3>& getMorphTargetPositions(int meshIndex, int primitiveIndex, int targetIndex) const;
-    const std::vector<glm::vec3>& getMorphTargetNormals(int meshIndex, int primitiveIndex, int targetIndex) const;
     const std::vector<MorphTarget>& getMorphTargets(int meshIndex, int primitiveIndex) const;
 
     const std::vector<GLTFMesh::Primitive> getPrimitives() const;
 
+    // Fills geometry.bounds and geometry.jointBounds from the final vertices, grown by how far the morph
+    // targets can move them with each target's weight within +-largestMorphWeights[t]
+    static void computeBounds(PrimitiveGeometry& geometry, const std::vector<float>& largestMorphWeights);
+    // Conservative box of the skinned pose: every skinned vertex is a weighted average of its joint-transformed
+    // copies, so it stays inside the union of the per-joint boxes. Unskinned primitives return their bounds.
+    static AABB getSkinnedBounds(const AABB& bindBounds, const std::vector<JointBounds>& jointBounds, std::span<const glm::mat4> jointMatrices);
+    // CPU version of the vertex shader's linear blend skinning, positions only
+    static void skinPositions(const std::vector<Vertex>& vertices, const std::vector<glm::mat4>& jointMatrices, std::vector<glm::vec3>& positions);
+
 private:
     std::vector<Mesh> meshes;
     std::vector<Skin> skins;
@@ -0,0 +1,543 @@
+#include "GLTFMeshOptimizer.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_precision.hpp>
+
+namespace {
+    uint64_t hashCombine(uint64_t seed, uint64_t value) {
+        return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+    }
+
+    uint32_t floatBits(float value) {
+        if (value == 0.0f) value = 0.0f; // -0 and +0 weld together
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    uint64_t hashAttributes(const Vertex& v) {
+        uint64_t hash = 0;
+        for (int i = 0; i < 3; ++i) hash = hashCombine(hash, floatBits(v.position[i]));
+        for (int i = 0; i < 3; ++i) hash = hashCombine(hash, floatBits(v.normal[i]));
+        for (int i = 0; i < 2; ++i) hash = hashCombine(hash, floatBits(v.texCoord[i]));
+        for (int i = 0; i < 4; ++i) hash = hashCombine(hash, floatBits(v.weights[i]));
+        // Like verticesMatch, ignore the joints of slots without weight
+        for (int i = 0; i < 4; ++i) {
+            if (v.weights[i] > 0.0f) hash = hashCombine(hash, static_cast<uint32_t>(v.joints[i]));
+        }
+        return hash;
+    }
+
+    bool nearlyEqual(float a, float b, float epsilon) {
+        return a == b || std::fabs(a - b) <= epsilon;
+    }
+
+    bool verticesMatch(const Vertex& a, const Vertex& b, float epsilon) {
+        for (int i = 0; i < 3; ++i) {
+            if (!nearlyEqual(a.position[i], b.position[i], epsilon)) return false;
+            if (!nearlyEqual(a.normal[i], b.normal[i], epsilon)) return false;
+        }
+        for (int i = 0; i < 2; ++i) {
+            if (!nearlyEqual(a.texCoord[i], b.texCoord[i], epsilon)) return false;
+        }
+        // Joint slots only matter where they carry weight
+        for (int i = 0; i < 4; ++i) {
+            if (!nearlyEqual(a.weights[i], b.weights[i], epsilon)) return false;
+            if (a.weights[i] > epsilon && a.joints[i] != b.joints[i]) return false;
+        }
+        return true;
+    }
+}
+
+std::vector<unsigned int> GLTFMeshOptimizer::weldVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, float epsilon) {
+    std::vector<unsigned int> remap(vertices.size());
+    std::vector<Vertex> welded;
+    welded.reserve(vertices.size());
+
+    // Exact welding hashes every attribute; with an epsilon vertices are bucketed by position cell and the
+    // 27 surrounding cells are searched, since near-equal values can straddle a cell boundary
+    std::unordered_map<uint64_t, std::vector<unsigned int>> buckets;
+    buckets.reserve(vertices.size());
+    // Cells are 64-bit and clamped, so large coordinates or a tiny epsilon cannot overflow them
+    auto cellOf = [&](const glm::vec3& p) {
+        const double limit = 4611686018427387904.0; // 2^62, leaves room for the +-1 neighbours
+        glm::i64vec3 cell;
+        for (int i = 0; i < 3; ++i) {
+            double value = std::floor(static_cast<double>(p[i]) / static_cast<double>(epsilon));
+            cell[i] = static_cast<int64_t>(std::max(-limit, std::min(limit, value)));
+        }
+        return cell;
+    };
+    auto cellKey = [](const glm::i64vec3& cell) {
+        uint64_t key = 0;
+        for (int i = 0; i < 3; ++i) key = hashCombine(key, static_cast<uint64_t>(cell[i]));
+        return key;
+    };
+
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        const Vertex& vertex = vertices[i];
+        unsigned int match = ~0u;
+
+        if (epsilon > 0.0f) {
+            glm::i64vec3 cell = cellOf(vertex.position);
+            for (int dz = -1; dz <= 1 && match == ~0u; ++dz) {
+                for (int dy = -1; dy <= 1 && match == ~0u; ++dy) {
+                    for (int dx = -1; dx <= 1 && match == ~0u; ++dx) {
+                        auto it = buckets.find(cellKey(cell + glm::i64vec3(dx, dy, dz)));
+                        if (it == buckets.end()) continue;
+                        for (unsigned int candidate : it->second) {
+                            if (verticesMatch(welded[candidate], vertex, epsilon)) {
+                                match = candidate;
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        else {
+            auto it = buckets.find(hashAttributes(vertex));
+            if (it != buckets.end()) {
+                for (unsigned int candidate : it->second) {
+                    if (verticesMatch(welded[candidate], vertex, 0.0f)) {
+                        match = candidate;
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (match == ~0u) {
+            match = static_cast<unsigned int>(welded.size());
+            welded.push_back(vertex);
+            uint64_t key = epsilon > 0.0f ? cellKey(cellOf(vertex.position)) : hashAttributes(vertex);
+            buckets[key].push_back(match);
+        }
+        remap[i] = match;
+    }
+
+    for (unsigned int& index : indices) {
+        if (index < remap.size()) index = remap[index];
+    }
+    vertices.swap(welded);
+    return remap;
+}
+
+size_t GLTFMeshOptimizer::removeDegenerateTriangles(const std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+    size_t write = 0;
+    size_t removed = 0;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        unsigned int a = indices[i], b = indices[i + 1], c = indices[i + 2];
+        bool degenerate = a == b || b == c || a == c;
+        if (!degenerate && a < vertices.size() && b < vertices.size() && c < vertices.size()) {
+            glm::vec3 p0 = vertices[a].position;
+            glm::vec3 cross = glm::cross(vertices[b].position - p0, vertices[c].position - p0);
+            degenerate = cross == glm::vec3(0.0f);
+        }
+        if (degenerate) {
+            removed++;
+            continue;
+        }
+        indices[write++] = a;
+        indices[write++] = b;
+        indices[write++] = c;
+    }
+    indices.resize(write);
+    return removed;
+}
+
+std::vector<unsigned int> GLTFMeshOptimizer::removeUnusedVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+    std::vector<unsigned int> remap(vertices.size(), ~0u);
+    for (unsigned int index : indices) {
+        if (index < remap.size()) remap[index] = 0;
+    }
+
+    unsigned int nextIndex = 0;
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        if (remap[i] == ~0u) continue;
+        remap[i] = nextIndex;
+        vertices[nextIndex++] = vertices[i];
+    }
+    vertices.resize(nextIndex);
+
+    for (unsigned int& index : indices) {
+        if (index < remap.size()) index = remap[index];
+    }
+    return remap;
+}
+
+GLTFMeshOptimizer::VertexCacheStats GLTFMeshOptimizer::analyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize) {
+    VertexCacheStats stats;
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || vertexCount == 0) return stats;
+
+    // A vertex is in a FIFO cache of size N if it was inserted less than N insertions ago
+    std::vector<unsigned int> insertedAt(vertexCount, 0);
+    std::vector<bool> referenced(vertexCount, false);
+    unsigned int timestamp = cacheSize + 1;
+    size_t misses = 0;
+    size_t uniqueVertices = 0;
+
+    for (size_t i = 0; i < triangleCount * 3; ++i) {
+        unsigned int v = indices[i];
+        if (v >= vertexCount) continue;
+
+        if (timestamp - insertedAt[v] > cacheSize) {
+            insertedAt[v] = timestamp++;
+            misses++;
+        }
+        if (!referenced[v]) {
+            referenced[v] = true;
+            uniqueVertices++;
+        }
+    }
+
+    stats.acmr = static_cast<float>(misses) / triangleCount;
+    stats.atvr = uniqueVertices ? static_cast<float>(misses) / uniqueVertices : 0.0f;
+    return stats;
+}
+
+void GLTFMeshOptimizer::optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || vertexCount == 0) return;
+
+    for (size_t i = 0; i < triangleCount * 3; ++i) {
+        if (indices[i] >= vertexCount) {
+            std::cerr << "optimizeVertexCache: index " << indices[i] << " out of range, skipping primitive" << std::endl;
+            return;
+        }
+    }
+
+    // Vertex -> triangle adjacency in CSR form
+    std::vector<unsigned int> liveTriangles(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i) {
+        liveTriangles[indices[i]]++;
+    }
+
+    std::vector<unsigned int> adjacencyOffsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+    }
+
+    std::vector<unsigned int> adjacency(triangleCount * 3);
+    std::vector<unsigned int> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        for (int k = 0; k < 3; ++k) {
+            unsigned int v = indices[t * 3 + k];
+            adjacency[fill[v]++] = static_cast<unsigned int>(t);
+        }
+    }
+
+    std::vector<unsigned int> cacheTime(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<unsigned int> deadEnd;
+    std::vector<unsigned int> candidates;
+    std::vector<unsigned int> output;
+    output.reserve(triangleCount * 3);
+    deadEnd.reserve(triangleCount * 3);
+    candidates.reserve(64);
+
+    unsigned int timestamp = cacheSize + 1;
+    size_t scanCursor = 0;
+
+    // Dead-end recovery: most recently used vertex with live triangles, else the next one in input order
+    auto skipDeadEnd = [&]() -> int {
+        while (!deadEnd.empty()) {
+            unsigned int v = deadEnd.back();
+            deadEnd.pop_back();
+            if (liveTriangles[v] > 0) return static_cast<int>(v);
+        }
+        while (scanCursor < vertexCount) {
+            if (liveTriangles[scanCursor] > 0) return static_cast<int>(scanCursor);
+            scanCursor++;
+        }
+        return -1;
+    };
+
+    int fanningVertex = skipDeadEnd();
+    while (fanningVertex >= 0) {
+        candidates.clear();
+
+        // Emit every remaining triangle around the fanning vertex
+        for (unsigned int a = adjacencyOffsets[fanningVertex]; a < adjacencyOffsets[fanningVertex + 1]; ++a) {
+            unsigned int t = adjacency[a];
+            if (emitted[t]) continue;
+
+            for (int k = 0; k < 3; ++k) {
+                unsigned int v = indices[t * 3 + k];
+                output.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                liveTriangles[v]--;
+                if (timestamp - cacheTime[v] > cacheSize) {
+                    cacheTime[v] = timestamp++;
+                }
+            }
+            emitted[t] = true;
+        }
+
+        // Pick the candidate that is still in cache and will stay there while its fan is emitted
+        int nextVertex = -1;
+        int bestPriority = -1;
+        for (unsigned int v : candidates) {
+            if (liveTriangles[v] == 0) continue;
+
+            int priority = 0;
+            if (timestamp - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize) {
+                priority = static_cast<int>(timestamp - cacheTime[v]);
+            }
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                nextVertex = static_cast<int>(v);
+            }
+        }
+
+        fanningVertex = nextVertex >= 0 ? nextVertex : skipDeadEnd();
+    }
+
+    indices.swap(output);
+}
+
+namespace {
+    const int overdrawViewport = 256;
+
+    // Splits a cache-ordered triangle list into clusters that can be reordered without losing much locality.
+    // clusters receives the first triangle of each cluster followed by the total triangle count.
+    void findClusterBoundaries(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize, float threshold, std::vector<size_t>& clusters) {
+        size_t triangleCount = indices.size() / 3;
+        std::vector<unsigned int> insertedAt(vertexCount, 0);
+        unsigned int timestamp = cacheSize + 1;
+
+        auto triangleMisses = [&](size_t t) {
+            unsigned int misses = 0;
+            for (int k = 0; k < 3; ++k) {
+                unsigned int v = indices[t * 3 + k];
+                if (timestamp - insertedAt[v] > cacheSize) {
+                    insertedAt[v] = timestamp++;
+                    misses++;
+                }
+            }
+            return misses;
+        };
+
+        // Hard boundaries: the cache was effectively flushed, so reordering here costs nothing
+        std::vector<size_t> hard;
+        std::vector<unsigned int> misses(triangleCount);
+        for (size_t t = 0; t < triangleCount; ++t) {
+            misses[t] = triangleMisses(t);
+            if (t == 0 || misses[t] == 3) hard.push_back(t);
+        }
+        hard.push_back(triangleCount);
+
+        // Soft boundaries: inside a hard cluster, cut whenever the prefix is already as cache friendly as
+        // the whole cluster (within threshold), resetting the simulated cache as the GPU would see it
+        for (size_t h = 0; h + 1 < hard.size(); ++h) {
+            size_t start = hard[h];
+            size_t end = hard[h + 1];
+
+            size_t clusterMisses = 0;
+            for (size_t t = start; t < end; ++t) clusterMisses += misses[t];
+            float clusterThreshold = threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - start);
+
+            timestamp += cacheSize + 1;
+            size_t softStart = start;
+            size_t softMisses = 0;
+            clusters.push_back(start);
+            for (size_t t = start; t < end; ++t) {
+                softMisses += triangleMisses(t);
+                if (t + 1 < end && static_cast<float>(softMisses) / static_cast<float>(t - softStart + 1) <= clusterThreshold) {
+                    clusters.push_back(t + 1);
+                    softStart = t + 1;
+                    softMisses = 0;
+                    timestamp += cacheSize + 1;
+                }
+            }
+        }
+        clusters.push_back(triangleCount);
+    }
+
+    float edgeFunction(const glm::vec2& a, const glm::vec2& b, const glm::vec2& p) {
+        return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+    }
+
+    void rasterizeTriangle(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2, std::vector<float>& depth, std::vector<unsigned int>& shaded) {
+        glm::vec2 a(v0), b(v1), c(v2);
+        float area = edgeFunction(a, b, c);
+        if (area <= 0.0f) return; // back-facing or degenerate in this view
+
+        int minX = std::max(0, static_cast<int>(std::floor(std::min({ a.x, b.x, c.x }))));
+        int maxX = std::min(overdrawViewport - 1, static_cast<int>(std::ceil(std::max({ a.x, b.x, c.x }))));
+        int minY = std::max(0, static_cast<int>(std::floor(std::min({ a.y, b.y, c.y }))));
+        int maxY = std::min(overdrawViewport - 1, static_cast<int>(std::ceil(std::max({ a.y, b.y, c.y }))));
+
+        float invArea = 1.0f / area;
+        for (int y = minY; y <= maxY; ++y) {
+            for (int x = minX; x <= maxX; ++x) {
+                glm::vec2 p(x + 0.5f, y + 0.5f);
+                float w0 = edgeFunction(b, c, p);
+                float w1 = edgeFunction(c, a, p);
+                float w2 = edgeFunction(a, b, p);
+                if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) continue;
+
+                float z = (w0 * v0.z + w1 * v1.z + w2 * v2.z) * invArea;
+                size_t pixel = static_cast<size_t>(y) * overdrawViewport + x;
+                if (z < depth[pixel]) { // early depth test: only passing fragments get shaded
+                    depth[pixel] = z;
+                    shaded[pixel]++;
+                }
+            }
+        }
+    }
+}
+
+GLTFMeshOptimizer::OverdrawStats GLTFMeshOptimizer::analyzeOverdraw(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices) {
+    OverdrawStats stats;
+    if (vertices.empty() || indices.size() < 3) return stats;
+
+    // Fit the primitive into the viewport, keeping its aspect ratio
+    glm::vec3 minBounds(vertices[0].position), maxBounds(vertices[0].position);
+    for (const auto& vertex : vertices) {
+        minBounds = glm::min(minBounds, vertex.position);
+        maxBounds = glm::max(maxBounds, vertex.position);
+    }
+    glm::vec3 extent = maxBounds - minBounds;
+    float maxExtent = std::max({ extent.x, extent.y, extent.z });
+    float scale = maxExtent > 0.0f ? (overdrawViewport - 1) / maxExtent : 0.0f;
+
+    std::vector<glm::vec3> normalized(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        normalized[i] = (vertices[i].position - minBounds) * scale;
+    }
+
+    std::vector<float> depth(overdrawViewport * overdrawViewport);
+    std::vector<unsigned int> shaded(overdrawViewport * overdrawViewport);
+
+    // Look down each axis from both sides; the permutation keeps the projected winding consistent
+    for (int axis = 0; axis < 3; ++axis) {
+        for (int side = 0; side < 2; ++side) {
+            std::fill(depth.begin(), depth.end(), 1e30f);
+            std::fill(shaded.begin(), shaded.end(), 0u);
+
+            int u = (axis + 1) % 3;
+            int v = (axis + 2) % 3;
+            auto project = [&](const glm::vec3& p) {
+                float depthValue = side == 0 ? p[axis] : (overdrawViewport - 1) - p[axis];
+                float x = side == 0 ? p[u] : (overdrawViewport - 1) - p[u];
+                return glm::vec3(x, p[v], depthValue);
+            };
+
+            for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+                if (indices[t] >= vertices.size() || indices[t + 1] >= vertices.size() || indices[t + 2] >= vertices.size()) continue;
+                // Looking down +axis flips handedness, so swap two vertices to keep front faces counter-clockwise
+                glm::vec3 p0 = project(normalized[indices[t]]);
+                glm::vec3 p1 = project(normalized[indices[t + 1]]);
+                glm::vec3 p2 = project(normalized[indices[t + 2]]);
+                rasterizeTriangle(p0, p2, p1, depth, shaded);
+            }
+
+            for (unsigned int count : shaded) {
+                if (count > 0) {
+                    stats.pixelsCovered++;
+                    stats.pixelsShaded += count;
+                }
+            }
+        }
+    }
+
+    stats.overdraw = stats.pixelsCovered ? static_cast<float>(stats.pixelsShaded) / stats.pixelsCovered : 0.0f;
+    return stats;
+}
+
+void GLTFMeshOptimizer::optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, unsigned int cacheSize, float threshold) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || vertices.empty()) return;
+
+    for (size_t i = 0; i < triangleCount * 3; ++i) {
+        if (indices[i] >= vertices.size()) {
+            std::cerr << "optimizeOverdraw: index " << indices[i] << " out of range, skipping primitive" << std::endl;
+            return;
+        }
+    }
+
+    std::vector<size_t> clusters;
+    findClusterBoundaries(indices, vertices.size(), cacheSize, threshold, clusters);
+    size_t clusterCount = clusters.size() - 1;
+
+    // Area weighted centroid and normal for the whole mesh and for each cluster
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+    std::vector<glm::vec3> clusterCentroid(clusterCount, glm::vec3(0.0f));
+    std::vector<glm::vec3> clusterNormal(clusterCount, glm::vec3(0.0f));
+    std::vector<float> clusterArea(clusterCount, 0.0f);
+
+    for (size_t c = 0; c < clusterCount; ++c) {
+        for (size_t t = clusters[c]; t < clusters[c + 1]; ++t) {
+            const glm::vec3& p0 = vertices[indices[t * 3 + 0]].position;
+            const glm::vec3& p1 = vertices[indices[t * 3 + 1]].position;
+            const glm::vec3& p2 = vertices[indices[t * 3 + 2]].position;
+            glm::vec3 cross = glm::cross(p1 - p0, p2 - p0);
+            float area = glm::length(cross); // twice the area, consistently
+            glm::vec3 centroid = (p0 + p1 + p2) / 3.0f;
+
+            clusterCentroid[c] += centroid * area;
+            clusterNormal[c] += cross;
+            clusterArea[c] += area;
+        }
+        meshCentroid += clusterCentroid[c];
+        meshArea += clusterArea[c];
+    }
+    if (meshArea > 0.0f) meshCentroid /= meshArea;
+
+    // Clusters facing away from the centre are likely to occlude the rest, so draw them first
+    std::vector<float> sortKey(clusterCount, 0.0f);
+    for (size_t c = 0; c < clusterCount; ++c) {
+        if (clusterArea[c] <= 0.0f) continue;
+        glm::vec3 centroid = clusterCentroid[c] / clusterArea[c];
+        float normalLength = glm::length(clusterNormal[c]);
+        glm::vec3 normal = normalLength > 0.0f ? clusterNormal[c] / normalLength : glm::vec3(0.0f);
+        sortKey[c] = glm::dot(centroid - meshCentroid, normal);
+    }
+
+    std::vector<size_t> order(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c) order[c] = c;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sortKey[a] > sortKey[b]; });
+
+    std::vector<unsigned int> output;
+    output.reserve(triangleCount * 3);
+    for (size_t c : order) {
+        output.insert(output.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+    }
+    indices.swap(output);
+}
+
+std::vector<unsigned int> GLTFMeshOptimizer::optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+    const unsigned int unassigned = ~0u;
+    std::vector<unsigned int> remap(vertices.size(), unassigned);
+    unsigned int nextIndex = 0;
+
+    for (unsigned int& index : indices) {
+        if (index >= vertices.size()) continue;
+        if (remap[index] == unassigned) {
+            remap[index] = nextIndex++;
+        }
+        index = remap[index];
+    }
+
+    // Keep unreferenced vertices so the vertex count does not change; they just go last
+    for (unsigned int& target : remap) {
+        if (target == unassigned) target = nextIndex++;
+    }
+
+    std::vector<Vertex> reordered(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        reordered[remap[i]] = vertices[i];
+    }
+    vertices.swap(reordered);
+
+    return remap;
+}
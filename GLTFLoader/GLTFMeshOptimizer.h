@@ -0,0 +1,51 @@
+#ifndef GLTF_MESH_OPTIMIZER_H
+#define GLTF_MESH_OPTIMIZER_H
+
+#include <vector>
+#include "Vertex.h"
+
+// Import-time index and vertex buffer processing. Everything in here runs once per primitive
+// while the model is loaded, never per frame.
+class GLTFMeshOptimizer {
+public:
+    struct VertexCacheStats {
+        float acmr = 0.0f; // average cache miss ratio: vertex shader invocations per triangle (0.5 - 3.0)
+        float atvr = 0.0f; // average transformed vertex ratio: invocations per referenced vertex (1.0 is ideal)
+    };
+
+    struct OverdrawStats {
+        float overdraw = 0.0f; // shaded fragments per covered pixel (1.0 is ideal)
+        size_t pixelsCovered = 0;
+        size_t pixelsShaded = 0;
+    };
+
+    // Merges vertices whose position, normal, UV, joints and weights all match, either exactly or within
+    // epsilon, and rewrites the indices. Returns the old-to-new vertex remap.
+    static std::vector<unsigned int> weldVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, float epsilon = 0.0f);
+
+    // Drops triangles that repeat an index or have zero area. Returns the number of triangles removed.
+    static size_t removeDegenerateTriangles(const std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+    // Strips vertices no index refers to, keeping the order of the rest. Removed vertices map to ~0u.
+    static std::vector<unsigned int> removeUnusedVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+    // Simulates a FIFO post-transform cache of the given size over a triangle list
+    static VertexCacheStats analyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize = 16);
+
+    // Reorders triangles for post-transform cache locality (Tipsify, Sander et al. 2007)
+    static void optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize = 16);
+
+    // Rasterizes the primitive on the CPU from six axis-aligned viewpoints (with back-face culling and
+    // early depth test) and reports how many fragments are shaded per covered pixel
+    static OverdrawStats analyzeOverdraw(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+
+    // Splits a cache-optimized triangle list into clusters and sorts them outside-in so that occluders
+    // are drawn first. threshold bounds the allowed ACMR regression (1.05 = up to 5% worse).
+    static void optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, unsigned int cacheSize = 16, float threshold = 1.05f);
+
+    // Reorders vertices into first-use order and remaps the indices so vertex fetch streams linearly.
+    // Unreferenced vertices are moved to the end. Returns the old-to-new vertex remap.
+    static std::vector<unsigned int> optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+};
+
+#endif // GLTF_MESH_OPTIMIZER_H
@@ -0,0 +1,382 @@
+#include "GLTFMeshlets.h"
+#include "GLTFMeshOptimizer.h"
+#include "GLTFFrustumCuller.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+void GLTFMeshlets::build(GLTFMesh::PrimitiveGeometry& geometry, unsigned int maxVertices, unsigned int maxTriangles) {
+    auto& indices = geometry.indices;
+    const auto& vertices = geometry.vertices;
+    geometry.meshlets.clear();
+    geometry.meshletJoints.clear();
+
+    size_t triangleCount = indices.size() / 3;
+    size_t vertexCount = vertices.size();
+    if (triangleCount == 0 || maxVertices < 3 || maxTriangles == 0) return;
+    for (size_t i = 0; i < triangleCount * 3; ++i) {
+        if (indices[i] >= vertexCount) return;
+    }
+
+    // Vertex -> triangle adjacency
+    std::vector<unsigned int> offsets(vertexCount + 1, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i) offsets[indices[i] + 1]++;
+    for (size_t v = 0; v < vertexCount; ++v) offsets[v + 1] += offsets[v];
+    std::vector<unsigned int> adjacency(triangleCount * 3);
+    std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        for (int k = 0; k < 3; ++k) adjacency[fill[indices[t * 3 + k]]++] = static_cast<unsigned int>(t);
+    }
+
+    std::vector<char> emitted(triangleCount, 0);
+    std::vector<unsigned int> vertexMeshlet(vertexCount, ~0u); // last meshlet that referenced each vertex
+    std::vector<unsigned int> reordered;
+    reordered.reserve(triangleCount * 3);
+    std::vector<unsigned int> candidates;
+    CentroidTree tree; // built on the first fallback; connected meshes never need it
+    size_t seed = 0;
+
+    while (true) {
+        // Seeds follow the incoming triangle order, so the cache and overdraw ordering is mostly kept
+        while (seed < triangleCount && emitted[seed]) seed++;
+        if (seed == triangleCount) break;
+
+        GLTFMesh::Meshlet meshlet;
+        meshlet.triangleOffset = static_cast<unsigned int>(reordered.size() / 3);
+        unsigned int id = static_cast<unsigned int>(geometry.meshlets.size());
+        candidates.clear();
+        candidates.push_back(static_cast<unsigned int>(seed));
+        glm::vec3 meshletCentroid(0.0f);
+
+        while (meshlet.triangleCount < maxTriangles) {
+            // Take the neighbouring triangle that adds the fewest new vertices
+            unsigned int best = ~0u;
+            unsigned int bestNewVertices = 4;
+            for (size_t c = 0; c < candidates.size();) {
+                unsigned int t = candidates[c];
+                if (emitted[t]) {
+                    candidates[c] = candidates.back();
+                    candidates.pop_back();
+                    continue;
+                }
+
+                unsigned int newVertices = 0;
+                for (int k = 0; k < 3; ++k) {
+                    if (vertexMeshlet[indices[t * 3 + k]] != id) newVertices++;
+                }
+                if (meshlet.vertexCount + newVertices <= maxVertices &&
+                    (newVertices < bestNewVertices || (newVertices == bestNewVertices && t < best))) {
+                    best = t;
+                    bestNewVertices = newVertices;
+                }
+                ++c;
+            }
+            if (best == ~0u && candidates.empty() && meshlet.vertexCount < maxVertices / 2) {
+                // The connected region ran out; continue with the closest remaining triangle instead of
+                // closing a half-empty meshlet
+                if (tree.positions.empty()) buildCentroidTree(indices, vertices, emitted, tree);
+                best = findNearestTriangle(tree, meshletCentroid / static_cast<float>(meshlet.triangleCount));
+            }
+            if (best == ~0u) break;
+
+            emitted[best] = 1;
+            if (!tree.positions.empty()) removeFromCentroidTree(tree, best);
+            meshlet.triangleCount++;
+            for (int k = 0; k < 3; ++k) {
+                unsigned int v = indices[best * 3 + k];
+                reordered.push_back(v);
+                meshletCentroid += vertices[v].position / 3.0f;
+                if (vertexMeshlet[v] == id) continue;
+
+                vertexMeshlet[v] = id;
+                meshlet.vertexCount++;
+                for (unsigned int a = offsets[v]; a < offsets[v + 1]; ++a) {
+                    if (!emitted[adjacency[a]]) candidates.push_back(adjacency[a]);
+                }
+            }
+        }
+
+        geometry.meshlets.push_back(meshlet);
+    }
+
+    // Reordering only permutes whole triangles, so the bounds can be computed on the final layout.
+    // Triangles are cache-optimized again inside each meshlet since growth order ignores the cache.
+    // The optimizer runs on meshlet-local vertex numbers, so its per-vertex state stays meshlet sized.
+    indices.swap(reordered);
+    std::vector<unsigned int> meshletIndices;
+    std::vector<unsigned int> meshletVertices;
+    std::vector<unsigned int> localIndex(vertexCount, ~0u);
+    for (auto& meshlet : geometry.meshlets) {
+        auto first = indices.begin() + static_cast<size_t>(meshlet.triangleOffset) * 3;
+        auto last = first + static_cast<size_t>(meshlet.triangleCount) * 3;
+        meshletIndices.clear();
+        meshletVertices.clear();
+        for (auto it = first; it != last; ++it) {
+            if (localIndex[*it] == ~0u) {
+                localIndex[*it] = static_cast<unsigned int>(meshletVertices.size());
+                meshletVertices.push_back(*it);
+            }
+            meshletIndices.push_back(localIndex[*it]);
+        }
+        GLTFMeshOptimizer::optimizeVertexCache(meshletIndices, meshletVertices.size());
+        for (size_t i = 0; i < meshletIndices.size(); ++i) first[i] = meshletVertices[meshletIndices[i]];
+        for (unsigned int v : meshletVertices) localIndex[v] = ~0u;
+
+        computeBounds(meshlet, geometry, geometry.meshletJoints);
+    }
+}
+
+namespace {
+    void buildTreeRange(std::vector<unsigned int>& triangles, std::vector<glm::vec3>& centroids, std::vector<unsigned char>& axes,
+        std::vector<unsigned int>& liveCounts, size_t begin, size_t end) {
+        if (begin >= end) return;
+
+        // Split the widest axis at the median
+        glm::vec3 minimum = centroids[begin], maximum = centroids[begin];
+        for (size_t i = begin + 1; i < end; ++i) {
+            minimum = glm::min(minimum, centroids[i]);
+            maximum = glm::max(maximum, centroids[i]);
+        }
+        glm::vec3 extent = maximum - minimum;
+        int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+
+        size_t middle = begin + (end - begin) / 2;
+        std::vector<size_t> order(end - begin);
+        for (size_t i = 0; i < order.size(); ++i) order[i] = begin + i;
+        std::nth_element(order.begin(), order.begin() + (middle - begin), order.end(),
+            [&](size_t a, size_t b) { return centroids[a][axis] < centroids[b][axis]; });
+        std::vector<unsigned int> sortedTriangles(order.size());
+        std::vector<glm::vec3> sortedCentroids(order.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            sortedTriangles[i] = triangles[order[i]];
+            sortedCentroids[i] = centroids[order[i]];
+        }
+        std::copy(sortedTriangles.begin(), sortedTriangles.end(), triangles.begin() + begin);
+        std::copy(sortedCentroids.begin(), sortedCentroids.end(), centroids.begin() + begin);
+
+        axes[middle] = static_cast<unsigned char>(axis);
+        liveCounts[middle] = static_cast<unsigned int>(end - begin);
+        buildTreeRange(triangles, centroids, axes, liveCounts, begin, middle);
+        buildTreeRange(triangles, centroids, axes, liveCounts, middle + 1, end);
+    }
+
+    void findNearestInRange(const std::vector<unsigned int>& triangles, const std::vector<glm::vec3>& centroids,
+        const std::vector<unsigned char>& axes, const std::vector<unsigned int>& liveCounts, size_t begin, size_t end,
+        const glm::vec3& point, unsigned int& nearest, float& nearestDistance) {
+        if (begin >= end) return;
+        size_t middle = begin + (end - begin) / 2;
+        if (liveCounts[middle] == 0) return;
+
+        // A node's own triangle is live when its count exceeds its children's
+        size_t leftMiddle = begin + (middle - begin) / 2;
+        size_t rightMiddle = middle + 1 + (end - middle - 1) / 2;
+        unsigned int childLive = (middle > begin ? liveCounts[leftMiddle] : 0) + (end > middle + 1 ? liveCounts[rightMiddle] : 0);
+        if (liveCounts[middle] > childLive) {
+            glm::vec3 offset = centroids[middle] - point;
+            float distance = glm::dot(offset, offset);
+            unsigned int t = triangles[middle];
+            if (distance < nearestDistance || (distance == nearestDistance && t < nearest)) {
+                nearestDistance = distance;
+                nearest = t;
+            }
+        }
+
+        float split = point[axes[middle]] - centroids[middle][axes[middle]];
+        if (split < 0.0f) {
+            findNearestInRange(triangles, centroids, axes, liveCounts, begin, middle, point, nearest, nearestDistance);
+            if (split * split <= nearestDistance) findNearestInRange(triangles, centroids, axes, liveCounts, middle + 1, end, point, nearest, nearestDistance);
+        }
+        else {
+            findNearestInRange(triangles, centroids, axes, liveCounts, middle + 1, end, point, nearest, nearestDistance);
+            if (split * split <= nearestDistance) findNearestInRange(triangles, centroids, axes, liveCounts, begin, middle, point, nearest, nearestDistance);
+        }
+    }
+}
+
+void GLTFMeshlets::buildCentroidTree(const std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices,
+    const std::vector<char>& emitted, CentroidTree& tree) {
+    for (size_t t = 0; t < emitted.size(); ++t) {
+        if (emitted[t]) continue;
+        tree.triangles.push_back(static_cast<unsigned int>(t));
+        tree.centroids.push_back((vertices[indices[t * 3]].position + vertices[indices[t * 3 + 1]].position + vertices[indices[t * 3 + 2]].position) / 3.0f);
+    }
+    tree.axes.resize(tree.triangles.size());
+    tree.liveCounts.resize(tree.triangles.size());
+    buildTreeRange(tree.triangles, tree.centroids, tree.axes, tree.liveCounts, 0, tree.triangles.size());
+
+    tree.positions.assign(emitted.size(), ~0u);
+    for (size_t i = 0; i < tree.triangles.size(); ++i) tree.positions[tree.triangles[i]] = static_cast<unsigned int>(i);
+}
+
+void GLTFMeshlets::removeFromCentroidTree(CentroidTree& tree, unsigned int triangle) {
+    size_t position = tree.positions[triangle];
+    if (position == ~0u) return;
+    tree.positions[triangle] = ~0u;
+
+    // Every node from the root down to the triangle's own loses one live triangle
+    size_t begin = 0, end = tree.triangles.size();
+    while (begin < end) {
+        size_t middle = begin + (end - begin) / 2;
+        tree.liveCounts[middle]--;
+        if (position == middle) break;
+        if (position < middle) end = middle;
+        else begin = middle + 1;
+    }
+}
+
+unsigned int GLTFMeshlets::findNearestTriangle(const CentroidTree& tree, const glm::vec3& point) {
+    unsigned int nearest = ~0u;
+    float nearestDistance = FLT_MAX;
+    findNearestInRange(tree.triangles, tree.centroids, tree.axes, tree.liveCounts, 0, tree.triangles.size(), point, nearest, nearestDistance);
+    return nearest;
+}
+
+void GLTFMeshlets::computeBounds(GLTFMesh::Meshlet& meshlet, const GLTFMesh::PrimitiveGeometry& geometry, std::vector<int>& meshletJoints) {
+    const auto& vertices = geometry.vertices;
+    size_t first = static_cast<size_t>(meshlet.triangleOffset) * 3;
+    size_t last = first + static_cast<size_t>(meshlet.triangleCount) * 3;
+
+    // Ritter's bounding sphere: start from the most distant pair of axis extremes, then grow to fit
+    size_t minIndex[3] = { first, first, first };
+    size_t maxIndex[3] = { first, first, first };
+    for (size_t i = first; i < last; ++i) {
+        const glm::vec3& p = vertices[geometry.indices[i]].position;
+        for (int axis = 0; axis < 3; ++axis) {
+            if (p[axis] < vertices[geometry.indices[minIndex[axis]]].position[axis]) minIndex[axis] = i;
+            if (p[axis] > vertices[geometry.indices[maxIndex[axis]]].position[axis]) maxIndex[axis] = i;
+        }
+    }
+    float widest = -1.0f;
+    for (int axis = 0; axis < 3; ++axis) {
+        glm::vec3 a = vertices[geometry.indices[minIndex[axis]]].position;
+        glm::vec3 b = vertices[geometry.indices[maxIndex[axis]]].position;
+        float distance = glm::length(b - a);
+        if (distance > widest) {
+            widest = distance;
+            meshlet.center = (a + b) * 0.5f;
+            meshlet.radius = distance * 0.5f;
+        }
+    }
+    for (size_t i = first; i < last; ++i) {
+        const glm::vec3& p = vertices[geometry.indices[i]].position;
+        float distance = glm::length(p - meshlet.center);
+        if (distance > meshlet.radius) {
+            float grownRadius = (meshlet.radius + distance) * 0.5f;
+            meshlet.center += (p - meshlet.center) * ((grownRadius - meshlet.radius) / distance);
+            meshlet.radius = grownRadius;
+        }
+    }
+
+    // Joints that can move this meshlet, for skinned bounds at cull time
+    meshlet.jointOffset = static_cast<unsigned int>(meshletJoints.size());
+    for (size_t i = first; i < last; ++i) {
+        const Vertex& vertex = vertices[geometry.indices[i]];
+        for (int k = 0; k < 4; ++k) {
+            if (vertex.weights[k] <= 0.0f) continue;
+            auto begin = meshletJoints.begin() + meshlet.jointOffset;
+            if (std::find(begin, meshletJoints.end(), vertex.joints[k]) == meshletJoints.end()) {
+                meshletJoints.push_back(vertex.joints[k]);
+            }
+        }
+    }
+    meshlet.jointCount = static_cast<unsigned int>(meshletJoints.size() - meshlet.jointOffset);
+
+    // Normal cone from the face normals. Skinning rotates the faces, so skinned meshlets keep it disabled.
+    meshlet.coneCutoff = 1.0f;
+    if (meshlet.jointCount > 0) return;
+
+    glm::vec3 normalSum(0.0f);
+    for (size_t i = first; i < last; i += 3) {
+        glm::vec3 p0 = vertices[geometry.indices[i]].position;
+        glm::vec3 p1 = vertices[geometry.indices[i + 1]].position;
+        glm::vec3 p2 = vertices[geometry.indices[i + 2]].position;
+        normalSum += glm::cross(p1 - p0, p2 - p0);
+    }
+    float sumLength = glm::length(normalSum);
+    if (sumLength <= 0.0f) return;
+    meshlet.coneAxis = normalSum / sumLength;
+
+    float minDot = 1.0f;
+    for (size_t i = first; i < last; i += 3) {
+        glm::vec3 p0 = vertices[geometry.indices[i]].position;
+        glm::vec3 p1 = vertices[geometry.indices[i + 1]].position;
+        glm::vec3 p2 = vertices[geometry.indices[i + 2]].position;
+        glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+        float length = glm::length(normal);
+        if (length <= 0.0f) continue;
+        minDot = std::min(minDot, glm::dot(normal / length, meshlet.coneAxis));
+    }
+
+    // Normals spread past 90 degrees from the axis can always face some viewer
+    if (minDot > 0.0f) {
+        meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+    }
+}
+
+size_t GLTFMeshlets::cull(const std::vector<GLTFMesh::Meshlet>& meshlets, const std::vector<int>& meshletJoints,
+    const glm::mat4& modelViewProjection, const glm::vec3& cameraPosition,
+    std::span<const glm::mat4> jointMatrices, std::vector<IndexRange>& ranges) {
+    ranges.clear();
+
+    // Frustum planes in model space, normalized so sphere tests use real distances
+    GLTFFrustumCuller::Frustum frustum = GLTFFrustumCuller::extractFrustum(modelViewProjection);
+
+    size_t visible = 0;
+    for (const auto& meshlet : meshlets) {
+        glm::vec3 center = meshlet.center;
+        float radius = meshlet.radius;
+
+        if (meshlet.jointCount > 0 && !jointMatrices.empty()) {
+            // A skinned vertex is a weighted average of its joint-transformed copies, so it lies inside the
+            // sphere that encloses the bind sphere transformed by every influencing joint
+            glm::vec3 centerSum(0.0f);
+            unsigned int used = 0;
+            for (unsigned int j = 0; j < meshlet.jointCount; ++j) {
+                int joint = meshletJoints[meshlet.jointOffset + j];
+                if (joint < 0 || joint >= static_cast<int>(jointMatrices.size())) continue;
+                centerSum += glm::vec3(jointMatrices[joint] * glm::vec4(meshlet.center, 1.0f));
+                used++;
+            }
+            if (used > 0) {
+                center = centerSum / static_cast<float>(used);
+                radius = 0.0f;
+                for (unsigned int j = 0; j < meshlet.jointCount; ++j) {
+                    int joint = meshletJoints[meshlet.jointOffset + j];
+                    if (joint < 0 || joint >= static_cast<int>(jointMatrices.size())) continue;
+                    const glm::mat4& m = jointMatrices[joint];
+                    float scale = std::max(glm::length(glm::vec3(m[0])), std::max(glm::length(glm::vec3(m[1])), glm::length(glm::vec3(m[2]))));
+                    glm::vec3 jointCenter = glm::vec3(m * glm::vec4(meshlet.center, 1.0f));
+                    radius = std::max(radius, glm::length(jointCenter - center) + meshlet.radius * scale);
+                }
+            }
+        }
+
+        bool culled = false;
+        for (const auto& plane : frustum.planes) {
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+                culled = true;
+                break;
+            }
+        }
+
+        // Every face in the cluster points away from the camera
+        if (!culled && meshlet.coneCutoff < 1.0f && meshlet.jointCount == 0) {
+            glm::vec3 toCluster = center - cameraPosition;
+            if (glm::dot(toCluster, meshlet.coneAxis) >= meshlet.coneCutoff * glm::length(toCluster) + radius) {
+                culled = true;
+            }
+        }
+        if (culled) continue;
+
+        visible++;
+        size_t firstIndex = static_cast<size_t>(meshlet.triangleOffset) * 3;
+        size_t indexCount = static_cast<size_t>(meshlet.triangleCount) * 3;
+        if (!ranges.empty() && ranges.back().firstIndex + ranges.back().indexCount == firstIndex) {
+            ranges.back().indexCount += indexCount;
+        }
+        else {
+            ranges.push_back({ firstIndex, indexCount });
+        }
+    }
+    return visible;
+}
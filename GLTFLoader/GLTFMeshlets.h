@@ -0,0 +1,47 @@
+#ifndef GLTF_MESHLETS_H
+#define GLTF_MESHLETS_H
+
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+#include "GLTFMesh.h"
+
+// Splits primitives into meshlets at import and culls them per view at render time
+class GLTFMeshlets {
+public:
+    struct IndexRange {
+        size_t firstIndex;
+        size_t indexCount;
+    };
+
+    // Grows meshlets from neighbouring triangles and reorders geometry.indices so every meshlet is one
+    // contiguous range. Fills geometry.meshlets and geometry.meshletJoints.
+    static void build(GLTFMesh::PrimitiveGeometry& geometry, unsigned int maxVertices = 64, unsigned int maxTriangles = 124);
+
+    // Tests every meshlet against the view frustum and its normal cone and writes the surviving index ranges,
+    // with adjacent ranges merged. cameraPosition is in model space. Skinned meshlets are bounded with
+    // jointMatrices and skip the cone test. Returns the number of visible meshlets.
+    static size_t cull(const std::vector<GLTFMesh::Meshlet>& meshlets, const std::vector<int>& meshletJoints,
+        const glm::mat4& modelViewProjection, const glm::vec3& cameraPosition,
+        std::span<const glm::mat4> jointMatrices, std::vector<IndexRange>& ranges);
+
+private:
+    // Implicit kd-tree over the centroids of the triangles left when the first fallback happens. The node of
+    // range [begin, end) is its middle element, which holds that subtree's unemitted count, so searches skip
+    // regions that are used up.
+    struct CentroidTree {
+        std::vector<unsigned int> triangles;
+        std::vector<glm::vec3> centroids; // in tree order
+        std::vector<unsigned char> axes;
+        std::vector<unsigned int> liveCounts;
+        std::vector<unsigned int> positions; // tree position of each triangle, ~0u if not in the tree
+    };
+
+    static void buildCentroidTree(const std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices,
+        const std::vector<char>& emitted, CentroidTree& tree);
+    static void removeFromCentroidTree(CentroidTree& tree, unsigned int triangle);
+    static unsigned int findNearestTriangle(const CentroidTree& tree, const glm::vec3& point);
+    static void computeBounds(GLTFMesh::Meshlet& meshlet, const GLTFMesh::PrimitiveGeometry& geometry, std::vector<int>& meshletJoints);
+};
+
+#endif // GLTF_MESHLETS_H
@@ -0,0 +1,157 @@
+#include "GLTFMorphTargets.h"
+#include "GLTFSimd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+static_assert(sizeof(Vertex) % sizeof(float) == 0, "Vertex is addressed as a float array");
+static_assert(offsetof(Vertex, position) + 4 * sizeof(float) <= sizeof(Vertex), "position needs a float after it");
+static_assert(offsetof(Vertex, normal) + 4 * sizeof(float) <= sizeof(Vertex), "normal needs a float after it");
+
+namespace {
+    void addDeltasScalar(float* data, size_t stride, const unsigned int* vertices, const glm::vec4* deltas, size_t begin, size_t count, float weight) {
+        for (size_t i = begin; i < count; ++i) {
+            float* target = data + vertices[i] * stride;
+            target[0] += deltas[i].x * weight;
+            target[1] += deltas[i].y * weight;
+            target[2] += deltas[i].z * weight;
+        }
+    }
+
+#if defined(GLTF_SIMD_X86)
+    // A target's vertices are distinct, so the four read-modify-writes of an iteration never overlap. The
+    // padding lane adds 0 to whatever float follows the attribute.
+    void addDeltasSSE(float* data, size_t stride, const unsigned int* vertices, const glm::vec4* deltas, size_t count, float weight) {
+        const __m128 w = _mm_set1_ps(weight);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            float* p0 = data + vertices[i] * stride;
+            float* p1 = data + vertices[i + 1] * stride;
+            float* p2 = data + vertices[i + 2] * stride;
+            float* p3 = data + vertices[i + 3] * stride;
+            __m128 v0 = _mm_add_ps(_mm_loadu_ps(p0), _mm_mul_ps(_mm_loadu_ps(&deltas[i].x), w));
+            __m128 v1 = _mm_add_ps(_mm_loadu_ps(p1), _mm_mul_ps(_mm_loadu_ps(&deltas[i + 1].x), w));
+            __m128 v2 = _mm_add_ps(_mm_loadu_ps(p2), _mm_mul_ps(_mm_loadu_ps(&deltas[i + 2].x), w));
+            __m128 v3 = _mm_add_ps(_mm_loadu_ps(p3), _mm_mul_ps(_mm_loadu_ps(&deltas[i + 3].x), w));
+            _mm_storeu_ps(p0, v0);
+            _mm_storeu_ps(p1, v1);
+            _mm_storeu_ps(p2, v2);
+            _mm_storeu_ps(p3, v3);
+        }
+        addDeltasScalar(data, stride, vertices, deltas, i, count, weight);
+    }
+#endif
+}
+
+GLTFMorphTargets::SparseDeltas GLTFMorphTargets::packDeltas(const std::vector<unsigned int>& indices, const std::vector<glm::vec3>& values, size_t vertexCount) {
+    SparseDeltas result;
+    const size_t count = std::min(indices.size(), values.size());
+    for (size_t i = 0; i < count; ++i) {
+        if (indices[i] >= vertexCount || values[i] == glm::vec3(0.0f)) continue;
+        result.vertices.push_back(indices[i]);
+        result.deltas.push_back(glm::vec4(values[i], 0.0f));
+    }
+    // Sparse accessors list indices in increasing order already; dense ones are scanned in order
+    return result;
+}
+
+void GLTFMorphTargets::remapTargets(std::vector<Target>& targets, const std::vector<unsigned int>& remap) {
+    std::vector<std::pair<unsigned int, glm::vec4>> entries;
+    auto remapDeltas = [&](SparseDeltas& deltas) {
+        entries.clear();
+        for (size_t i = 0; i < deltas.vertices.size(); ++i) {
+            unsigned int vertex = deltas.vertices[i] < remap.size() ? remap[deltas.vertices[i]] : ~0u;
+            if (vertex != ~0u) entries.emplace_back(vertex, deltas.deltas[i]);
+        }
+        // Back in vertex order, so the kernels stream through the blended vertices front to back
+        std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        deltas.vertices.resize(entries.size());
+        deltas.deltas.resize(entries.size());
+        for (size_t i = 0; i < entries.size(); ++i) {
+            deltas.vertices[i] = entries[i].first;
+            deltas.deltas[i] = entries[i].second;
+        }
+    };
+    for (auto& target : targets) {
+        remapDeltas(target.positions);
+        remapDeltas(target.normals);
+        remapDeltas(target.tangents);
+    }
+}
+
+float GLTFMorphTargets::getMaxDisplacement(const std::vector<Target>& targets, const std::vector<float>& largestWeights) {
+    float displacement = 0.0f;
+    for (size_t t = 0; t < targets.size() && t < largestWeights.size(); ++t) {
+        displacement += targets[t].maxDisplacement * std::abs(largestWeights[t]);
+    }
+    return displacement;
+}
+
+void GLTFMorphTargets::initialize(const std::vector<Vertex>& baseVertices, const std::vector<Target>& morphTargets) {
+    base = &baseVertices;
+    targets = &morphTargets;
+    vertices = baseVertices;
+    appliedWeights.assign(morphTargets.size(), 0.0f);
+
+    std::vector<bool> moved(baseVertices.size(), false);
+    for (const auto& target : morphTargets) {
+        for (unsigned int vertex : target.positions.vertices) moved[vertex] = true;
+        for (unsigned int vertex : target.normals.vertices) moved[vertex] = true;
+    }
+    affectedVertices.clear();
+    for (size_t i = 0; i < moved.size(); ++i) {
+        if (moved[i]) affectedVertices.push_back(static_cast<unsigned int>(i));
+    }
+}
+
+bool GLTFMorphTargets::isEmpty() const {
+    return !targets || targets->empty();
+}
+
+bool GLTFMorphTargets::apply(const float* weights, size_t weightCount) {
+    if (isEmpty()) return false;
+
+    const size_t targetCount = targets->size();
+    bool changed = false;
+    for (size_t t = 0; t < targetCount; ++t) {
+        float weight = t < weightCount ? weights[t] : 0.0f;
+        if (weight != appliedWeights[t]) {
+            appliedWeights[t] = weight;
+            changed = true;
+        }
+    }
+    if (!changed) return false;
+
+    const std::vector<Vertex>& from = *base;
+    for (unsigned int vertex : affectedVertices) {
+        vertices[vertex].position = from[vertex].position;
+        vertices[vertex].normal = from[vertex].normal;
+    }
+
+    float* data = reinterpret_cast<float*>(vertices.data());
+    const size_t stride = sizeof(Vertex) / sizeof(float);
+    for (size_t t = 0; t < targetCount; ++t) {
+        const float weight = appliedWeights[t];
+        if (weight == 0.0f) continue;
+        const Target& target = (*targets)[t];
+        addDeltas(data + offsetof(Vertex, position) / sizeof(float), stride, target.positions, weight);
+        addDeltas(data + offsetof(Vertex, normal) / sizeof(float), stride, target.normals, weight);
+    }
+    return true;
+}
+
+const std::vector<Vertex>& GLTFMorphTargets::getVertices() const {
+    return vertices;
+}
+
+void GLTFMorphTargets::addDeltas(float* data, size_t stride, const SparseDeltas& deltas, float weight) {
+    const size_t count = deltas.vertices.size();
+    switch (GLTFSimd::getLevel()) {
+#if defined(GLTF_SIMD_X86)
+    case GLTFSimd::Level::AVX2:
+    case GLTFSimd::Level::SSE: addDeltasSSE(data, stride, deltas.vertices.data(), deltas.deltas.data(), count, weight); break;
+#endif
+    default: addDeltasScalar(data, stride, deltas.vertices.data(), deltas.deltas.data(), 0, count, weight); break;
+    }
+}
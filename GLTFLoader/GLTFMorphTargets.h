@@ -0,0 +1,55 @@
+#ifndef GLTF_MORPH_TARGETS_H
+#define GLTF_MORPH_TARGETS_H
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "Vertex.h"
+
+// Blends a primitive's morph targets (blend shapes) into a copy of its vertices on the CPU. Targets are
+// kept sparse, so a frame costs the deltas of the targets with a non-zero weight instead of targets times
+// vertices. The delta loop picks a scalar or SSE kernel through GLTFSimd.
+class GLTFMorphTargets {
+public:
+    // What one target adds to one attribute, only for the vertices it moves, in increasing vertex order.
+    // Deltas are padded to four floats so a kernel adds each with one unaligned load and store.
+    struct SparseDeltas {
+        std::vector<unsigned int> vertices;
+        std::vector<glm::vec4> deltas; // w is 0
+    };
+
+    struct Target {
+        SparseDeltas positions;
+        SparseDeltas normals;
+        SparseDeltas tangents;        // decoded, but Vertex has no tangent to apply them to
+        float maxDisplacement = 0.0f; // longest position delta
+    };
+
+    // Keeps the non-zero deltas of vertices below vertexCount
+    static SparseDeltas packDeltas(const std::vector<unsigned int>& indices, const std::vector<glm::vec3>& values, size_t vertexCount);
+    // Renumbers the deltas after the vertices were reordered (old -> new index, ~0u for removed vertices)
+    static void remapTargets(std::vector<Target>& targets, const std::vector<unsigned int>& remap);
+    // How far a vertex can move from its bind position while target t's weight stays within
+    // +-largestWeights[t]; targets without an entry count as weight 0
+    static float getMaxDisplacement(const std::vector<Target>& targets, const std::vector<float>& largestWeights);
+
+    // Binds a primitive's vertices and targets, which must outlive this object, and starts at zero weights
+    void initialize(const std::vector<Vertex>& baseVertices, const std::vector<Target>& morphTargets);
+    bool isEmpty() const;
+    // Rebuilds the blended vertices for one weight per target; missing weights count as 0. Returns false
+    // without touching anything when the weights match the last call, so the upload can be skipped.
+    bool apply(const float* weights, size_t weightCount);
+    const std::vector<Vertex>& getVertices() const;
+
+    // data[vertices[i] * stride + 0..2] += deltas[i] * weight. Four floats are read and written per vertex,
+    // so the attribute must be followed by at least one more float.
+    static void addDeltas(float* data, size_t stride, const SparseDeltas& deltas, float weight);
+
+private:
+    const std::vector<Vertex>* base = nullptr;
+    const std::vector<Target>* targets = nullptr;
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> affectedVertices; // moved by at least one target; reset before each blend
+    std::vector<float> appliedWeights;
+};
+
+#endif // GLTF_MORPH_TARGETS_H
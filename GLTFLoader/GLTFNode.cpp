@@ -1,5 +1,9 @@
 #include "GLTFNode.h"
+#include "GLTFTransformKernels.h"
 #include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <glm/gtx/string_cast.hpp> // For glm::to_string
 
 void GLTFNode::parseNodes(yyjson_val* nodesArray) {
@@ -47,6 +51,20 @@ void GLTFNode::parseNodes(yyjson_val* nodesArray) {
             node.meshIndex = yyjson_get_int(mesh_val);
         }
 
+        yyjson_val* skin_val = yyjson_obj_get(node_val, "skin");
+        if (skin_val) {
+            node.skinIndex = yyjson_get_int(skin_val);
+        }
+
+        yyjson_val* weights_val = yyjson_obj_get(node_val, "weights");
+        if (weights_val && yyjson_is_arr(weights_val)) {
+            size_t weight_idx, weight_max;
+            yyjson_val* weight_val;
+            yyjson_arr_foreach(weights_val, weight_idx, weight_max, weight_val) {
+                node.weights.push_back(static_cast<float>(yyjson_get_num(weight_val)));
+            }
+        }
+
         yyjson_val* children_val = yyjson_obj_get(node_val, "children");
         if (children_val && yyjson_is_arr(children_val)) {
             size_t child_idx, child_max;
@@ -96,32 +114,85 @@ void GLTFNode::identifyRootNodes() {
 }
 
 void GLTFNode::calculateGlobalTransforms() {
-    globalTransforms.resize(nodes.size(), glm::mat4(1.0f));
-
-    // Calculate global transforms for root nodes first
-    for (size_t i = 0; i < nodes.size(); ++i) {
-        if (nodes[i].isRoot) {
-            calculateGlobalTransform(i, glm::mat4(1.0f), globalTransforms);
-        }
-    }
+    buildHierarchy();
+    computeAllTransforms();
 
     // Debugging: Print global transforms and parent-child relationships
     for (size_t i = 0; i < nodes.size(); ++i) {
         const Node& node = nodes[i];
-        glm::mat4 localTransform = glm::translate(glm::mat4(1.0f), node.translation) *
-            glm::mat4_cast(node.rotation) *
-            glm::scale(glm::mat4(1.0f), node.scale);
-
-        std::cout << "Node " << i << " local transform: " << glm::to_string(localTransform) << std::endl;
-        std::cout << "Node " << i << " global transform: " << glm::to_string(globalTransforms[i]) << std::endl;
+        std::cout << "Node " << i << " local transform: " << glm::to_string(getLocalTransform(i)) << std::endl;
+        std::cout << "Node " << i << " global transform: " << glm::to_string(getGlobalTransform(i)) << std::endl;
 
         if (!node.isRoot) {
-            std::cout << "Parent node " << node.parentIndex << " global transform: " << glm::to_string(globalTransforms[node.parentIndex]) << std::endl;
+            std::cout << "Parent node " << node.parentIndex << " global transform: " << glm::to_string(getGlobalTransform(node.parentIndex)) << std::endl;
         }
     }
 }
 
+void GLTFNode::buildHierarchy() {
+    size_t count = nodes.size();
+    order.clear();
+    order.reserve(count);
+    nodeToFlat.assign(count, -1);
+
+    // Depth-first from the roots, children in file order. Nodes only reachable through a cycle are
+    // started as roots afterwards so every node gets a slot.
+    std::vector<int> stack;
+    auto visit = [&](int start) {
+        stack.push_back(start);
+        while (!stack.empty()) {
+            int nodeIndex = stack.back();
+            stack.pop_back();
+            if (nodeToFlat[nodeIndex] >= 0) {
+                std::cerr << "Node " << nodeIndex << " is reachable twice; ignoring the second parent" << std::endl;
+                continue;
+            }
+            nodeToFlat[nodeIndex] = static_cast<int>(order.size());
+            order.push_back(nodeIndex);
+            const auto& children = nodes[nodeIndex].children;
+            for (auto it = children.rbegin(); it != children.rend(); ++it) {
+                if (*it >= 0 && *it < static_cast<int>(count)) stack.push_back(*it);
+            }
+        }
+    };
+    for (size_t i = 0; i < count; ++i) {
+        if (nodes[i].isRoot) visit(static_cast<int>(i));
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (nodeToFlat[i] < 0) visit(static_cast<int>(i));
+    }
+
+    flatParents.resize(count);
+    translations.resize(count);
+    rotations.resize(count);
+    scales.resize(count);
+    for (size_t flat = 0; flat < count; ++flat) {
+        const Node& node = nodes[order[flat]];
+        int parent = node.parentIndex >= 0 ? nodeToFlat[node.parentIndex] : -1;
+        flatParents[flat] = parent < static_cast<int>(flat) ? parent : -1; // a cycle's back edge becomes a root
+        translations[flat] = node.translation;
+        rotations[flat] = node.rotation;
+        scales[flat] = node.scale;
+    }
+    localMatrices.assign(count, glm::mat4(1.0f));
+    worldMatrices.assign(count, glm::mat4(1.0f));
+
+    subtreeEnds.resize(count);
+    for (size_t flat = 0; flat < count; ++flat) subtreeEnds[flat] = static_cast<int>(flat) + 1;
+    for (size_t flat = count; flat-- > 0;) {
+        int parent = flatParents[flat];
+        if (parent >= 0) subtreeEnds[parent] = std::max(subtreeEnds[parent], subtreeEnds[flat]);
+    }
 
+    // Everything starts static until told otherwise
+    dynamicNodes.assign(count, 0);
+    affectedNodes.assign(count, 0);
+    localDirty.assign(count, 0);
+    dirtyNodes.clear();
+    worldChanged.assign(count, 0);
+    changedNodes.clear();
+    firstDirty = SIZE_MAX;
+}
 
 void GLTFNode::identifyBones(const std::vector<int>& joints) {
     for (int joint : joints) {
@@ -141,14 +212,9 @@ glm::mat4 GLTFNode::getNodeTransform(const Node& node) const {
 }
 
 int GLTFNode::findParentNodeIndex(int nodeIndex) const {
-    for (size_t i = 0; i < nodes.size(); ++i) {
-        for (int child : nodes[i].children) {
-            if (child == nodeIndex) {
-                return static_cast<int>(i);
-            }
-        }
-    }
-    return -1; // Return -1 if no parent is found
+    // parentIndex is filled once by identifyRootNodes
+    if (nodeIndex < 0 || nodeIndex >= static_cast<int>(nodes.size())) return -1;
+    return nodes[nodeIndex].parentIndex;
 }
 
 std::vector<int> GLTFNode::getRootNodes() const {
@@ -168,21 +234,175 @@ std::vector<int> GLTFNode::getChildNodes(int nodeIndex) const {
     return std::vector<int>();
 }
 
-void GLTFNode::calculateGlobalTransform(size_t nodeIndex, const glm::mat4& parentTransform, std::vector<glm::mat4>& globalTransforms) {
-    const Node& node = nodes[nodeIndex];
-    glm::mat4 localTransform = getNodeTransform(node);
-    glm::mat4 globalTransform = parentTransform * localTransform;
+namespace {
+    // a * b for affine matrices: the bottom row is (0, 0, 0, 1), so the fourth column of a only
+    // contributes to the translation
+    inline glm::mat4 multiplyAffine(const glm::mat4& a, const glm::mat4& b) {
+        glm::mat4 m;
+        m[0] = a[0] * b[0].x + a[1] * b[0].y + a[2] * b[0].z;
+        m[1] = a[0] * b[1].x + a[1] * b[1].y + a[2] * b[1].z;
+        m[2] = a[0] * b[2].x + a[1] * b[2].y + a[2] * b[2].z;
+        m[3] = a[0] * b[3].x + a[1] * b[3].y + a[2] * b[3].z + a[3];
+        return m;
+    }
+}
+
+void GLTFNode::computeAllTransforms() {
+    // Local matrices have no dependencies between nodes, so this loop is kept separate from the parent chain
+    const size_t count = order.size();
+    GLTFTransformKernels::composeTRS(translations.data(), rotations.data(), scales.data(), localMatrices.data(), count);
+    for (size_t flat = 0; flat < count; ++flat) {
+        int parent = flatParents[flat];
+        worldMatrices[flat] = parent < 0 ? localMatrices[flat] : multiplyAffine(worldMatrices[parent], localMatrices[flat]);
+    }
+
+    std::fill(localDirty.begin(), localDirty.end(), 0);
+    dirtyNodes.clear();
+    std::fill(worldChanged.begin(), worldChanged.end(), 1);
+    changedNodes.resize(count);
+    for (size_t flat = 0; flat < count; ++flat) changedNodes[flat] = static_cast<int>(flat);
+    firstDirty = SIZE_MAX;
+}
+
+void GLTFNode::updateGlobalTransforms() {
+    if (order.size() != nodes.size()) {
+        buildHierarchy();
+        computeAllTransforms();
+        return;
+    }
+
+    for (int flat : changedNodes) worldChanged[flat] = 0;
+    changedNodes.clear();
+    if (firstDirty == SIZE_MAX) return;
+
+    // Every dirty local matrix in one batch; the parent chain below is serial and only reads them
+    GLTFTransformKernels::composeTRS(translations.data(), rotations.data(), scales.data(), localMatrices.data(),
+        dirtyNodes.size(), dirtyNodes.data());
+    dirtyNodes.clear();
+
+    // Nothing before the first dirty node can change. Subtrees with no dynamic node in or above them are
+    // skipped in one step, since a subtree is a contiguous range.
+    const size_t count = order.size();
+    for (size_t flat = firstDirty; flat < count;) {
+        if (!affectedNodes[flat]) {
+            flat = subtreeEnds[flat];
+            continue;
+        }
+
+        bool localChanged = localDirty[flat] != 0;
+        localDirty[flat] = 0;
 
-    globalTransforms[nodeIndex] = globalTransform;
+        int parent = flatParents[flat];
+        if (localChanged || (parent >= 0 && worldChanged[parent])) {
+            worldMatrices[flat] = parent < 0 ? localMatrices[flat] : multiplyAffine(worldMatrices[parent], localMatrices[flat]);
+            worldChanged[flat] = 1;
+            changedNodes.push_back(static_cast<int>(flat));
+        }
+        ++flat;
+    }
+    firstDirty = SIZE_MAX;
+}
 
-    // Recursively calculate global transforms for child nodes
-    for (size_t childIndex : node.children) {
-        calculateGlobalTransform(childIndex, globalTransform, globalTransforms);
+void GLTFNode::setAnimatedNodes(const std::vector<int>& nodeIndices) {
+    if (order.size() != nodes.size()) {
+        buildHierarchy();
+        computeAllTransforms();
+    }
+    for (int nodeIndex : nodeIndices) {
+        int flat = getFlatIndex(nodeIndex);
+        if (flat >= 0) markDynamic(flat);
+    }
+
+    size_t staticCount = 0;
+    for (char isAffected : affectedNodes) staticCount += isAffected ? 0 : 1;
+    std::cout << "Nodes: " << staticCount << " of " << order.size() << " static, transforms cached" << std::endl;
+}
+
+void GLTFNode::markDynamic(int flat) {
+    if (dynamicNodes[flat]) return;
+    dynamicNodes[flat] = 1;
+
+    // Descendants move with it; ancestors now contain a moving node and cannot be skipped
+    for (int descendant = flat; descendant < subtreeEnds[flat]; ++descendant) affectedNodes[descendant] = 1;
+    for (int ancestor = flatParents[flat]; ancestor >= 0 && !affectedNodes[ancestor]; ancestor = flatParents[ancestor]) {
+        affectedNodes[ancestor] = 1;
+    }
+}
+
+void GLTFNode::markDirty(int flat) {
+    if (!dynamicNodes[flat]) markDynamic(flat);
+    if (!localDirty[flat]) dirtyNodes.push_back(flat);
+    localDirty[flat] = 1;
+    firstDirty = std::min(firstDirty, static_cast<size_t>(flat));
+}
+
+bool GLTFNode::isStatic(int nodeIndex) const {
+    int flat = getFlatIndex(nodeIndex);
+    return flat >= 0 && !affectedNodes[flat];
+}
+
+bool GLTFNode::hasWorldChanged(size_t nodeIndex) const {
+    return worldChanged[nodeToFlat[nodeIndex]] != 0;
+}
+
+size_t GLTFNode::getLastUpdateCount() const {
+    return changedNodes.size();
+}
+
+const std::vector<int>& GLTFNode::getChangedNodes() const {
+    return changedNodes;
+}
+
+void GLTFNode::propagateBounds(const std::vector<AABB>& localBounds) {
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        nodes[i].worldBounds = i < localBounds.size() ? localBounds[i].transformed(getGlobalTransform(i)) : AABB();
+        nodes[i].subtreeBounds = nodes[i].worldBounds;
+    }
+
+    // Children follow their parents, so a backwards pass folds every subtree into its root
+    for (size_t flat = order.size(); flat-- > 0;) {
+        int parent = flatParents[flat];
+        if (parent >= 0) nodes[order[parent]].subtreeBounds.merge(nodes[order[flat]].subtreeBounds);
+    }
+}
+
+void GLTFNode::refitBounds(const std::vector<AABB>& localBounds, const std::vector<int>& nodeIndices) {
+    boundsDirty.resize(order.size(), 0);
+    boundsPath.clear();
+    for (int nodeIndex : nodeIndices) {
+        nodes[nodeIndex].worldBounds = static_cast<size_t>(nodeIndex) < localBounds.size()
+            ? localBounds[nodeIndex].transformed(getGlobalTransform(nodeIndex)) : AABB();
+        // Paths merge, so each one stops at the first ancestor another node already marked
+        for (int flat = nodeToFlat[nodeIndex]; flat >= 0 && !boundsDirty[flat]; flat = flatParents[flat]) {
+            boundsDirty[flat] = 1;
+            boundsPath.push_back(flat);
+        }
+    }
+
+    // Deepest first, so children are final before their parents merge them
+    std::sort(boundsPath.begin(), boundsPath.end(), std::greater<int>());
+    for (int flat : boundsPath) {
+        Node& node = nodes[order[flat]];
+        node.subtreeBounds = node.worldBounds;
+        for (int child : node.children) node.subtreeBounds.merge(nodes[child].subtreeBounds);
+        boundsDirty[flat] = 0;
     }
 }
 
 const glm::mat4& GLTFNode::getGlobalTransform(size_t nodeIndex) const {
-    return globalTransforms[nodeIndex];
+    return worldMatrices[nodeToFlat[nodeIndex]];
+}
+
+const glm::mat4& GLTFNode::getLocalTransform(size_t nodeIndex) const {
+    return localMatrices[nodeToFlat[nodeIndex]];
+}
+
+const std::vector<int>& GLTFNode::getTopologicalOrder() const {
+    return order;
+}
+
+int GLTFNode::getFlatIndex(int nodeIndex) const {
+    return nodeIndex >= 0 && nodeIndex < static_cast<int>(nodeToFlat.size()) ? nodeToFlat[nodeIndex] : -1;
 }
 
 void GLTFNode::updateNodeTransformation(Node& node) {
@@ -219,25 +439,47 @@ std::vector<GLTFNode::Node>& GLTFNode::getNodes() {
 }
 
 glm::vec3 GLTFNode::getNodeTranslation(int nodeIndex) const {
-    return nodes[nodeIndex].translation;
+    return translations[nodeToFlat[nodeIndex]];
 }
 
 void GLTFNode::setNodeTranslation(int nodeIndex, const glm::vec3& translation) {
     nodes[nodeIndex].translation = translation;
+    setFlatTranslation(nodeToFlat[nodeIndex], translation);
 }
 
 glm::quat GLTFNode::getNodeRotation(int nodeIndex) const {
-    return nodes[nodeIndex].rotation;
+    return rotations[nodeToFlat[nodeIndex]];
 }
 
 void GLTFNode::setNodeRotation(int nodeIndex, const glm::quat& rotation) {
     nodes[nodeIndex].rotation = rotation;
+    setFlatRotation(nodeToFlat[nodeIndex], rotation);
 }
 
 glm::vec3 GLTFNode::getNodeScale(int nodeIndex) const {
-    return nodes[nodeIndex].scale;
+    return scales[nodeToFlat[nodeIndex]];
 }
 
 void GLTFNode::setNodeScale(int nodeIndex, const glm::vec3& scale) {
     nodes[nodeIndex].scale = scale;
-}
\ No newline at end of file
+    setFlatScale(nodeToFlat[nodeIndex], scale);
+}
+
+// Channels holding a constant value leave the subtree clean
+void GLTFNode::setFlatTranslation(int flat, const glm::vec3& translation) {
+    if (translations[flat] == translation) return;
+    translations[flat] = translation;
+    markDirty(flat);
+}
+
+void GLTFNode::setFlatRotation(int flat, const glm::quat& rotation) {
+    if (rotations[flat] == rotation) return;
+    rotations[flat] = rotation;
+    markDirty(flat);
+}
+
+void GLTFNode::setFlatScale(int flat, const glm::vec3& scale) {
+    if (scales[flat] == scale) return;
+    scales[flat] = scale;
+    markDirty(flat);
+}
@@ -3,11 +3,13 @@
 #define GLM_ENABLE_EXPERIMENTAL
 
 #include <vector>
+#include <cstdint>
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/string_cast.hpp>
 #include "yyjson.h"
+#include "GLTFBounds.h"
 
 class GLTFNode {
 public:
@@ -16,6 +18,8 @@ public:
         glm::quat rotation;
         glm::vec3 scale;
         int meshIndex;
+        int skinIndex = -1;
+        std::vector<float> weights; // morph target weights; empty uses the mesh's defaults
         int parentIndex;
         int index;
         std::vector<int> children;
@@ -23,6 +27,8 @@ public:
         bool isRoot;
         bool isBone;
         glm::mat4 transformation = glm::mat4(1.0f);
+        AABB worldBounds;   // this node's own mesh
+        AABB subtreeBounds; // this node and all of its descendants
         yyjson_val* extensions = nullptr;
         yyjson_val* extras = nullptr;
     };
@@ -37,9 +43,33 @@ public:
     std::vector<int> getRootNodes() const;
     std::vector<int> getChildNodes(int nodeIndex) const;
     void calculateGlobalTransforms();
-    void calculateGlobalTransform(size_t nodeIndex, const glm::mat4& parentTransform, std::vector<glm::mat4>& globalTransforms);
     const glm::mat4& getGlobalTransform(size_t nodeIndex) const;
+    const glm::mat4& getLocalTransform(size_t nodeIndex) const;
     void updateNodeTransformation(Node& node);
+    // Linear pass over the flattened hierarchy: local matrices from TRS, then world = parent world * local.
+    // Parents come first, so every parent is final before its children read it. Only nodes whose TRS was
+    // set since the last pass, and their descendants, are recomputed; static subtrees are skipped whole.
+    void updateGlobalTransforms();
+    // Nodes targeted by animation channels. All others are static: their matrices are computed once at load
+    // and cached. Setting a static node's TRS later makes it dynamic.
+    void setAnimatedNodes(const std::vector<int>& nodeIndices);
+    bool isStatic(int nodeIndex) const;
+    // Whether the world matrix changed in the most recent pass (every node after a full rebuild)
+    bool hasWorldChanged(size_t nodeIndex) const;
+    size_t getLastUpdateCount() const;
+    // Flat positions of the nodes whose world matrix changed in the most recent pass
+    const std::vector<int>& getChangedNodes() const;
+
+    // Flattened hierarchy in depth-first order: position -> node index. A subtree is a contiguous range.
+    const std::vector<int>& getTopologicalOrder() const;
+    int getFlatIndex(int nodeIndex) const;
+
+    // localBounds holds each node's geometry in its own space (empty boxes for nodes without a mesh).
+    // Uses the current global transforms, so call updateGlobalTransforms first after animating.
+    void propagateBounds(const std::vector<AABB>& localBounds);
+    // Incremental propagateBounds: recomputes the world bounds of nodeIndices only and refits the subtree
+    // bounds along their paths to the root. Every other node must still be current.
+    void refitBounds(const std::vector<AABB>& localBounds, const std::vector<int>& nodeIndices);
 
     // New getter and setter methods
     glm::vec3 getNodeTranslation(int nodeIndex) const;
@@ -48,12 +78,43 @@ public:
     void setNodeRotation(int nodeIndex, const glm::quat& rotation);
     glm::vec3 getNodeScale(int nodeIndex) const;
     void setNodeScale(int nodeIndex, const glm::vec3& scale);
+    // By flat position, for animation bindings: write only the transform arrays and leave the Node's TRS
+    // fields as they were. The getters above read the arrays, so they always see the current values.
+    void setFlatTranslation(int flat, const glm::vec3& translation);
+    void setFlatRotation(int flat, const glm::quat& rotation);
+    void setFlatScale(int flat, const glm::vec3& scale);
 
 private:
     std::vector<Node> nodes;
-    std::vector<glm::mat4> globalTransforms;
+
+    // Hot transform data as structure of arrays in topological order. The by-node TRS setters write these
+    // and mirror the values into Node; the flat setters used by animation write only these.
+    std::vector<int> order;        // flat position -> node index
+    std::vector<int> nodeToFlat;   // node index -> flat position
+    std::vector<int> flatParents;  // flat position of the parent, -1 for roots
+    std::vector<glm::vec3> translations;
+    std::vector<glm::quat> rotations;
+    std::vector<glm::vec3> scales;
+    std::vector<glm::mat4> localMatrices;
+    std::vector<glm::mat4> worldMatrices;
+    std::vector<int> subtreeEnds;       // flat position one past the node's subtree
+
+    // Incremental update state, all by flat position
+    std::vector<char> dynamicNodes;     // TRS may change after load
+    std::vector<char> affectedNodes;    // a dynamic node in the subtree or above it; others never move
+    std::vector<char> localDirty;
+    std::vector<int> dirtyNodes;        // localDirty entries, in the order they were set
+    std::vector<char> worldChanged;
+    std::vector<int> changedNodes;      // worldChanged entries to clear before the next pass
+    size_t firstDirty = SIZE_MAX;
+    std::vector<char> boundsDirty;      // refitBounds scratch
+    std::vector<int> boundsPath;
+
+    void buildHierarchy();
+    void computeAllTransforms();
+    void markDirty(int flat);
+    void markDynamic(int flat);
     void printNodeInfo(const Node& node, size_t index) const;
-    void updateGlobalTransforms();
     bool showDebug = false;
 };
 
@@ -0,0 +1,223 @@
+#include "GLTFQuantizedCurve.h"
+#include "GLTFSimd.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const float kMaxComponent = 0.70710678f; // no component but the largest can exceed 1/sqrt(2)
+    const float kRotationScale = 32767.0f;
+
+    inline uint16_t quantizeUnit(float value, float scale) {
+        return static_cast<uint16_t>(std::lround(glm::clamp(value, 0.0f, 1.0f) * scale));
+    }
+
+    // Rebuilds a rotation from its three stored components in [-1/sqrt(2), 1/sqrt(2)] and the index of the
+    // dropped one, which was made non-negative when encoding
+    inline glm::quat assembleRotation(const float* c, int dropped) {
+        float rebuilt = std::sqrt(std::max(0.0f, 1.0f - c[0] * c[0] - c[1] * c[1] - c[2] * c[2]));
+        switch (dropped) {
+        case 0: return glm::quat(c[2], rebuilt, c[0], c[1]);
+        case 1: return glm::quat(c[2], c[0], rebuilt, c[1]);
+        case 2: return glm::quat(c[2], c[0], c[1], rebuilt);
+        default: return glm::quat(rebuilt, c[0], c[1], c[2]);
+        }
+    }
+}
+
+bool GLTFQuantizedCurve::buildFrames(const std::vector<float>& times, float rate) {
+    clear();
+    if (times.empty() || rate <= 0.0f) return false;
+    framesPerSecond = rate;
+    frames.reserve(times.size());
+    for (float time : times) {
+        float frame = std::round(time * rate);
+        if (frame < 0.0f || frame > 65535.0f) return false;
+        if (!frames.empty() && frame <= frames.back()) return false;
+        frames.push_back(static_cast<uint16_t>(frame));
+    }
+    return true;
+}
+
+bool GLTFQuantizedCurve::buildVec3(const std::vector<float>& times, const std::vector<glm::vec3>& values, float rate) {
+    if (values.size() != times.size() || !buildFrames(times, rate)) {
+        clear();
+        return false;
+    }
+
+    glm::vec3 rangeMax = values[0];
+    rangeMin = values[0];
+    for (const auto& value : values) {
+        rangeMin = glm::min(rangeMin, value);
+        rangeMax = glm::max(rangeMax, value);
+    }
+    glm::vec3 range = rangeMax - rangeMin;
+    rangeScale = range / 65535.0f;
+
+    data.reserve(values.size() * 3 + 1);
+    for (const auto& value : values) {
+        for (int c = 0; c < 3; ++c) {
+            data.push_back(range[c] > 0.0f ? quantizeUnit((value[c] - rangeMin[c]) / range[c], 65535.0f) : 0);
+        }
+    }
+    padKeys();
+    return true;
+}
+
+bool GLTFQuantizedCurve::buildRotation(const std::vector<float>& times, const std::vector<glm::quat>& values, float rate) {
+    if (values.size() != times.size() || !buildFrames(times, rate)) {
+        clear();
+        return false;
+    }
+
+    data.reserve(values.size() * 3 + 1);
+    for (const auto& value : values) {
+        glm::quat normalized = glm::normalize(value);
+        float q[4] = { normalized.x, normalized.y, normalized.z, normalized.w };
+        int largest = 0;
+        for (int i = 1; i < 4; ++i) {
+            if (std::abs(q[i]) > std::abs(q[largest])) largest = i;
+        }
+        // q and -q are the same rotation, so the dropped component can always be rebuilt as positive
+        float sign = q[largest] < 0.0f ? -1.0f : 1.0f;
+        uint16_t stored[3];
+        for (int i = 0, c = 0; i < 4; ++i) {
+            if (i == largest) continue;
+            stored[c++] = quantizeUnit((q[i] * sign / kMaxComponent) * 0.5f + 0.5f, kRotationScale);
+        }
+        // Two bits of index in the top bits of the first two values
+        data.push_back(static_cast<uint16_t>(stored[0] | ((largest & 1) << 15)));
+        data.push_back(static_cast<uint16_t>(stored[1] | ((largest >> 1) << 15)));
+        data.push_back(stored[2]);
+    }
+    padKeys();
+    return true;
+}
+
+void GLTFQuantizedCurve::padKeys() {
+    // Keys are decoded in pairs: a lone key is stored twice, and the last key gets the spare u16 that the
+    // 64-bit load reads past it
+    if (frames.size() == 1) data.insert(data.end(), data.begin(), data.begin() + 3);
+    data.push_back(0);
+}
+
+void GLTFQuantizedCurve::clear() {
+    frames.clear();
+    data.clear();
+    framesPerSecond = 0.0f;
+    rangeMin = glm::vec3(0.0f);
+    rangeScale = glm::vec3(0.0f);
+}
+
+bool GLTFQuantizedCurve::isEmpty() const {
+    return frames.empty();
+}
+
+size_t GLTFQuantizedCurve::getKeyCount() const {
+    return frames.size();
+}
+
+size_t GLTFQuantizedCurve::getMemoryUsage() const {
+    return frames.size() * sizeof(uint16_t) + data.size() * sizeof(uint16_t);
+}
+
+size_t GLTFQuantizedCurve::findKey(float frame, size_t& cursor) const {
+    // The cursor scheme of GLTFAnimation::findKey, on integer frames
+    const size_t last = frames.size() - 2;
+    size_t key = cursor <= last ? cursor : last;
+    if (frames[key] <= frame) {
+        if (frame < frames[key + 1]) return cursor = key;
+        if (key < last && frame < frames[key + 2]) return cursor = key + 1;
+        auto upper = std::upper_bound(frames.begin() + key + 1, frames.end(), frame,
+            [](float value, uint16_t element) { return value < element; });
+        key = static_cast<size_t>(upper - frames.begin()) - 1;
+    }
+    else {
+        auto upper = std::upper_bound(frames.begin(), frames.begin() + key, frame,
+            [](float value, uint16_t element) { return value < element; });
+        key = upper == frames.begin() ? 0 : static_cast<size_t>(upper - frames.begin()) - 1;
+    }
+    return cursor = std::min(key, last);
+}
+
+void GLTFQuantizedCurve::decodeVec3Pair(size_t key, glm::vec3& a, glm::vec3& b) const {
+    const uint16_t* raw = &data[key * 3];
+#if defined(GLTF_SIMD_X86)
+    // One 64-bit load per key widens four u16 to floats; the fourth lane (next key or padding) is ignored
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 scale = _mm_setr_ps(rangeScale.x, rangeScale.y, rangeScale.z, 0.0f);
+    const __m128 offset = _mm_setr_ps(rangeMin.x, rangeMin.y, rangeMin.z, 0.0f);
+    __m128 first = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(raw)), zero));
+    __m128 second = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(raw + 3)), zero));
+    alignas(16) float out[8];
+    _mm_store_ps(out, _mm_add_ps(_mm_mul_ps(first, scale), offset));
+    _mm_store_ps(out + 4, _mm_add_ps(_mm_mul_ps(second, scale), offset));
+    a = glm::vec3(out[0], out[1], out[2]);
+    b = glm::vec3(out[4], out[5], out[6]);
+#else
+    a = rangeMin + glm::vec3(raw[0], raw[1], raw[2]) * rangeScale;
+    b = rangeMin + glm::vec3(raw[3], raw[4], raw[5]) * rangeScale;
+#endif
+}
+
+void GLTFQuantizedCurve::decodeRotationPair(size_t key, glm::quat& a, glm::quat& b) const {
+    const uint16_t* raw = &data[key * 3];
+    alignas(16) float out[8];
+#if defined(GLTF_SIMD_X86)
+    // Mask off the index bits, widen and map [0, 32767] back to [-1/sqrt(2), 1/sqrt(2)] for both keys
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mask = _mm_set1_epi32(0x7FFF);
+    const __m128 scale = _mm_set1_ps(2.0f * kMaxComponent / kRotationScale);
+    const __m128 offset = _mm_set1_ps(-kMaxComponent);
+    __m128i first = _mm_and_si128(_mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(raw)), zero), mask);
+    __m128i second = _mm_and_si128(_mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(raw + 3)), zero), mask);
+    _mm_store_ps(out, _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(first), scale), offset));
+    _mm_store_ps(out + 4, _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(second), scale), offset));
+#else
+    for (int i = 0; i < 3; ++i) {
+        out[i] = (raw[i] & 0x7FFF) * (2.0f * kMaxComponent / kRotationScale) - kMaxComponent;
+        out[4 + i] = (raw[3 + i] & 0x7FFF) * (2.0f * kMaxComponent / kRotationScale) - kMaxComponent;
+    }
+#endif
+    a = assembleRotation(out, (raw[0] >> 15) | ((raw[1] >> 15) << 1));
+    b = assembleRotation(out + 4, (raw[3] >> 15) | ((raw[4] >> 15) << 1));
+}
+
+glm::vec3 GLTFQuantizedCurve::sampleVec3(float time, size_t& cursor) const {
+    if (frames.empty()) return glm::vec3(0.0f);
+
+    glm::vec3 a, b;
+    float frame = time * framesPerSecond;
+    if (frames.size() == 1 || frame <= frames.front()) {
+        decodeVec3Pair(0, a, b);
+        return a;
+    }
+    if (frame >= frames.back()) {
+        decodeVec3Pair(frames.size() - 2, a, b);
+        return b;
+    }
+
+    size_t key = findKey(frame, cursor);
+    decodeVec3Pair(key, a, b);
+    float t = (frame - frames[key]) / static_cast<float>(frames[key + 1] - frames[key]);
+    return glm::mix(a, b, t);
+}
+
+glm::quat GLTFQuantizedCurve::sampleRotation(float time, size_t& cursor) const {
+    if (frames.empty()) return glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+
+    glm::quat a, b;
+    float frame = time * framesPerSecond;
+    if (frames.size() == 1 || frame <= frames.front()) {
+        decodeRotationPair(0, a, b);
+        return a;
+    }
+    if (frame >= frames.back()) {
+        decodeRotationPair(frames.size() - 2, a, b);
+        return b;
+    }
+
+    size_t key = findKey(frame, cursor);
+    decodeRotationPair(key, a, b);
+    float t = (frame - frames[key]) / static_cast<float>(frames[key + 1] - frames[key]);
+    return glm::slerp(a, b, t);
+}
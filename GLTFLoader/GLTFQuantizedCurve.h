@@ -0,0 +1,44 @@
+#ifndef GLTF_QUANTIZED_CURVE_H
+#define GLTF_QUANTIZED_CURVE_H
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// A LINEAR animation track stored in 8 bytes per key: the time as a 16-bit frame index, and either a
+// vec3 as three 16-bit values over the track's own range or a rotation in 48-bit smallest-three form
+// (the three smallest components at 15 bits, plus which one was dropped). Keys are decoded on the fly
+// when sampled, two at a time with SSE where available.
+class GLTFQuantizedCurve {
+public:
+    // Both return false, leaving the curve empty, when the track cannot be represented: too long for
+    // 16-bit frames at framesPerSecond, or two keys rounding to the same frame
+    bool buildVec3(const std::vector<float>& times, const std::vector<glm::vec3>& values, float framesPerSecond);
+    bool buildRotation(const std::vector<float>& times, const std::vector<glm::quat>& values, float framesPerSecond);
+    void clear();
+    bool isEmpty() const;
+
+    // Same clamping and interpolation as the float tracks: mix for vectors, slerp for rotations.
+    // cursor caches the last key segment, like GLTFAnimation's key lookup.
+    glm::vec3 sampleVec3(float time, size_t& cursor) const;
+    glm::quat sampleRotation(float time, size_t& cursor) const;
+
+    size_t getKeyCount() const;
+    size_t getMemoryUsage() const; // bytes of key data
+
+private:
+    std::vector<uint16_t> frames;
+    std::vector<uint16_t> data; // three per key, padded so every key can be decoded as part of a pair
+    float framesPerSecond = 0.0f;
+    glm::vec3 rangeMin = glm::vec3(0.0f);
+    glm::vec3 rangeScale = glm::vec3(0.0f); // range / 65535
+
+    bool buildFrames(const std::vector<float>& times, float framesPerSecond);
+    void padKeys();
+    size_t findKey(float frame, size_t& cursor) const;
+    void decodeVec3Pair(size_t key, glm::vec3& a, glm::vec3& b) const;
+    void decodeRotationPair(size_t key, glm::quat& a, glm::quat& b) const;
+};
+
+#endif // GLTF_QUANTIZED_CURVE_H
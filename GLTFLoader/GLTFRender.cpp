@@ -44,47 +44,25 @@ glm::mat4 GLTFLoader::getNodeTransform(const GLTFNode::Node& node) const {
 }
 
 glm::mat4 GLTFLoader::getNodeHierarchyTransform(int nodeIndex) const {
-    glm::mat4 transform = glm::mat4(1.0f);
-    auto& nodes = nodeManager.getNodes();
-    int currentIndex = nodeIndex;
-    std::unordered_set<int> visitedNodes;
-
-    while (currentIndex >= 0) {
-        if (visitedNodes.find(currentIndex) != visitedNodes.end()) {
-            std::cerr << "Cycle or repeated node detected at index: " << currentIndex << std::endl;
-            break;
-        }
-
-        visitedNodes.insert(currentIndex);  // Mark this node as visited
-
-        const auto& node = nodes[currentIndex];
-        transform = getNodeTransform(node) * transform; //model disappears
-
-        int parentIndex = -1;
-        for (size_t i = 0; i < nodes.size(); ++i) {
-            for (int child : nodes[i].children) {
-                if (child == currentIndex) {
-                    parentIndex = static_cast<int>(i);
-                    break;
-                }
-            }
-            if (parentIndex >= 0) {
-                break;
-            }
-        }
+    // Maintained by the node manager's world-transform pass
+    if (nodeIndex < 0 || nodeIndex >= static_cast<int>(nodeManager.getNodes().size())) return glm::mat4(1.0f);
+    return nodeManager.getGlobalTransform(nodeIndex);
+}
 
+const GLTFNode& GLTFLoader::getNodeManager() const {
+    return nodeManager;
+}
 
-        if (parentIndex >= 0) {
-        }
-        else {
-            std::cout << "Root Node Found: " << currentIndex << std::endl;
-            std::cout << "Root Node Name: " << node.name << std::endl;
-        }
+const GLTFSkeleton& GLTFLoader::getSkeleton() const {
+    return skeleton;
+}
 
-        currentIndex = parentIndex;
-    }
+const GLTFAnimation& GLTFLoader::getAnimationManager() const {
+    return animationManager;
+}
 
-    return transform;
+const GLTFAnimation::Pose& GLTFLoader::getRestPose() const {
+    return restPose;
 }
 
 void GLTFLoader::initializeTextures() {
@@ -146,13 +124,16 @@ void GLTFLoader::initBuffers() {
             const auto& mesh = meshes[node.meshIndex];
             glm::mat4 nodeTransform = getNodeHierarchyTransform(static_cast<int>(i));
 
-            for (const auto& primitive : mesh.primitives) {
+            for (size_t primitiveIndex = 0; primitiveIndex < mesh.primitives.size(); ++primitiveIndex) {
+                const auto& primitive = mesh.primitives[primitiveIndex];
                 if (primitive.positionAccessor >= 0) {
                     PrimitiveBuffers buffers;
-                    setupVertexArrayObject(buffers, primitive, node.meshIndex);
+                    setupVertexArrayObject(buffers, primitive, node.meshIndex, static_cast<int>(primitiveIndex));
                     buffers.transform = nodeTransform;
+                    buffers.nodeIndex = static_cast<int>(i);
                     buffers.materialIndex = primitive.materialIndex;
                     primitiveBuffers.push_back(buffers);
+                    updateMorphTargets(primitiveBuffers.back(), animationBlender.getPose());
 
                     // Debug output to verify buffers are correctly set up
                     std::cout << "Initialized buffers for node index " << i << " with mesh index " << node.meshIndex << std::endl;
@@ -170,12 +151,56 @@ void GLTFLoader::initBuffers() {
 }
 
 
+void GLTFLoader::setLodPixelError(float pixels) {
+    lodPixelError = pixels;
+}
+
+void GLTFLoader::setClusterCulling(bool enabled) {
+    clusterCulling = enabled;
+}
+
+void GLTFLoader::setFrustumCulling(bool enabled) {
+    frustumCulling = enabled;
+}
+
+const GLTFFrustumCuller::Stats& GLTFLoader::getCullStats() const {
+    return cullStats;
+}
+
+const GLTFLoader::LodRange& GLTFLoader::selectLod(const PrimitiveBuffers& buffers, const glm::mat4& modelView, float projectionScale) const {
+    // Project each level's error at the depth of the primitive's origin and take the coarsest one that stays
+    // under the pixel budget. Errors grow with the level, so the first failure ends the search.
+    const LodRange* selected = &buffers.lodRanges[0];
+    float depth = -modelView[3].z;
+    if (depth <= 0.0f) return *selected;
+
+    float scale = glm::max(glm::length(glm::vec3(modelView[0])), glm::max(glm::length(glm::vec3(modelView[1])), glm::length(glm::vec3(modelView[2]))));
+    for (size_t i = 1; i < buffers.lodRanges.size(); ++i) {
+        float pixels = buffers.lodRanges[i].error * scale / depth * projectionScale;
+        if (pixels > lodPixelError) break;
+        selected = &buffers.lodRanges[i];
+    }
+    return *selected;
+}
+
 void GLTFLoader::render() {
+    const size_t nodeCount = nodeManager.getNodes().size();
+    ownNodeWorlds.resize(nodeCount);
+    for (size_t i = 0; i < nodeCount; ++i) ownNodeWorlds[i] = nodeManager.getGlobalTransform(i);
+    renderPose(ownNodeWorlds, skeleton.getJointMatrices(), glm::mat4(1.0f));
+}
+
+void GLTFLoader::renderPose(const std::vector<glm::mat4>& nodeWorlds, std::span<const glm::mat4> jointMatrices, const glm::mat4& modelTransform) {
     glUseProgram(shaderProgram);
 
     glm::mat4 viewMatrix = Camera.getViewMatrix();
     glm::mat4 projectionMatrix = Camera.getProjectionMatrix();
 
+    // Pixels per model unit at distance 1, for converting LOD errors to screen space
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    float projectionScale = projectionMatrix[1][1] * viewport[3] * 0.5f;
+
     GLuint modelLoc = glGetUniformLocation(shaderProgram, "model");
     GLuint viewLoc = glGetUniformLocation(shaderProgram, "view");
     GLuint projLoc = glGetUniformLocation(shaderProgram, "projection");
@@ -185,23 +210,64 @@ void GLTFLoader::render() {
     glUniformMatrix4fv(viewLoc, 1, GL_FALSE, &viewMatrix[0][0]);
     glUniformMatrix4fv(projLoc, 1, GL_FALSE, &projectionMatrix[0][0]);
 
-
-    const auto jointMatrices = skeleton.getJointMatrices();
-
     if (!jointMatrices.empty()) {
         //glUniformMatrix4fv(boneTransformsLoc, boneTransforms.size(), GL_FALSE, &boneTransforms[0][0][0]);
         glUniformMatrix4fv(jointMatricesLoc, jointMatrices.size(), GL_FALSE, &jointMatrices[0][0][0]);
     }
 
-    for (const auto& buffers : primitiveBuffers) {
+    // World boxes for every draw item, then one SIMD pass over all of them for the visible list
+    if (frustumCuller.size() != primitiveBuffers.size()) {
+        frustumCuller.resize(primitiveBuffers.size());
+    }
+    drawTransforms.resize(primitiveBuffers.size());
+    for (size_t i = 0; i < primitiveBuffers.size(); ++i) {
+        const auto& buffers = primitiveBuffers[i];
+        drawTransforms[i] = modelTransform * nodeWorlds[buffers.nodeIndex]; // follows animated nodes
+        AABB bounds = GLTFMesh::getSkinnedBounds(buffers.bounds, buffers.jointBounds, jointMatrices);
+        frustumCuller.setBox(i, bounds.transformed(drawTransforms[i]));
+    }
+
+    if (frustumCulling) {
+        frustumCuller.cull(GLTFFrustumCuller::extractFrustum(projectionMatrix * viewMatrix), visibleDrawItems);
+    }
+    else {
+        visibleDrawItems.resize(primitiveBuffers.size());
+        for (size_t i = 0; i < primitiveBuffers.size(); ++i) visibleDrawItems[i] = static_cast<unsigned int>(i);
+    }
+    cullStats.submitted = visibleDrawItems.size();
+    cullStats.culled = primitiveBuffers.size() - visibleDrawItems.size();
+
+    for (unsigned int drawItem : visibleDrawItems) {
+        const auto& buffers = primitiveBuffers[drawItem];
+        if (buffers.lodRanges.empty()) continue; // setup failed, nothing was uploaded
         glBindVertexArray(buffers.vao);
 
-        glm::mat4 modelMatrix = buffers.transform;
+        glm::mat4 modelMatrix = drawTransforms[drawItem];
         glUniformMatrix4fv(modelLoc, 1, GL_FALSE, &modelMatrix[0][0]);
 
+        const LodRange& lod = selectLod(buffers, viewMatrix * modelMatrix, projectionScale);
+
         // Uncomment the line below to render in wireframe mode for better visualization
         glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-        glDrawElements(GL_TRIANGLES, buffers.indexCount, GL_UNSIGNED_INT, 0);
+        if (clusterCulling && lod.firstIndex == 0 && !buffers.meshlets.empty()) {
+            // Only the meshlets that survive frustum and cone culling are submitted, as merged index ranges
+            glm::mat4 modelView = viewMatrix * modelMatrix;
+            glm::vec3 cameraPosition = glm::vec3(glm::inverse(modelView)[3]);
+            GLTFMeshlets::cull(buffers.meshlets, buffers.meshletJoints, projectionMatrix * modelView, cameraPosition, jointMatrices, visibleRanges);
+
+            drawCounts.clear();
+            drawOffsets.clear();
+            for (const auto& range : visibleRanges) {
+                drawCounts.push_back(static_cast<GLsizei>(range.indexCount));
+                drawOffsets.push_back((const void*)(range.firstIndex * sizeof(unsigned int)));
+            }
+            if (!drawCounts.empty()) {
+                glMultiDrawElements(GL_TRIANGLES, drawCounts.data(), GL_UNSIGNED_INT, drawOffsets.data(), static_cast<GLsizei>(drawCounts.size()));
+            }
+        }
+        else {
+            glDrawElements(GL_TRIANGLES, lod.indexCount, GL_UNSIGNED_INT, (void*)(lod.firstIndex * sizeof(unsigned int)));
+        }
         glBindVertexArray(0);
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
     }
@@ -211,7 +277,8 @@ void GLTFLoader::render() {
         glLoadMatrixf(&projectionMatrix[0][0]);
 
         glMatrixMode(GL_MODELVIEW);
-        glLoadMatrixf(&viewMatrix[0][0]);
+        glm::mat4 jointModelView = viewMatrix * modelTransform;
+        glLoadMatrixf(&jointModelView[0][0]);
 
         glEnable(GL_POINT_SMOOTH);
         glPointSize(10.0f);
@@ -231,21 +298,26 @@ void GLTFLoader::render() {
 
 
 
-void GLTFLoader::setupVertexArrayObject(PrimitiveBuffers& buffers, const GLTFMesh::Primitive& primitive, int meshIndex) {
-    const auto& verticesMap = skeleton.getVertices();
-    if (verticesMap.find(meshIndex) == verticesMap.end()) {
+void GLTFLoader::setupVertexArrayObject(PrimitiveBuffers& buffers, const GLTFMesh::Primitive& primitive, int meshIndex, int primitiveIndex) {
+    const auto& geometryMap = skeleton.getPrimitiveGeometry();
+    if (geometryMap.find(meshIndex) == geometryMap.end() || primitiveIndex < 0
+        || static_cast<size_t>(primitiveIndex) >= geometryMap.at(meshIndex).size()) {
         std::cerr << "Mesh index " << meshIndex << " not found in vertices map." << std::endl;
         return;
     }
-    checkVerts(primitive, meshIndex);
-    const auto& vertices = verticesMap.at(meshIndex);
+    checkVerts(primitive, meshIndex, primitiveIndex);
+    const auto& geometry = geometryMap.at(meshIndex)[primitiveIndex];
+    const auto& vertices = geometry.vertices;
 
     glGenVertexArrays(1, &buffers.vao);
     glBindVertexArray(buffers.vao);
 
+    // Morphed primitives are re-blended on the CPU and streamed whenever their weights change
+    const bool morphed = !geometry.morphTargets.empty();
+    if (morphed) buffers.morphTargets.initialize(vertices, geometry.morphTargets);
     glGenBuffers(1, &buffers.vboPositions);
     glBindBuffer(GL_ARRAY_BUFFER, buffers.vboPositions);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), morphed ? GL_STREAM_DRAW : GL_STATIC_DRAW);
 
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
     glEnableVertexAttribArray(0);
@@ -262,12 +334,24 @@ void GLTFLoader::setupVertexArrayObject(PrimitiveBuffers& buffers, const GLTFMes
     glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, weights));
     glEnableVertexAttribArray(4);
 
-    if (primitive.indicesAccessor >= 0) {
-        const auto& indices = bufferManager.getIndices(accessorManager.getAccessors()[primitive.indicesAccessor]);
+    if (!geometry.indices.empty()) {
+        // Index data comes from the import stages, not straight from the accessor. The LOD chain is
+        // appended after the full-detail indices in the same element buffer.
+        std::vector<unsigned int> indices = geometry.indices;
+        buffers.lodRanges.push_back({ 0, indices.size(), 0.0f });
+        for (const auto& lod : geometry.lods) {
+            buffers.lodRanges.push_back({ indices.size(), lod.indices.size(), lod.error });
+            indices.insert(indices.end(), lod.indices.begin(), lod.indices.end());
+        }
+
         glGenBuffers(1, &buffers.eboIndices);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.eboIndices);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-        buffers.indexCount = static_cast<GLsizei>(indices.size());
+        buffers.indexCount = static_cast<GLsizei>(geometry.indices.size());
+        buffers.meshlets = geometry.meshlets;
+        buffers.meshletJoints = geometry.meshletJoints;
+        buffers.bounds = geometry.bounds;
+        buffers.jointBounds = geometry.jointBounds;
     }
 
     glBindVertexArray(0);
@@ -276,15 +360,17 @@ void GLTFLoader::setupVertexArrayObject(PrimitiveBuffers& buffers, const GLTFMes
 
 
 
-void GLTFLoader::checkVerts(const GLTFMesh::Primitive& primitive, int meshIndex) {
-    const auto& verticesMap = skeleton.getVertices();
+void GLTFLoader::checkVerts(const GLTFMesh::Primitive& primitive, int meshIndex, int primitiveIndex) {
+    const auto& geometryMap = skeleton.getPrimitiveGeometry();
 
-    if (verticesMap.find(meshIndex) == verticesMap.end()) {
+    if (geometryMap.find(meshIndex) == geometryMap.end() || primitiveIndex < 0
+        || static_cast<size_t>(primitiveIndex) >= geometryMap.at(meshIndex).size()) {
         std::cerr << "Mesh index " << meshIndex << " not found in vertices map." << std::endl;
         return;
     }
 
-    const auto& verticesFromSkeleton = verticesMap.at(meshIndex);
+    // Note: the import stages may reorder vertices, so index-by-index comparison only holds with them disabled
+    const auto& verticesFromSkeleton = geometryMap.at(meshIndex)[primitiveIndex].vertices;
 
     // Print Buffer Manager Vertices
     const auto& positions = bufferManager.getPositions(accessorManager.getAccessors()[primitive.positionAccessor]);
@@ -344,9 +430,66 @@ void GLTFLoader::checkVerts(const GLTFMesh::Primitive& primitive, int meshIndex)
 
 
 void GLTFLoader::setAnimation(const std::string& animationName) {
-    animationManager.setAnimation(animationName);
+    std::cout << "Setting the model's animation to " << animationName << std::endl;
+    animationBlender.crossfadeTo(animationManager.findAnimation(animationName), 0.0f);
+}
+
+void GLTFLoader::crossfadeAnimation(const std::string& animationName, float fadeTime) {
+    animationBlender.crossfadeTo(animationManager.findAnimation(animationName), fadeTime);
+}
+
+GLTFAnimationBlender& GLTFLoader::getAnimationBlender() {
+    return animationBlender;
 }
 
 void GLTFLoader::updateAnimation(float deltaTime) {
-    animationManager.updateAnimation(deltaTime, nodeManager, skeleton, meshManager);
+    animationBlender.update(deltaTime);
+
+    // Only nodes some clip animates; the rest keep their cached static transforms. The node manager takes
+    // flat positions, resolved at load.
+    const GLTFAnimation::Pose& pose = animationBlender.getPose();
+    for (const auto& [node, flat] : animatedSlots) {
+        nodeManager.setFlatTranslation(flat, pose.translations[node]);
+        nodeManager.setFlatRotation(flat, pose.rotations[node]);
+        nodeManager.setFlatScale(flat, pose.scales[node]);
+    }
+
+    // One world-transform pass for the whole hierarchy; skinning and rendering both read from it
+    nodeManager.updateGlobalTransforms();
+    skeleton.updateSkeleton(nodeManager.getNodes());
+    for (auto& buffers : primitiveBuffers) updateMorphTargets(buffers, pose);
+    updateSceneBounds();
+    raycastPoseDirty = true;
+}
+
+void GLTFLoader::updateMorphTargets(PrimitiveBuffers& buffers, const GLTFAnimation::Pose& pose) {
+    if (buffers.morphTargets.isEmpty() || buffers.nodeIndex < 0) return;
+    const auto& offsets = pose.morphWeightOffsets;
+    if (offsets.size() <= static_cast<size_t>(buffers.nodeIndex) + 1) return;
+
+    const unsigned int first = offsets[buffers.nodeIndex];
+    if (!buffers.morphTargets.apply(pose.morphWeights.data() + first, offsets[buffers.nodeIndex + 1] - first)) return;
+
+    // Orphaning the old storage lets the driver hand out fresh memory instead of waiting on draws that
+    // still read the previous frame's vertices
+    const auto& vertices = buffers.morphTargets.getVertices();
+    const GLsizeiptr size = static_cast<GLsizeiptr>(vertices.size() * sizeof(Vertex));
+    glBindBuffer(GL_ARRAY_BUFFER, buffers.vboPositions);
+    glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, size, vertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+bool GLTFLoader::pick(float windowX, float windowY, RayHit& hit) {
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glm::vec4 viewportRect(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+    // Window coordinates start at the top left, OpenGL's at the bottom left
+    float glY = static_cast<float>(viewport[1] + viewport[3]) - windowY;
+    glm::mat4 viewMatrix = Camera.getViewMatrix();
+    glm::mat4 projectionMatrix = Camera.getProjectionMatrix();
+    glm::vec3 nearPoint = glm::unProject(glm::vec3(windowX, glY, 0.0f), viewMatrix, projectionMatrix, viewportRect);
+    glm::vec3 farPoint = glm::unProject(glm::vec3(windowX, glY, 1.0f), viewMatrix, projectionMatrix, viewportRect);
+    return raycast(nearPoint, farPoint - nearPoint, hit, glm::length(farPoint - nearPoint));
 }
\ No newline at end of file
@@ -0,0 +1,232 @@
+#include "GLTFSceneBVH.h"
+#include <algorithm>
+#include <functional>
+#include <iostream>
+
+namespace {
+    const int kSahBins = 12;
+    thread_local std::vector<int> traversalStack; // reused by every query on the thread
+}
+
+void GLTFSceneBVH::build(const std::vector<AABB>& itemBounds) {
+    clear();
+    itemLeaves.assign(itemBounds.size(), -1);
+
+    std::vector<int> items;
+    for (size_t i = 0; i < itemBounds.size(); ++i) {
+        if (!itemBounds[i].isEmpty()) items.push_back(static_cast<int>(i));
+    }
+    if (items.empty()) return;
+
+    nodes.reserve(items.size() * 2 - 1);
+    buildRecursive(items, 0, items.size(), itemBounds, -1);
+    dirtyFlags.assign(nodes.size(), 0);
+}
+
+void GLTFSceneBVH::clear() {
+    nodes.clear();
+    itemLeaves.clear();
+    dirtyNodes.clear();
+    dirtyFlags.clear();
+}
+
+bool GLTFSceneBVH::isEmpty() const {
+    return nodes.empty();
+}
+
+int GLTFSceneBVH::buildRecursive(std::vector<int>& items, size_t begin, size_t end, const std::vector<AABB>& itemBounds, int parent) {
+    int nodeIndex = static_cast<int>(nodes.size());
+    nodes.push_back(Node());
+    nodes[nodeIndex].parent = parent;
+    for (size_t i = begin; i < end; ++i) {
+        nodes[nodeIndex].bounds.merge(itemBounds[items[i]]);
+    }
+
+    if (end - begin == 1) {
+        nodes[nodeIndex].item = items[begin];
+        itemLeaves[items[begin]] = nodeIndex;
+        return nodeIndex;
+    }
+
+    size_t mid = partitionSAH(items, begin, end, itemBounds);
+    int left = buildRecursive(items, begin, mid, itemBounds, nodeIndex);
+    int right = buildRecursive(items, mid, end, itemBounds, nodeIndex);
+    nodes[nodeIndex].left = left;
+    nodes[nodeIndex].right = right;
+    return nodeIndex;
+}
+
+size_t GLTFSceneBVH::partitionSAH(std::vector<int>& items, size_t begin, size_t end, const std::vector<AABB>& itemBounds) const {
+    AABB centroidBounds;
+    for (size_t i = begin; i < end; ++i) {
+        centroidBounds.expand(itemBounds[items[i]].center());
+    }
+
+    glm::vec3 extent = centroidBounds.size();
+    int axis = 0;
+    if (extent.y > extent[axis]) axis = 1;
+    if (extent.z > extent[axis]) axis = 2;
+
+    size_t mid = begin + (end - begin) / 2;
+    if (extent[axis] <= 0.0f) {
+        return mid; // all centroids coincide, any split is as good as another
+    }
+
+    // Bin centroids along the widest axis and pick the split with the lowest surface area cost
+    auto binOf = [&](int item) {
+        float t = (itemBounds[item].center()[axis] - centroidBounds.min[axis]) / extent[axis];
+        int bin = static_cast<int>(t * kSahBins);
+        return bin < 0 ? 0 : (bin >= kSahBins ? kSahBins - 1 : bin);
+    };
+
+    AABB binBounds[kSahBins];
+    size_t binCounts[kSahBins] = {};
+    for (size_t i = begin; i < end; ++i) {
+        int bin = binOf(items[i]);
+        binBounds[bin].merge(itemBounds[items[i]]);
+        binCounts[bin]++;
+    }
+
+    float rightCost[kSahBins] = {};
+    AABB accumulated;
+    size_t count = 0;
+    for (int bin = kSahBins - 1; bin > 0; --bin) {
+        accumulated.merge(binBounds[bin]);
+        count += binCounts[bin];
+        rightCost[bin] = accumulated.surfaceArea() * count;
+    }
+
+    float bestCost = FLT_MAX;
+    int bestSplit = -1;
+    accumulated = AABB();
+    count = 0;
+    for (int bin = 0; bin < kSahBins - 1; ++bin) {
+        accumulated.merge(binBounds[bin]);
+        count += binCounts[bin];
+        if (count == 0 || count == end - begin) continue;
+        float cost = accumulated.surfaceArea() * count + rightCost[bin + 1];
+        if (cost < bestCost) {
+            bestCost = cost;
+            bestSplit = bin;
+        }
+    }
+
+    if (bestSplit >= 0) {
+        auto middle = std::partition(items.begin() + begin, items.begin() + end, [&](int item) {
+            return binOf(item) <= bestSplit;
+        });
+        size_t split = static_cast<size_t>(middle - items.begin());
+        if (split > begin && split < end) return split;
+    }
+
+    // Every item landed in one bin; fall back to a median split
+    std::nth_element(items.begin() + begin, items.begin() + mid, items.begin() + end, [&](int a, int b) {
+        return itemBounds[a].center()[axis] < itemBounds[b].center()[axis];
+    });
+    return mid;
+}
+
+bool GLTFSceneBVH::updateItem(int item, const AABB& bounds) {
+    if (item < 0 || item >= static_cast<int>(itemLeaves.size()) || itemLeaves[item] < 0) return false;
+
+    int leaf = itemLeaves[item];
+    if (nodes[leaf].bounds == bounds) return true;
+    nodes[leaf].bounds = bounds;
+
+    // Queue the path to the root, stopping where another update already queued it
+    for (int node = nodes[leaf].parent; node >= 0 && !dirtyFlags[node]; node = nodes[node].parent) {
+        dirtyFlags[node] = 1;
+        dirtyNodes.push_back(node);
+    }
+    return true;
+}
+
+size_t GLTFSceneBVH::refit() {
+    // Children always have larger indices than their parents, so descending order is bottom-up
+    std::sort(dirtyNodes.begin(), dirtyNodes.end(), std::greater<int>());
+    for (int nodeIndex : dirtyNodes) {
+        Node& node = nodes[nodeIndex];
+        node.bounds = nodes[node.left].bounds;
+        node.bounds.merge(nodes[node.right].bounds);
+        dirtyFlags[nodeIndex] = 0;
+    }
+
+    size_t refitted = dirtyNodes.size();
+    dirtyNodes.clear();
+    return refitted;
+}
+
+void GLTFSceneBVH::query(const AABB& box, std::vector<int>& items) const {
+    if (nodes.empty() || box.isEmpty()) return;
+
+    std::vector<int>& stack = traversalStack;
+    stack.clear();
+    stack.push_back(0);
+    while (!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+        const AABB& bounds = node.bounds;
+        if (bounds.min.x > box.max.x || bounds.max.x < box.min.x ||
+            bounds.min.y > box.max.y || bounds.max.y < box.min.y ||
+            bounds.min.z > box.max.z || bounds.max.z < box.min.z) {
+            continue;
+        }
+
+        if (node.item >= 0) {
+            items.push_back(node.item);
+        }
+        else {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+}
+
+void GLTFSceneBVH::queryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, std::vector<RayItem>& items) const {
+    if (nodes.empty()) return;
+
+    const glm::vec3 inverseDirection = 1.0f / direction;
+    size_t first = items.size();
+    std::vector<int>& stack = traversalStack;
+    stack.clear();
+    stack.push_back(0);
+    while (!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+        float distance;
+        if (!node.bounds.intersectRay(origin, inverseDirection, maxDistance, distance)) continue;
+
+        if (node.item >= 0) {
+            items.push_back({ node.item, distance });
+        }
+        else {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+
+    std::sort(items.begin() + first, items.end(), [](const RayItem& a, const RayItem& b) {
+        return a.distance < b.distance;
+    });
+}
+
+const std::vector<GLTFSceneBVH::Node>& GLTFSceneBVH::getNodes() const {
+    return nodes;
+}
+
+int GLTFSceneBVH::getRoot() const {
+    return nodes.empty() ? -1 : 0;
+}
+
+void GLTFSceneBVH::printStats() const {
+    size_t leaves = 0;
+    int maxDepth = 0;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (nodes[i].item < 0) continue;
+        leaves++;
+        int depth = 0;
+        for (int node = nodes[i].parent; node >= 0; node = nodes[node].parent) depth++;
+        maxDepth = std::max(maxDepth, depth);
+    }
+    std::cout << "Scene BVH: " << nodes.size() << " nodes, " << leaves << " leaves, depth " << maxDepth << std::endl;
+}
@@ -0,0 +1,53 @@
+#ifndef GLTF_SCENE_BVH_H
+#define GLTF_SCENE_BVH_H
+
+#include <vector>
+#include "GLTFBounds.h"
+
+// Bounding volume hierarchy over scene items (glTF nodes with geometry). Built once with binned SAH;
+// afterwards moving items are handled by refitting only the branches above the leaves that changed.
+class GLTFSceneBVH {
+public:
+    struct Node {
+        AABB bounds;
+        int left = -1;   // children, -1 for leaves
+        int right = -1;
+        int parent = -1;
+        int item = -1;   // leaves only
+    };
+
+    // itemBounds is indexed by item id; items with empty bounds are left out
+    void build(const std::vector<AABB>& itemBounds);
+    void clear();
+    bool isEmpty() const;
+
+    // Returns true if the item is in the tree. Changed bounds take effect on the next refit().
+    bool updateItem(int item, const AABB& bounds);
+    // Recomputes the bounds of every ancestor of an updated leaf, bottom-up. Returns the number of nodes touched.
+    size_t refit();
+
+    struct RayItem {
+        int item;
+        float distance; // where the ray enters the item's box
+    };
+
+    // Items whose bounds overlap the box
+    void query(const AABB& box, std::vector<int>& items) const;
+    // Items whose bounds the ray passes through within maxDistance, nearest entry first
+    void queryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, std::vector<RayItem>& items) const;
+
+    const std::vector<Node>& getNodes() const;
+    int getRoot() const;
+    void printStats() const;
+
+private:
+    std::vector<Node> nodes;        // pre-order, so every child has a larger index than its parent
+    std::vector<int> itemLeaves;    // item id -> leaf node, -1 when not in the tree
+    std::vector<int> dirtyNodes;
+    std::vector<char> dirtyFlags;
+
+    int buildRecursive(std::vector<int>& items, size_t begin, size_t end, const std::vector<AABB>& itemBounds, int parent);
+    size_t partitionSAH(std::vector<int>& items, size_t begin, size_t end, const std::vector<AABB>& itemBounds) const;
+};
+
+#endif // GLTF_SCENE_BVH_H
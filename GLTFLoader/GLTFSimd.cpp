@@ -0,0 +1,91 @@
+#include "GLTFSimd.h"
+#include <iostream>
+
+#if defined(GLTF_SIMD_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace {
+    bool overrideSet = false;
+    GLTFSimd::Level overrideLevel = GLTFSimd::Level::Scalar;
+
+#if defined(GLTF_SIMD_X86)
+    void cpuid(int info[4], int leaf, int subleaf) {
+#if defined(_MSC_VER)
+        __cpuidex(info, leaf, subleaf);
+#else
+        unsigned int a, b, c, d;
+        __cpuid_count(leaf, subleaf, a, b, c, d);
+        info[0] = static_cast<int>(a);
+        info[1] = static_cast<int>(b);
+        info[2] = static_cast<int>(c);
+        info[3] = static_cast<int>(d);
+#endif
+    }
+
+    unsigned long long readXcr0() {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else
+        unsigned int eax, edx;
+        __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+    }
+#endif
+}
+
+GLTFSimd::Level GLTFSimd::detectLevel() {
+#if defined(GLTF_SIMD_X86)
+    int info[4];
+    cpuid(info, 0, 0);
+    int maxLeaf = info[0];
+
+    cpuid(info, 1, 0);
+    bool sse41 = (info[2] & (1 << 19)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    bool fma = (info[2] & (1 << 12)) != 0;
+
+    // AVX registers are only usable if the OS saves the YMM state on context switches
+    bool ymmEnabled = osxsave && (readXcr0() & 0x6) == 0x6;
+
+    bool avx2 = false;
+    if (maxLeaf >= 7) {
+        cpuid(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+
+    if (avx && avx2 && fma && ymmEnabled) return Level::AVX2;
+    if (sse41) return Level::SSE;
+#endif
+    return Level::Scalar;
+}
+
+GLTFSimd::Level GLTFSimd::getLevel() {
+    static const Level detected = detectLevel();
+    if (overrideSet && overrideLevel < detected) return overrideLevel;
+    return detected;
+}
+
+void GLTFSimd::setLevelOverride(Level level) {
+    overrideSet = true;
+    overrideLevel = level;
+    std::cout << "SIMD level forced to " << getLevelName(getLevel()) << std::endl;
+}
+
+void GLTFSimd::clearLevelOverride() {
+    overrideSet = false;
+}
+
+const char* GLTFSimd::getLevelName(Level level) {
+    switch (level) {
+    case Level::AVX2: return "AVX2";
+    case Level::SSE: return "SSE4.1";
+    default: return "Scalar";
+    }
+}
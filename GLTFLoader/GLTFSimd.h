@@ -0,0 +1,34 @@
+#ifndef GLTF_SIMD_H
+#define GLTF_SIMD_H
+
+// Runtime SIMD dispatch. Kernels are written per instruction set and picked once from what the CPU and OS
+// support, so the project itself can stay on the default /arch setting.
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define GLTF_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+// MSVC accepts AVX2 intrinsics in any function; GCC and Clang need the target enabled per function
+#if defined(_MSC_VER) || !defined(GLTF_SIMD_X86)
+#define GLTF_TARGET_AVX2
+#else
+#define GLTF_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+
+class GLTFSimd {
+public:
+    enum class Level { Scalar, SSE, AVX2 };
+
+    // Best level this machine supports, or the override if one is set
+    static Level getLevel();
+    // Forces a lower level, e.g. to compare kernels; requests above what the CPU supports are clamped
+    static void setLevelOverride(Level level);
+    static void clearLevelOverride();
+    static const char* getLevelName(Level level);
+
+private:
+    static Level detectLevel();
+};
+
+#endif // GLTF_SIMD_H
@@ -0,0 +1,324 @@
+#include "GLTFSimplifier.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <unordered_set>
+
+namespace {
+    // Per-collapse penalty for moving across a change in skin weights, scaled by the squared edge length.
+    // Keeps joint boundaries (elbows, knees) intact until the cheaper collapses have been used up.
+    const double kSkinWeightPenalty = 0.5;
+
+    const unsigned int kNoVertex = ~0u;
+
+    // Seam collapses move both wedges of a position together (from -> to and from2 -> to2)
+    struct Collapse {
+        unsigned int from;
+        unsigned int to;
+        unsigned int from2;
+        unsigned int to2;
+        double error;
+    };
+}
+
+void GLTFSimplifier::Quadric::addPlane(const glm::dvec3& n, double d, double w) {
+    a00 += w * n.x * n.x; a01 += w * n.x * n.y; a02 += w * n.x * n.z;
+    a11 += w * n.y * n.y; a12 += w * n.y * n.z; a22 += w * n.z * n.z;
+    b0 += w * n.x * d; b1 += w * n.y * d; b2 += w * n.z * d;
+    c += w * d * d;
+    weight += w;
+}
+
+void GLTFSimplifier::Quadric::add(const Quadric& o) {
+    a00 += o.a00; a01 += o.a01; a02 += o.a02;
+    a11 += o.a11; a12 += o.a12; a22 += o.a22;
+    b0 += o.b0; b1 += o.b1; b2 += o.b2;
+    c += o.c;
+    weight += o.weight;
+}
+
+double GLTFSimplifier::Quadric::evaluate(const glm::dvec3& p) const {
+    // p^T A p + 2 b^T p + c, the weighted sum of squared distances to all accumulated planes
+    double r = a00 * p.x * p.x + a11 * p.y * p.y + a22 * p.z * p.z
+        + 2.0 * (a01 * p.x * p.y + a02 * p.x * p.z + a12 * p.y * p.z)
+        + 2.0 * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+    return r > 0.0 ? r : 0.0;
+}
+
+float GLTFSimplifier::getMeshExtent(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices) {
+    if (indices.empty()) return 0.0f;
+
+    glm::vec3 minPos(FLT_MAX), maxPos(-FLT_MAX);
+    for (unsigned int index : indices) {
+        if (index >= vertices.size()) continue;
+        minPos = glm::min(minPos, vertices[index].position);
+        maxPos = glm::max(maxPos, vertices[index].position);
+    }
+    glm::vec3 size = maxPos - minPos;
+    return std::max(size.x, std::max(size.y, size.z));
+}
+
+void GLTFSimplifier::classifyVertices(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+    std::vector<VertexKind>& kinds, std::vector<unsigned int>& wedges) {
+    size_t vertexCount = vertices.size();
+    kinds.assign(vertexCount, VertexKind::Manifold);
+    wedges.resize(vertexCount);
+
+    // Group vertices by exact position. A pair is a UV or normal seam that can be collapsed along;
+    // three or more attribute sets meeting at one point are left alone.
+    std::vector<unsigned int> order(vertexCount);
+    for (unsigned int i = 0; i < vertexCount; ++i) order[i] = i;
+    auto lessPosition = [&](unsigned int a, unsigned int b) {
+        const glm::vec3& pa = vertices[a].position;
+        const glm::vec3& pb = vertices[b].position;
+        if (pa.x != pb.x) return pa.x < pb.x;
+        if (pa.y != pb.y) return pa.y < pb.y;
+        return pa.z < pb.z;
+    };
+    std::sort(order.begin(), order.end(), lessPosition);
+
+    std::vector<unsigned int> positionGroup(vertexCount);
+    for (size_t i = 0; i < vertexCount;) {
+        size_t j = i + 1;
+        while (j < vertexCount && vertices[order[j]].position == vertices[order[i]].position) j++;
+        for (size_t k = i; k < j; ++k) {
+            positionGroup[order[k]] = order[i];
+            wedges[order[k]] = order[k + 1 < j ? k + 1 : i];
+            if (j - i == 2) kinds[order[k]] = VertexKind::Seam;
+            else if (j - i > 2) kinds[order[k]] = VertexKind::Locked;
+        }
+        i = j;
+    }
+
+    // A directed edge without its opposite (measured on positions, so seams don't count) is an open border
+    std::unordered_set<uint64_t> edges;
+    edges.reserve(indices.size());
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        for (int e = 0; e < 3; ++e) {
+            uint64_t a = positionGroup[indices[i + e]];
+            uint64_t b = positionGroup[indices[i + (e + 1) % 3]];
+            edges.insert((a << 32) | b);
+        }
+    }
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        for (int e = 0; e < 3; ++e) {
+            unsigned int a = indices[i + e];
+            unsigned int b = indices[i + (e + 1) % 3];
+            uint64_t reverse = (static_cast<uint64_t>(positionGroup[b]) << 32) | positionGroup[a];
+            if (edges.count(reverse) == 0) {
+                kinds[a] = kinds[a] == VertexKind::Manifold ? VertexKind::Border : VertexKind::Locked;
+                kinds[b] = kinds[b] == VertexKind::Manifold ? VertexKind::Border : VertexKind::Locked;
+            }
+        }
+    }
+}
+
+float GLTFSimplifier::skinDifference(const Vertex& a, const Vertex& b) {
+    // Half the L1 distance between the two joint influence sets: 0 = identical skinning, 1 = disjoint
+    float diff = 0.0f;
+    for (int i = 0; i < 4; ++i) {
+        float wb = 0.0f;
+        for (int j = 0; j < 4; ++j) {
+            if (b.joints[j] == a.joints[i]) wb += b.weights[j];
+        }
+        diff += std::fabs(a.weights[i] - wb);
+    }
+    for (int j = 0; j < 4; ++j) {
+        bool shared = false;
+        for (int i = 0; i < 4; ++i) {
+            if (a.joints[i] == b.joints[j]) shared = true;
+        }
+        if (!shared) diff += b.weights[j];
+    }
+    return diff * 0.5f;
+}
+
+std::vector<unsigned int> GLTFSimplifier::simplify(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+    size_t targetIndexCount, float targetError, float* resultError) {
+    std::vector<unsigned int> result(indices.begin(), indices.begin() + (indices.size() / 3) * 3);
+    if (resultError) *resultError = 0.0f;
+
+    size_t vertexCount = vertices.size();
+    float extent = getMeshExtent(vertices, result);
+    if (result.empty() || extent <= 0.0f) return result;
+    for (unsigned int index : result) {
+        if (index >= vertexCount) return result;
+    }
+
+    std::vector<VertexKind> kinds;
+    std::vector<unsigned int> wedges;
+    classifyVertices(vertices, result, kinds, wedges);
+
+    // Area-weighted plane quadrics of the original triangles; collapses carry them along
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i < result.size(); i += 3) {
+        glm::dvec3 p0(vertices[result[i]].position);
+        glm::dvec3 p1(vertices[result[i + 1]].position);
+        glm::dvec3 p2(vertices[result[i + 2]].position);
+        glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+        double length = glm::length(n);
+        if (length <= 0.0) continue;
+        n /= length;
+        double area = length * 0.5;
+        double d = -glm::dot(n, p0);
+        for (int k = 0; k < 3; ++k) quadrics[result[i + k]].addPlane(n, d, area);
+    }
+
+    double maxErrorSq = static_cast<double>(targetError) * extent * static_cast<double>(targetError) * extent;
+    double worstError = 0.0;
+
+    std::vector<unsigned int> adjacencyOffsets(vertexCount + 1);
+    std::vector<unsigned int> adjacency;
+    std::vector<Collapse> candidates;
+    std::vector<unsigned int> remap(vertexCount);
+    std::vector<char> locked(vertexCount);
+
+    while (result.size() > targetIndexCount) {
+        size_t triangleCount = result.size() / 3;
+
+        // Vertex -> triangle adjacency of the current mesh
+        std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+        for (unsigned int index : result) adjacencyOffsets[index + 1]++;
+        for (size_t v = 0; v < vertexCount; ++v) adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+        adjacency.assign(result.size(), 0);
+        std::vector<unsigned int> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t t = 0; t < triangleCount; ++t) {
+            for (int k = 0; k < 3; ++k) adjacency[fill[result[t * 3 + k]]++] = static_cast<unsigned int>(t);
+        }
+
+        auto sharedTriangles = [&](unsigned int a, unsigned int b) {
+            int count = 0;
+            for (unsigned int t = adjacencyOffsets[a]; t < adjacencyOffsets[a + 1]; ++t) {
+                const unsigned int* tri = &result[adjacency[t] * 3];
+                if (tri[0] == b || tri[1] == b || tri[2] == b) count++;
+            }
+            return count;
+        };
+
+        auto collapseError = [&](unsigned int from, unsigned int to, unsigned int from2, unsigned int to2) {
+            Quadric q = quadrics[from];
+            q.add(quadrics[to]);
+            if (from2 != kNoVertex) {
+                q.add(quadrics[from2]);
+                q.add(quadrics[to2]);
+            }
+            glm::dvec3 target(vertices[to].position);
+            double error = q.weight > 0.0 ? q.evaluate(target) / q.weight : 0.0;
+
+            glm::dvec3 edge = target - glm::dvec3(vertices[from].position);
+            return error + kSkinWeightPenalty * skinDifference(vertices[from], vertices[to]) * glm::dot(edge, edge);
+        };
+
+        // Cheapest collapse per removable vertex. Manifold vertices may move to any neighbour; border vertices
+        // only along the border, and seam vertices only along the seam, taking their other wedge with them.
+        // The target keeps its position and attributes, so it may be of any kind.
+        candidates.clear();
+        for (unsigned int from = 0; from < vertexCount; ++from) {
+            VertexKind kind = kinds[from];
+            if (kind == VertexKind::Locked) continue;
+
+            Collapse best = { from, from, kNoVertex, kNoVertex, DBL_MAX };
+            for (unsigned int a = adjacencyOffsets[from]; a < adjacencyOffsets[from + 1]; ++a) {
+                const unsigned int* tri = &result[adjacency[a] * 3];
+                for (int k = 0; k < 3; ++k) {
+                    unsigned int to = tri[k];
+                    if (to == from) continue;
+
+                    unsigned int from2 = kNoVertex, to2 = kNoVertex;
+                    if (kind == VertexKind::Border) {
+                        if (sharedTriangles(from, to) != 1) continue;
+                    }
+                    else if (kind == VertexKind::Seam) {
+                        if (kinds[to] != VertexKind::Seam || sharedTriangles(from, to) != 1) continue;
+                        from2 = wedges[from];
+                        to2 = wedges[to];
+                        if (sharedTriangles(from2, to2) != 1) continue;
+                    }
+
+                    double error = collapseError(from, to, from2, to2);
+                    if (error < best.error) best = { from, to, from2, to2, error };
+                }
+            }
+            if (best.to != from && best.error <= maxErrorSq) candidates.push_back(best);
+        }
+        if (candidates.empty()) break;
+
+        std::sort(candidates.begin(), candidates.end(), [](const Collapse& a, const Collapse& b) {
+            return a.error < b.error;
+        });
+
+        // Reject collapses that flip a triangle that survives the collapse
+        auto flipsTriangles = [&](unsigned int from, unsigned int to) {
+            glm::vec3 target = vertices[to].position;
+            for (unsigned int a = adjacencyOffsets[from]; a < adjacencyOffsets[from + 1]; ++a) {
+                const unsigned int* tri = &result[adjacency[a] * 3];
+                if (tri[0] == to || tri[1] == to || tri[2] == to) continue;
+
+                glm::vec3 p[3], q[3];
+                for (int k = 0; k < 3; ++k) {
+                    p[k] = vertices[tri[k]].position;
+                    q[k] = tri[k] == from ? target : p[k];
+                }
+                glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+                if (glm::dot(before, after) <= 0.0f) return true;
+            }
+            return false;
+        };
+
+        auto lockNeighbourhood = [&](unsigned int from, unsigned int to) {
+            locked[to] = 1;
+            for (unsigned int a = adjacencyOffsets[from]; a < adjacencyOffsets[from + 1]; ++a) {
+                const unsigned int* tri = &result[adjacency[a] * 3];
+                for (int k = 0; k < 3; ++k) locked[tri[k]] = 1;
+            }
+        };
+
+        // Apply as many independent collapses as the remaining budget allows. Each collapse removes two
+        // triangles in the manifold case; neighbourhoods are locked so the flip test stays valid. Collapses
+        // far costlier than the cheapest half of the budget wait for the next pass, when costs are fresh.
+        size_t collapseLimit = (result.size() - targetIndexCount) / 6 + 1;
+        size_t goalIndex = collapseLimit / 2;
+        double passErrorLimit = goalIndex < candidates.size() ? candidates[goalIndex].error * 1.5 : DBL_MAX;
+        size_t collapses = 0;
+        for (unsigned int v = 0; v < vertexCount; ++v) remap[v] = v;
+        std::fill(locked.begin(), locked.end(), 0);
+
+        for (const Collapse& collapse : candidates) {
+            if (collapses >= collapseLimit || collapse.error > passErrorLimit) break;
+            if (locked[collapse.from] || locked[collapse.to]) continue;
+
+            bool paired = collapse.from2 != kNoVertex;
+            if (paired && (locked[collapse.from2] || locked[collapse.to2])) continue;
+            if (flipsTriangles(collapse.from, collapse.to)) continue;
+            if (paired && flipsTriangles(collapse.from2, collapse.to2)) continue;
+
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to].add(quadrics[collapse.from]);
+            lockNeighbourhood(collapse.from, collapse.to);
+            if (paired) {
+                remap[collapse.from2] = collapse.to2;
+                quadrics[collapse.to2].add(quadrics[collapse.from2]);
+                lockNeighbourhood(collapse.from2, collapse.to2);
+            }
+            worstError = std::max(worstError, collapse.error);
+            collapses++;
+        }
+        if (collapses == 0) break;
+
+        // Rewrite the index list and drop the triangles that became degenerate
+        size_t write = 0;
+        for (size_t i = 0; i < result.size(); i += 3) {
+            unsigned int a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+            if (a == b || b == c || a == c) continue;
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+        result.resize(write);
+    }
+
+    if (resultError) *resultError = static_cast<float>(std::sqrt(worstError) / extent);
+    return result;
+}
@@ -0,0 +1,41 @@
+#ifndef GLTF_SIMPLIFIER_H
+#define GLTF_SIMPLIFIER_H
+
+#include <vector>
+#include "Vertex.h"
+
+// Quadric error metric edge-collapse simplifier (Garland & Heckbert 1997).
+// Vertices are only ever collapsed onto other existing vertices, so the output indexes the same vertex
+// array and every surviving vertex keeps its own UVs, joints and weights. UV/normal seams (two vertices
+// sharing one position) and open borders only collapse along themselves, so their outline is preserved.
+class GLTFSimplifier {
+public:
+    // Collapses edges until the index count drops to targetIndexCount or the next collapse would exceed
+    // targetError (relative to the mesh extent). resultError receives the largest error actually introduced,
+    // also relative to the mesh extent.
+    static std::vector<unsigned int> simplify(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+        size_t targetIndexCount, float targetError, float* resultError = nullptr);
+
+    // Largest axis of the bounding box of the referenced vertices; multiplies relative errors into model units
+    static float getMeshExtent(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+
+private:
+    struct Quadric {
+        double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+        double b0 = 0, b1 = 0, b2 = 0, c = 0;
+        double weight = 0;
+
+        void addPlane(const glm::dvec3& normal, double distance, double planeWeight);
+        void add(const Quadric& other);
+        double evaluate(const glm::dvec3& p) const;
+    };
+
+    enum class VertexKind { Manifold, Border, Seam, Locked };
+
+    // wedges links vertices that share a position into a ring (a vertex without a twin points to itself)
+    static void classifyVertices(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+        std::vector<VertexKind>& kinds, std::vector<unsigned int>& wedges);
+    static float skinDifference(const Vertex& a, const Vertex& b);
+};
+
+#endif // GLTF_SIMPLIFIER_H
@@ -1,34 +1,27 @@
 #include "GLTFSkeleton.h"
 #include "PersonalGL.h"
+#include "GLTFTransformKernels.h"
+#include <algorithm>
 
 GLTFSkeleton::GLTFSkeleton(const GLTFMesh& meshManager, GLTFNode& nodeManager, const GLTFAccessor& accessorManager, GLTFBuffer& bufferManager)
     : meshManager(meshManager), nodeManager(nodeManager), accessorManager(accessorManager), bufferManager(bufferManager) {
     initializeSkeleton();
 }
 
-void GLTFSkeleton::addBone(int nodeIndex, int parentIndex, const glm::mat4& inverseBindMatrix, const std::string& name) {
-    Bone bone = { nodeIndex, parentIndex, name, inverseBindMatrix, glm::mat4(1.0f), {} };
-    if (parentIndex >= 0) {
-        if (parentIndex >= bones.size()) {
-            std::cerr << "Invalid parent index: " << parentIndex << " for bone: " << nodeIndex << std::endl;
-            return;
-        }
-        bones[parentIndex].children.push_back(static_cast<int>(bones.size()));
-    }
-    bone.transform = nodeManager.getNodes()[bone.nodeIndex].transformation; // local transform
-    bone.globalTransform = nodeManager.getGlobalTransform(bone.nodeIndex); // global transform
-    bones.push_back(bone);
-}
-
 void GLTFSkeleton::loadInverseBindMatrices() { //verified and working correctly! (might be an issue with 2nd skin though)
     const auto& skins = meshManager.getSkins();
+    skinInverseBindOffsets.clear();
     for (const auto& skin : skins) {
-        if (skin.inverseBindMatricesAccessor < 0) continue;
+        if (skin.inverseBindMatricesAccessor < 0) {
+            skinInverseBindOffsets.push_back(SIZE_MAX);
+            continue;
+        }
 
         const auto& accessor = accessorManager.getAccessors()[skin.inverseBindMatricesAccessor];
         std::vector<glm::mat4> matrices = bufferManager.getInverseBindMatrices(accessor);
 
         // Accumulate the inverse bind matrices for each skin
+        skinInverseBindOffsets.push_back(inverseBindMatrices.size());
         inverseBindMatrices.insert(inverseBindMatrices.end(), matrices.begin(), matrices.end());
     }
 }
@@ -36,57 +29,73 @@ void GLTFSkeleton::loadInverseBindMatrices() { //verified and working correctly!
 
 void GLTFSkeleton::initializeSkeleton() {
     const auto& skins = meshManager.getSkins();
+    bones.clear();
+    nodeToBoneIndex.clear();
+    inverseBindMatrices.clear();
     loadInverseBindMatrices();
-    for (const auto& skin : skins) {
-        parseSkin(skin);
+    skinFirstBones.clear();
+    for (size_t i = 0; i < skins.size(); ++i) {
+        skinFirstBones.push_back(static_cast<int>(bones.size()));
+        parseSkin(skins[i], skinInverseBindOffsets[i]);
     }
     loadVertices();
     jointMatrices.resize(bones.size());
+    boneWorlds.resize(bones.size());
+    boneGlobals.resize(bones.size());
+    boneInverseBinds.resize(bones.size());
+    for (size_t i = 0; i < bones.size(); ++i) boneInverseBinds[i] = bones[i].inverseBindMatrix;
     normalizeWeights();
     calculateBoneTransforms();
 }
 
-void GLTFSkeleton::parseSkin(const auto skin) {
-    addRootBones(skin);
-    addChildBones(skin);
-}
-
-void GLTFSkeleton::addRootBones(const auto skin) {
+void GLTFSkeleton::parseSkin(const GLTFMesh::Skin& skin, size_t inverseBindOffset) {
     const auto& nodes = nodeManager.getNodes();
+    const int firstBone = static_cast<int>(bones.size());
 
+    // Register every joint first so parents resolve in O(1) whatever order the skin lists them in
     for (size_t i = 0; i < skin.joints.size(); ++i) {
-        int nodeIndex = skin.joints[i];
-        int parentIndex = nodeManager.findParentNodeIndex(nodeIndex);
-        if (parentIndex == -1 || std::find(skin.joints.begin(), skin.joints.end(), parentIndex) == skin.joints.end()) {
-            glm::mat4 inverseBindMatrix = (i < inverseBindMatrices.size()) ? inverseBindMatrices[bones.size()] : glm::mat4(1.0f);
-            std::string name = nodes[nodeIndex].name;
-            std::cout << "Root Bone - Node Index: " << nodeIndex << ", Parent Index: " << parentIndex << ", Bone Name: " << name << std::endl;
-            addBone(nodeIndex, -1, inverseBindMatrix, name); // Add root bone
-        }
+        nodeToBoneIndex[skin.joints[i]] = firstBone + static_cast<int>(i);
     }
-}
-
-void GLTFSkeleton::addChildBones(const auto skin) {
-    const auto& nodes = nodeManager.getNodes();
 
     for (size_t i = 0; i < skin.joints.size(); ++i) {
         int nodeIndex = skin.joints[i];
-        int parentIndex = nodeManager.findParentNodeIndex(nodeIndex);
-        if (parentIndex != -1 && std::find(skin.joints.begin(), skin.joints.end(), parentIndex) != skin.joints.end()) {
-            auto parentIt = std::find_if(bones.begin(), bones.end(), [parentIndex](const Bone& bone) {
-                return bone.nodeIndex == parentIndex;
-                });
-            if (parentIt != bones.end()) {
-                int parentBoneIndex = std::distance(bones.begin(), parentIt);
-                glm::mat4 inverseBindMatrix = (i < inverseBindMatrices.size()) ? inverseBindMatrices[bones.size()] : glm::mat4(1.0f);
-                std::string name = nodes[nodeIndex].name;
-                std::cout << "Child Bone - Node Index: " << nodeIndex << ", Parent Index: " << parentIndex << ", Bone Name: " << name << std::endl;
-                addBone(nodeIndex, parentBoneIndex, inverseBindMatrix, name); // Add child bone
-            }
-            else {
-                std::cerr << "Parent bone for node " << nodeIndex << " not found. Skipping..." << std::endl;
-            }
+        int parentNode = nodeManager.findParentNodeIndex(nodeIndex);
+        auto parentIt = nodeToBoneIndex.find(parentNode);
+        int parentBone = (parentIt != nodeToBoneIndex.end() && parentIt->second >= firstBone) ? parentIt->second : -1;
+
+        // Matrices are stored per joint, so joint i of this skin reads entry i of its accessor
+        size_t matrixIndex = inverseBindOffset + i;
+        glm::mat4 inverseBindMatrix = (inverseBindOffset != SIZE_MAX && matrixIndex < inverseBindMatrices.size())
+            ? inverseBindMatrices[matrixIndex] : glm::mat4(1.0f);
+
+        Bone bone = { nodeIndex, parentBone, nodes[nodeIndex].name, inverseBindMatrix, glm::mat4(1.0f), glm::mat4(1.0f), {} };
+        bone.transform = nodeManager.getLocalTransform(nodeIndex);
+        bone.globalTransform = nodeManager.getGlobalTransform(nodeIndex);
+        bones.push_back(bone);
+        std::cout << (parentBone < 0 ? "Root" : "Child") << " Bone - Node Index: " << nodeIndex << ", Parent Index: " << parentNode
+            << ", Bone Name: " << bone.name << std::endl;
+    }
+
+    // Children lists and skeleton roots in one pass each. A root's skeletonRootParent is its parent node;
+    // every other bone inherits it from its root, found by walking up until a resolved bone.
+    for (int boneIndex = firstBone; boneIndex < static_cast<int>(bones.size()); ++boneIndex) {
+        if (bones[boneIndex].parentIndex >= 0) bones[bones[boneIndex].parentIndex].children.push_back(boneIndex);
+    }
+    std::vector<char> resolved(bones.size() - firstBone, 0);
+    std::vector<int> path;
+    for (int boneIndex = firstBone; boneIndex < static_cast<int>(bones.size()); ++boneIndex) {
+        int current = boneIndex;
+        while (current >= 0 && !resolved[current - firstBone]) {
+            path.push_back(current);
+            current = bones[current].parentIndex;
         }
+        int rootParent = current >= 0 ? bones[current].skeletonRootParent
+            : nodeManager.findParentNodeIndex(bones[path.back()].nodeIndex);
+        for (int bone : path) {
+            bones[bone].skeletonRootParent = rootParent;
+            resolved[bone - firstBone] = 1;
+        }
+        path.clear();
     }
 }
 
@@ -99,20 +108,59 @@ void GLTFSkeleton::checkInverseBindMatrices() {
 }
 
 void GLTFSkeleton::calculateBoneTransforms() {
-    for (size_t i = 0; i < bones.size(); ++i) {
-        Bone& bone = bones[i];
-        bone.transform = nodeManager.getNodeTransform(nodeManager.getNodes()[bone.nodeIndex]);
-
-        if (bone.parentIndex >= 0) {
-            bone.globalTransform = bones[bone.parentIndex].globalTransform * bone.transform;
+    // World matrices come from the node pass. The bone chain starts at the root bone (the mesh node's
+    // transform is applied on top when drawing), so strip whatever sits above the skeleton root.
+    // Nothing is recomputed unless a bone's node moved in the last node pass.
+    bool anyChanged = false;
+    for (const Bone& bone : bones) {
+        if (nodeManager.hasWorldChanged(bone.nodeIndex)) {
+            anyChanged = true;
+            break;
+        }
+    }
+    if (!anyChanged) return;
+
+    // Gathered into contiguous arrays so the products run as batches. Bones of one skin share their
+    // skeletonRootParent, so each run of equal roots is one broadcast multiply.
+    const size_t count = bones.size();
+    for (size_t i = 0; i < count; ++i) boneWorlds[i] = nodeManager.getGlobalTransform(bones[i].nodeIndex);
+    for (size_t begin = 0; begin < count;) {
+        int rootParent = bones[begin].skeletonRootParent;
+        size_t end = begin + 1;
+        while (end < count && bones[end].skeletonRootParent == rootParent) ++end;
+        if (rootParent >= 0) {
+            glm::mat4 rootParentInverse = glm::inverse(nodeManager.getGlobalTransform(rootParent));
+            GLTFTransformKernels::multiplyAffine(rootParentInverse, &boneWorlds[begin], &boneGlobals[begin], end - begin);
         }
         else {
-            bone.globalTransform = bone.transform;
+            std::copy(boneWorlds.begin() + begin, boneWorlds.begin() + end, boneGlobals.begin() + begin);
         }
+        begin = end;
+    }
 
-        // Apply the inverse bind matrix
-        jointMatrices[i] = bone.globalTransform * bone.inverseBindMatrix;
+    // Apply the inverse bind matrices
+    GLTFTransformKernels::computePalette(boneGlobals.data(), boneInverseBinds.data(), jointMatrices.data(), count);
+
+    for (size_t i = 0; i < count; ++i) {
+        bones[i].globalTransform = boneGlobals[i];
+        bones[i].transform = nodeManager.getLocalTransform(bones[i].nodeIndex);
+    }
+    boneProxies.update(jointMatrices);
+}
+
+void GLTFSkeleton::buildBoneProxies(float minWeight) {
+    std::vector<const std::vector<Vertex>*> vertexSets;
+    for (const auto& meshPair : primitivesPerMesh) {
+        for (const auto& geometry : meshPair.second) {
+            vertexSets.push_back(&geometry.vertices);
+        }
     }
+    boneProxies.build(vertexSets, bones.size(), minWeight);
+    boneProxies.update(jointMatrices);
+}
+
+const GLTFBoneProxies& GLTFSkeleton::getBoneProxies() const {
+    return boneProxies;
 }
 
 void GLTFSkeleton::updateSkeleton(const std::vector<GLTFNode::Node>& nodes) {
@@ -128,6 +176,11 @@ const GLTFSkeleton::Bone& GLTFSkeleton::getBone(int index) const {
     return bones[index];
 }
 
+int GLTFSkeleton::getBoneIndex(int nodeIndex) const {
+    auto it = nodeToBoneIndex.find(nodeIndex);
+    return it != nodeToBoneIndex.end() ? it->second : -1;
+}
+
 const std::vector<GLTFSkeleton::Bone>& GLTFSkeleton::getBones() const {
     return bones;
 }
@@ -142,58 +195,100 @@ const std::vector<glm::vec4>& GLTFSkeleton::getWeights() const {
 }
 
 void GLTFSkeleton::normalizeWeights() { //confirmed weights are correctly parsed
-    for (auto& meshPair : verticesPerMesh) {
-        auto& meshVertices = meshPair.second;
-        for (auto& vertex : meshVertices) {
-            float totalWeight = vertex.weights[0] + vertex.weights[1] + vertex.weights[2] + vertex.weights[3];
-            if (totalWeight > 0.0f) {
-                vertex.weights /= totalWeight;
+    for (auto& meshPair : primitivesPerMesh) {
+        for (auto& geometry : meshPair.second) {
+            for (auto& vertex : geometry.vertices) {
+                float totalWeight = vertex.weights[0] + vertex.weights[1] + vertex.weights[2] + vertex.weights[3];
+                if (totalWeight > 0.0f) {
+                    vertex.weights /= totalWeight;
+                }
+                //std::cout << vertex.weights[0] << " " << vertex.weights[1] << " " << vertex.weights[2] << " " << vertex.weights[3] << std::endl;
             }
-            //std::cout << vertex.weights[0] << " " << vertex.weights[1] << " " << vertex.weights[2] << " " << vertex.weights[3] << std::endl;
         }
     }
 }
 
 void GLTFSkeleton::loadVertices() {
     const auto& meshes = meshManager.getMeshes();
+    primitivesPerMesh.clear();
+
+    // Vertices are stored once per mesh, so a mesh drawn with two different skins can only follow one
+    std::vector<int> meshSkins(meshes.size(), -1);
+    for (const auto& node : nodeManager.getNodes()) {
+        if (node.meshIndex < 0 || node.meshIndex >= static_cast<int>(meshes.size())) continue;
+        if (node.skinIndex < 0 || node.skinIndex >= static_cast<int>(skinFirstBones.size())) continue;
+        int& skin = meshSkins[node.meshIndex];
+        if (skin >= 0 && skin != node.skinIndex) {
+            std::cerr << "Warning: mesh " << node.meshIndex << " is used with skins " << skin << " and " << node.skinIndex
+                << "; skinning it with skin " << skin << std::endl;
+            continue;
+        }
+        skin = node.skinIndex;
+    }
+
     for (size_t meshIndex = 0; meshIndex < meshes.size(); ++meshIndex) {
         const auto& mesh = meshes[meshIndex];
-        for (const auto& primitive : mesh.primitives) {
+        const int firstBone = meshSkins[meshIndex] >= 0 ? skinFirstBones[meshSkins[meshIndex]] : 0;
+        auto& meshGeometry = primitivesPerMesh[static_cast<int>(meshIndex)];
+        meshGeometry.resize(mesh.primitives.size());
+        for (size_t primitiveIndex = 0; primitiveIndex < mesh.primitives.size(); ++primitiveIndex) {
+            const auto& primitive = mesh.primitives[primitiveIndex];
             if (primitive.positionAccessor >= 0) {
-                const auto& positionAccessor = accessorManager.getAccessors()[primitive.positionAccessor];
-                const auto& positionBufferView = bufferManager.getBufferViews()[positionAccessor.bufferView];
-                const auto& positionBuffer = bufferManager.getBuffers()[positionBufferView.buffer];
-                const float* positionData = reinterpret_cast<const float*>(&positionBuffer.data[positionBufferView.byteOffset + positionAccessor.byteOffset]);
-
-                const auto& normalAccessor = accessorManager.getAccessors()[primitive.normalAccessor];
-                const auto& normalBufferView = bufferManager.getBufferViews()[normalAccessor.bufferView];
-                const auto& normalBuffer = bufferManager.getBuffers()[normalBufferView.buffer];
-                const float* normalData = reinterpret_cast<const float*>(&normalBuffer.data[normalBufferView.byteOffset + normalAccessor.byteOffset]);
-
-                const auto& texCoordAccessor = accessorManager.getAccessors()[primitive.texcoordAccessor];
-                const auto& texCoordBufferView = bufferManager.getBufferViews()[texCoordAccessor.bufferView];
-                const auto& texCoordBuffer = bufferManager.getBuffers()[texCoordBufferView.buffer];
-                const float* texCoordData = reinterpret_cast<const float*>(&texCoordBuffer.data[texCoordBufferView.byteOffset + texCoordAccessor.byteOffset]);
-
-                size_t vertexCount = positionAccessor.count;
+                // Decode through the buffer manager so strides and sparse substitutions are honoured
+                const auto& accessors = accessorManager.getAccessors();
+                std::vector<glm::vec3> positions = bufferManager.getPositions(accessors[primitive.positionAccessor]);
+                std::vector<glm::vec3> normals;
+                if (primitive.normalAccessor >= 0) normals = bufferManager.getNormals(accessors[primitive.normalAccessor]);
+                std::vector<glm::vec2> texCoords;
+                if (primitive.texcoordAccessor >= 0) texCoords = bufferManager.getTexcoords(accessors[primitive.texcoordAccessor]);
+
+                size_t vertexCount = positions.size();
                 std::vector<Vertex> vertices(vertexCount);
 
                 // Load joints and weights using GLTFBuffer methods
-                const auto& jointsAccessor = accessorManager.getAccessors()[primitive.jointsAccessor];
-                std::vector<glm::vec4> joints = bufferManager.getJoints(jointsAccessor);
-
-                const auto& weightsAccessor = accessorManager.getAccessors()[primitive.weightsAccessor];
-                std::vector<glm::vec4> weights = bufferManager.getWeights(weightsAccessor);
+                std::vector<glm::vec4> joints;
+                if (primitive.jointsAccessor >= 0) joints = bufferManager.getJoints(accessors[primitive.jointsAccessor]);
+                std::vector<glm::vec4> weights;
+                if (primitive.weightsAccessor >= 0) weights = bufferManager.getWeights(accessors[primitive.weightsAccessor]);
 
                 for (size_t i = 0; i < vertexCount; ++i) {
-                    vertices[i].position = glm::make_vec3(&positionData[i * 3]);
-                    vertices[i].normal = glm::make_vec3(&normalData[i * 3]);
-                    vertices[i].texCoord = glm::make_vec2(&texCoordData[i * 2]);
-                    vertices[i].joints = glm::ivec4(joints[i]);
-                    vertices[i].weights = weights[i];
+                    vertices[i].position = positions[i];
+                    if (i < normals.size()) vertices[i].normal = normals[i];
+                    if (i < texCoords.size()) vertices[i].texCoord = texCoords[i];
+                    if (i < joints.size()) vertices[i].joints = glm::ivec4(joints[i]) + firstBone;
+                    if (i < weights.size()) vertices[i].weights = weights[i];
+                }
+
+                auto& geometry = meshGeometry[primitiveIndex];
+                geometry.materialIndex = primitive.materialIndex;
+                geometry.vertices = std::move(vertices);
+                if (primitive.indicesAccessor >= 0) {
+                    geometry.indices = bufferManager.getIndices(accessors[primitive.indicesAccessor]);
+                }
+                else {
+                    // Non-indexed primitive: every three vertices form a triangle
+                    geometry.indices.resize(vertexCount);
+                    for (size_t i = 0; i < vertexCount; ++i) geometry.indices[i] = static_cast<unsigned int>(i);
                 }
 
-                verticesPerMesh[meshIndex].insert(verticesPerMesh[meshIndex].end(), vertices.begin(), vertices.end());
+                // Morph deltas stay sparse: a sparse accessor without a bufferView is read as its substitution
+                // list, and dense ones keep only the vertices they move
+                geometry.morphTargets.clear();
+                for (const auto& morph : primitive.morphTargets) {
+                    GLTFMorphTargets::Target target;
+                    auto decode = [&](int accessor) {
+                        if (accessor < 0 || accessor >= static_cast<int>(accessors.size())) return GLTFMorphTargets::SparseDeltas();
+                        GLTFBuffer::SparseVec3 sparse = bufferManager.getSparseVec3(accessors[accessor]);
+                        return GLTFMorphTargets::packDeltas(sparse.indices, sparse.values, vertexCount);
+                    };
+                    target.positions = decode(morph.positionAccessor);
+                    target.normals = decode(morph.normalAccessor);
+                    target.tangents = decode(morph.tangentAccessor);
+                    for (const auto& delta : target.positions.deltas) {
+                        target.maxDisplacement = std::max(target.maxDisplacement, glm::length(glm::vec3(delta)));
+                    }
+                    geometry.morphTargets.push_back(std::move(target));
+                }
             }
         }
     }
@@ -201,60 +296,66 @@ void GLTFSkeleton::loadVertices() {
 
 
 
-const std::unordered_map<int, std::vector<Vertex>>& GLTFSkeleton::getVertices() const {
-    return verticesPerMesh;
+const std::unordered_map<int, std::vector<GLTFMesh::PrimitiveGeometry>>& GLTFSkeleton::getPrimitiveGeometry() const {
+    return primitivesPerMesh;
+}
+
+std::unordered_map<int, std::vector<GLTFMesh::PrimitiveGeometry>>& GLTFSkeleton::getPrimitiveGeometry() {
+    return primitivesPerMesh;
 }
 
 void GLTFSkeleton::applySkinning() { //only do this once. super shit performance hit if you do it in the update loop
-    for (auto& meshPair : verticesPerMesh) {
-        auto& vertices = meshPair.second;
-
-        //std::cout << "applying skinning to mesh!" << std::endl;
-        for (auto& vertex : vertices) {
-            glm::vec4 skinnedPosition(0.0f);
-            glm::vec4 skinnedNormal(0.0f);
-
-            for (int i = 0; i < 4; ++i) {
-                if (vertex.weights[i] > 0.0f) {
-                    int jointIndex = vertex.joints[i];
-                    if (jointIndex < 0 || jointIndex >= jointMatrices.size()) {
-                        std::cerr << "Invalid joint index: " << jointIndex << std::endl;
-                        continue;
+    for (auto& meshPair : primitivesPerMesh) {
+        for (auto& geometry : meshPair.second) {
+            //std::cout << "applying skinning to mesh!" << std::endl;
+            for (auto& vertex : geometry.vertices) {
+                glm::vec4 skinnedPosition(0.0f);
+                glm::vec4 skinnedNormal(0.0f);
+
+                for (int i = 0; i < 4; ++i) {
+                    if (vertex.weights[i] > 0.0f) {
+                        int jointIndex = vertex.joints[i];
+                        if (jointIndex < 0 || jointIndex >= jointMatrices.size()) {
+                            std::cerr << "Invalid joint index: " << jointIndex << std::endl;
+                            continue;
+                        }
+                        const glm::mat4& jointMatrix = jointMatrices[jointIndex];
+
+                        skinnedPosition += jointMatrix * glm::vec4(vertex.position, 1.0f) * vertex.weights[i];
+                        skinnedNormal += jointMatrix * glm::vec4(vertex.normal, 0.0f) * vertex.weights[i];
                     }
-                    const glm::mat4& jointMatrix = jointMatrices[jointIndex];
-
-                    skinnedPosition += jointMatrix * glm::vec4(vertex.position, 1.0f) * vertex.weights[i];
-                    skinnedNormal += jointMatrix * glm::vec4(vertex.normal, 0.0f) * vertex.weights[i];
                 }
-            }
 
-            vertex.position = glm::vec3(skinnedPosition);
-            vertex.normal = glm::normalize(glm::vec3(skinnedNormal));
+                vertex.position = glm::vec3(skinnedPosition);
+                vertex.normal = glm::normalize(glm::vec3(skinnedNormal));
 
-            // Debug output for skinned positions and normals
-            //std::cout << "Vertex skinned position: " << vertex.position.x << ", " << vertex.position.y << ", " << vertex.position.z << std::endl;
-            //std::cout << "Vertex skinned normal: " << vertex.normal.x << ", " << vertex.normal.y << ", " << vertex.normal.z << std::endl;
+                // Debug output for skinned positions and normals
+                //std::cout << "Vertex skinned position: " << vertex.position.x << ", " << vertex.position.y << ", " << vertex.position.z << std::endl;
+                //std::cout << "Vertex skinned normal: " << vertex.normal.x << ", " << vertex.normal.y << ", " << vertex.normal.z << std::endl;
+            }
         }
     }
 }
 
 
 void GLTFSkeleton::validateJointIndices() {
-    for (const auto& meshPair : verticesPerMesh) {
+    for (const auto& meshPair : primitivesPerMesh) {
         int totalErrors = 0;
-        const auto& vertices = meshPair.second;
-
-        for (size_t i = 0; i < vertices.size(); ++i) {
-            const auto& vertex = vertices[i];
-            float weightSum = vertex.weights[0] + vertex.weights[1] + vertex.weights[2] + vertex.weights[3];
-
-            for (int j = 0; j < 4; ++j) {
-                if (vertex.weights[j] > 0.0f) { // 4 influenced joints
-                    int jointIndex = vertex.joints[j];
-                    if (jointIndex >= bones.size()) {
-                        totalErrors++;
-                        //std::cerr << "Invalid joint index: " << jointIndex << " in vertex data at vertex " << i << ", joint " << j << std::endl;
-                        //std::cerr << "Joints: " << vertex.joints[0] << ", " << vertex.joints[1] << ", " << vertex.joints[2] << ", " << vertex.joints[3] << std::endl;
+        for (const auto& geometry : meshPair.second) {
+            const auto& vertices = geometry.vertices;
+
+            for (size_t i = 0; i < vertices.size(); ++i) {
+                const auto& vertex = vertices[i];
+                float weightSum = vertex.weights[0] + vertex.weights[1] + vertex.weights[2] + vertex.weights[3];
+
+                for (int j = 0; j < 4; ++j) {
+                    if (vertex.weights[j] > 0.0f) { // 4 influenced joints
+                        int jointIndex = vertex.joints[j];
+                        if (jointIndex >= bones.size()) {
+                            totalErrors++;
+                            //std::cerr << "Invalid joint index: " << jointIndex << " in vertex data at vertex " << i << ", joint " << j << std::endl;
+                            //std::cerr << "Joints: " << vertex.joints[0] << ", " << vertex.joints[1] << ", " << vertex.joints[2] << ", " << vertex.joints[3] << std::endl;
+                        }
                     }
                 }
             }
@@ -22,6 +22,7 @@
 #include "GLTFAccessor.h"
 #include "GLTFBuffer.h"
 #include "Vertex.h"
+#include "GLTFBoneProxies.h"
 
 class GLTFSkeleton {
 public:
@@ -34,11 +35,13 @@ public:
         glm::mat4 globalTransform;
         glm::mat4 transform;
         std::vector<int> children;
+        int skeletonRootParent = -1; // node above this bone's root bone; bones are posed relative to it
     };
 
     GLTFSkeleton(const GLTFMesh& meshManager, GLTFNode& nodeManager, const GLTFAccessor& accessorManager, GLTFBuffer& bufferManager);
 
     const Bone& getBone(int index) const;
+    int getBoneIndex(int nodeIndex) const; // -1 if the node is not a joint
     const std::vector<Bone>& getBones() const;
     glm::mat4 getGlobalBoneTransform(int boneIndex) const;
     const std::vector<glm::mat4>& getJointMatrices() const;
@@ -48,12 +51,18 @@ public:
 
     void printSkeleton() const;
     void loadVertices();
-    const std::unordered_map<int, std::vector<Vertex>>& getVertices() const;
+    const std::unordered_map<int, std::vector<GLTFMesh::PrimitiveGeometry>>& getPrimitiveGeometry() const;
+    std::unordered_map<int, std::vector<GLTFMesh::PrimitiveGeometry>>& getPrimitiveGeometry();
     void applySkinning();
     void validateJointIndices();
     void initializeSkeleton();
+    // Fits one capsule per bone to the loaded vertices; they follow the joint matrices from then on
+    void buildBoneProxies(float minWeight);
+    const GLTFBoneProxies& getBoneProxies() const;
 
-    void parseSkin(const auto skin);
+    // Skins are appended in order, so joint i of a skin is bone skinFirstBones[skin] + i. loadVertices adds
+    // that offset to the JOINTS_0 values, so vertex joints index bones directly whichever skin they use.
+    void parseSkin(const GLTFMesh::Skin& skin, size_t inverseBindOffset);
 
     std::vector<glm::mat4> jointMatrices;
 
@@ -66,20 +75,22 @@ private:
     std::vector<glm::vec4> weights;
 
     std::vector<glm::mat4> inverseBindMatrices;
-    void addBone(int nodeIndex, int parentIndex, const glm::mat4& inverseBindMatrix, const std::string& name);
+    // Per bone and contiguous, for the batched palette kernels
+    std::vector<glm::mat4> boneWorlds;
+    std::vector<glm::mat4> boneGlobals;
+    std::vector<glm::mat4> boneInverseBinds;
+    GLTFBoneProxies boneProxies;
     void loadInverseBindMatrices();
     void checkInverseBindMatrices();
     void calculateBoneTransforms();
-    void addRootBones(const auto skin);
-    void addChildBones(const auto skin);
     void normalizeWeights();
     const std::vector<glm::vec4>& getWeights() const;
 
 
-    int boneIndex = 0;
+    std::vector<size_t> skinInverseBindOffsets; // per skin, into inverseBindMatrices; SIZE_MAX without an accessor
+    std::vector<int> skinFirstBones;            // per skin, the bone of its joint 0
     std::unordered_map<int, int> nodeToBoneIndex;
-    std::vector<Vertex> vertices;
-    std::unordered_map<int, std::vector<Vertex>> verticesPerMesh;
+    std::unordered_map<int, std::vector<GLTFMesh::PrimitiveGeometry>> primitivesPerMesh; // parallel to each mesh's primitives
     const float tolerance = 1e-4f;
 };
 
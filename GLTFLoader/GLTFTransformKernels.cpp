@@ -0,0 +1,397 @@
+#include "GLTFTransformKernels.h"
+#include "GLTFSimd.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <glm/gtc/matrix_transform.hpp>
+
+#ifdef GLM_FORCE_QUAT_DATA_WXYZ
+#error "GLTFTransformKernels loads quaternions as x, y, z, w"
+#endif
+
+namespace {
+    inline void composeScalar(const glm::vec3& t, const glm::quat& r, const glm::vec3& s, glm::mat4& out) {
+        // Same terms as glm::mat3_cast, with the scale folded into the columns
+        float xx = r.x * r.x, yy = r.y * r.y, zz = r.z * r.z;
+        float xy = r.x * r.y, xz = r.x * r.z, yz = r.y * r.z;
+        float wx = r.w * r.x, wy = r.w * r.y, wz = r.w * r.z;
+        out[0] = glm::vec4((1.0f - 2.0f * (yy + zz)) * s.x, 2.0f * (xy + wz) * s.x, 2.0f * (xz - wy) * s.x, 0.0f);
+        out[1] = glm::vec4(2.0f * (xy - wz) * s.y, (1.0f - 2.0f * (xx + zz)) * s.y, 2.0f * (yz + wx) * s.y, 0.0f);
+        out[2] = glm::vec4(2.0f * (xz + wy) * s.z, 2.0f * (yz - wx) * s.z, (1.0f - 2.0f * (xx + yy)) * s.z, 0.0f);
+        out[3] = glm::vec4(t, 1.0f);
+    }
+
+    // The fourth row of an affine b is (0, 0, 0, 1), so a's translation column only reaches out[3]
+    inline void multiplyScalar(const glm::mat4& a, const glm::mat4& b, glm::mat4& out) {
+        glm::mat4 result;
+        result[0] = a[0] * b[0].x + a[1] * b[0].y + a[2] * b[0].z;
+        result[1] = a[0] * b[1].x + a[1] * b[1].y + a[2] * b[1].z;
+        result[2] = a[0] * b[2].x + a[1] * b[2].y + a[2] * b[2].z;
+        result[3] = a[0] * b[3].x + a[1] * b[3].y + a[2] * b[3].z + a[3];
+        out = result;
+    }
+
+    void composeTRSScalar(const glm::vec3* t, const glm::quat* r, const glm::vec3* s, glm::mat4* out, size_t begin, size_t count, const int* indices) {
+        for (size_t i = begin; i < count; ++i) {
+            size_t k = indices ? static_cast<size_t>(indices[i]) : i;
+            composeScalar(t[k], r[k], s[k], out[k]);
+        }
+    }
+
+#if defined(GLTF_SIMD_X86)
+    // Transposes four (x, y, z, w) component vectors of four nodes into each node's column and stores it
+    inline void storeColumnsSSE(__m128 x, __m128 y, __m128 z, __m128 w, glm::mat4* out, const size_t* nodes, int column) {
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        _mm_storeu_ps(&out[nodes[0]][column][0], x);
+        _mm_storeu_ps(&out[nodes[1]][column][0], y);
+        _mm_storeu_ps(&out[nodes[2]][column][0], z);
+        _mm_storeu_ps(&out[nodes[3]][column][0], w);
+    }
+
+    void composeTRSSSE(const glm::vec3* t, const glm::quat* r, const glm::vec3* s, glm::mat4* out, size_t count, const int* indices) {
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 two = _mm_set1_ps(2.0f);
+        const __m128 zero = _mm_setzero_ps();
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            size_t k[4];
+            for (int j = 0; j < 4; ++j) k[j] = indices ? static_cast<size_t>(indices[i + j]) : i + j;
+
+            // Four quaternions in, one register per component out
+            __m128 qx = _mm_loadu_ps(&r[k[0]].x);
+            __m128 qy = _mm_loadu_ps(&r[k[1]].x);
+            __m128 qz = _mm_loadu_ps(&r[k[2]].x);
+            __m128 qw = _mm_loadu_ps(&r[k[3]].x);
+            _MM_TRANSPOSE4_PS(qx, qy, qz, qw);
+
+            __m128 sx = _mm_setr_ps(s[k[0]].x, s[k[1]].x, s[k[2]].x, s[k[3]].x);
+            __m128 sy = _mm_setr_ps(s[k[0]].y, s[k[1]].y, s[k[2]].y, s[k[3]].y);
+            __m128 sz = _mm_setr_ps(s[k[0]].z, s[k[1]].z, s[k[2]].z, s[k[3]].z);
+
+            __m128 xx = _mm_mul_ps(qx, qx), yy = _mm_mul_ps(qy, qy), zz = _mm_mul_ps(qz, qz);
+            __m128 xy = _mm_mul_ps(qx, qy), xz = _mm_mul_ps(qx, qz), yz = _mm_mul_ps(qy, qz);
+            __m128 wx = _mm_mul_ps(qw, qx), wy = _mm_mul_ps(qw, qy), wz = _mm_mul_ps(qw, qz);
+
+            __m128 m00 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+            __m128 m01 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+            __m128 m02 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+            __m128 m10 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+            __m128 m11 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+            __m128 m12 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+            __m128 m20 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+            __m128 m21 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+            __m128 m22 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+
+            storeColumnsSSE(m00, m01, m02, zero, out, k, 0);
+            storeColumnsSSE(m10, m11, m12, zero, out, k, 1);
+            storeColumnsSSE(m20, m21, m22, zero, out, k, 2);
+            for (int j = 0; j < 4; ++j) out[k[j]][3] = glm::vec4(t[k[j]], 1.0f);
+        }
+        composeTRSScalar(t, r, s, out, i, count, indices);
+    }
+
+    GLTF_TARGET_AVX2 void composeTRSAVX2(const glm::vec3* t, const glm::quat* r, const glm::vec3* s, glm::mat4* out, size_t count, const int* indices) {
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 two = _mm256_set1_ps(2.0f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const float* rotationBase = &r[0].x;
+        const float* scaleBase = &s[0].x;
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            size_t k[8];
+            __m256i node;
+            if (indices) {
+                node = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + i));
+                for (int j = 0; j < 8; ++j) k[j] = static_cast<size_t>(indices[i + j]);
+            }
+            else {
+                node = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(i)), lanes);
+                for (int j = 0; j < 8; ++j) k[j] = i + j;
+            }
+
+            // Gathers pull one component of eight nodes straight into a register
+            __m256i quatOffset = _mm256_slli_epi32(node, 2);
+            __m256 qx = _mm256_i32gather_ps(rotationBase + 0, quatOffset, 4);
+            __m256 qy = _mm256_i32gather_ps(rotationBase + 1, quatOffset, 4);
+            __m256 qz = _mm256_i32gather_ps(rotationBase + 2, quatOffset, 4);
+            __m256 qw = _mm256_i32gather_ps(rotationBase + 3, quatOffset, 4);
+            __m256i vec3Offset = _mm256_add_epi32(_mm256_slli_epi32(node, 1), node);
+            __m256 sx = _mm256_i32gather_ps(scaleBase + 0, vec3Offset, 4);
+            __m256 sy = _mm256_i32gather_ps(scaleBase + 1, vec3Offset, 4);
+            __m256 sz = _mm256_i32gather_ps(scaleBase + 2, vec3Offset, 4);
+
+            __m256 xx = _mm256_mul_ps(qx, qx), yy = _mm256_mul_ps(qy, qy), zz = _mm256_mul_ps(qz, qz);
+            __m256 xy = _mm256_mul_ps(qx, qy), xz = _mm256_mul_ps(qx, qz), yz = _mm256_mul_ps(qy, qz);
+            __m256 wx = _mm256_mul_ps(qw, qx), wy = _mm256_mul_ps(qw, qy), wz = _mm256_mul_ps(qw, qz);
+
+            __m256 m[9];
+            m[0] = _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(yy, zz), one), sx);
+            m[1] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xy, wz)), sx);
+            m[2] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xz, wy)), sx);
+            m[3] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xy, wz)), sy);
+            m[4] = _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(xx, zz), one), sy);
+            m[5] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(yz, wx)), sy);
+            m[6] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xz, wy)), sz);
+            m[7] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(yz, wx)), sz);
+            m[8] = _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(xx, yy), one), sz);
+
+            // Back to columns: each 128-bit half holds four nodes and transposes like the SSE path
+            for (int column = 0; column < 3; ++column) {
+                const __m256* c = &m[column * 3];
+                storeColumnsSSE(_mm256_castps256_ps128(c[0]), _mm256_castps256_ps128(c[1]), _mm256_castps256_ps128(c[2]), zero, out, k, column);
+                storeColumnsSSE(_mm256_extractf128_ps(c[0], 1), _mm256_extractf128_ps(c[1], 1), _mm256_extractf128_ps(c[2], 1), zero, out, k + 4, column);
+            }
+            for (int j = 0; j < 8; ++j) out[k[j]][3] = glm::vec4(t[k[j]], 1.0f);
+        }
+        composeTRSScalar(t, r, s, out, i, count, indices);
+    }
+
+    inline void multiplySSE(const float* a, const float* b, float* out) {
+        __m128 a0 = _mm_loadu_ps(a + 0);
+        __m128 a1 = _mm_loadu_ps(a + 4);
+        __m128 a2 = _mm_loadu_ps(a + 8);
+        __m128 a3 = _mm_loadu_ps(a + 12);
+        for (int column = 0; column < 4; ++column) {
+            __m128 bc = _mm_loadu_ps(b + column * 4);
+            __m128 result = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(a0, _mm_shuffle_ps(bc, bc, 0x00)), _mm_mul_ps(a1, _mm_shuffle_ps(bc, bc, 0x55))),
+                _mm_mul_ps(a2, _mm_shuffle_ps(bc, bc, 0xAA)));
+            if (column == 3) result = _mm_add_ps(result, a3);
+            _mm_storeu_ps(out + column * 4, result);
+        }
+    }
+
+    // Two columns of b per register: a's columns are broadcast to both halves and each half splats its own
+    // column's x, y and z. Column 2 has w = 0, so adding a3 * w only affects column 3.
+    GLTF_TARGET_AVX2 inline void multiplyAVX2(const float* a, const float* b, float* out) {
+        __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 0));
+        __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 4));
+        __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 8));
+        __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 12));
+
+        __m256 b01 = _mm256_loadu_ps(b);
+        __m256 b23 = _mm256_loadu_ps(b + 8);
+        __m256 out01 = _mm256_fmadd_ps(a0, _mm256_permute_ps(b01, 0x00),
+            _mm256_fmadd_ps(a1, _mm256_permute_ps(b01, 0x55), _mm256_mul_ps(a2, _mm256_permute_ps(b01, 0xAA))));
+        __m256 out23 = _mm256_fmadd_ps(a0, _mm256_permute_ps(b23, 0x00),
+            _mm256_fmadd_ps(a1, _mm256_permute_ps(b23, 0x55),
+                _mm256_fmadd_ps(a2, _mm256_permute_ps(b23, 0xAA), _mm256_mul_ps(a3, _mm256_permute_ps(b23, 0xFF)))));
+        _mm256_storeu_ps(out, out01);
+        _mm256_storeu_ps(out + 8, out23);
+    }
+
+    GLTF_TARGET_AVX2 void multiplyArrayAVX2(const glm::mat4* a, size_t aStride, const glm::mat4* b, glm::mat4* out, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            multiplyAVX2(&a[i * aStride][0][0], &b[i][0][0], &out[i][0][0]);
+        }
+    }
+#endif
+
+    // aStride 0 multiplies every b by the same a
+    void multiplyArray(const glm::mat4* a, size_t aStride, const glm::mat4* b, glm::mat4* out, size_t count) {
+        switch (GLTFSimd::getLevel()) {
+#if defined(GLTF_SIMD_X86)
+        case GLTFSimd::Level::AVX2:
+            multiplyArrayAVX2(a, aStride, b, out, count);
+            return;
+        case GLTFSimd::Level::SSE:
+            for (size_t i = 0; i < count; ++i) {
+                multiplySSE(&a[i * aStride][0][0], &b[i][0][0], &out[i][0][0]);
+            }
+            return;
+#endif
+        default:
+            for (size_t i = 0; i < count; ++i) {
+                multiplyScalar(a[i * aStride], b[i], out[i]);
+            }
+            return;
+        }
+    }
+}
+
+namespace {
+    void blendVec3Scalar(glm::vec3* a, const glm::vec3* b, const float* weights, size_t begin, size_t count) {
+        for (size_t i = begin; i < count; ++i) a[i] += (b[i] - a[i]) * weights[i];
+    }
+
+    // With b flipped onto a's side the two are at most 90 degrees apart, so the blend never gets shorter
+    // than 1/sqrt(2) and needs no zero-length check
+    void blendQuatScalar(glm::quat* a, const glm::quat* b, const float* weights, size_t begin, size_t count) {
+        for (size_t i = begin; i < count; ++i) {
+            float sign = glm::dot(a[i], b[i]) < 0.0f ? -1.0f : 1.0f;
+            float w = weights[i];
+            float x = a[i].x + (b[i].x * sign - a[i].x) * w;
+            float y = a[i].y + (b[i].y * sign - a[i].y) * w;
+            float z = a[i].z + (b[i].z * sign - a[i].z) * w;
+            float qw = a[i].w + (b[i].w * sign - a[i].w) * w;
+            float inverseLength = 1.0f / std::sqrt(x * x + y * y + z * z + qw * qw);
+            a[i] = glm::quat(qw * inverseLength, x * inverseLength, y * inverseLength, z * inverseLength);
+        }
+    }
+
+#if defined(GLTF_SIMD_X86)
+    // Four vec3s are three registers; each gets the weights of the nodes its lanes belong to
+    void blendVec3SSE(glm::vec3* a, const glm::vec3* b, const float* weights, size_t count) {
+        float* pa = &a[0].x;
+        const float* pb = &b[0].x;
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128 w = _mm_loadu_ps(weights + i);
+            __m128 lanes[3] = {
+                _mm_shuffle_ps(w, w, _MM_SHUFFLE(1, 0, 0, 0)),
+                _mm_shuffle_ps(w, w, _MM_SHUFFLE(2, 2, 1, 1)),
+                _mm_shuffle_ps(w, w, _MM_SHUFFLE(3, 3, 3, 2)) };
+            for (int j = 0; j < 3; ++j) {
+                float* from = pa + i * 3 + j * 4;
+                __m128 x = _mm_loadu_ps(from);
+                __m128 y = _mm_loadu_ps(pb + i * 3 + j * 4);
+                _mm_storeu_ps(from, _mm_add_ps(x, _mm_mul_ps(_mm_sub_ps(y, x), lanes[j])));
+            }
+        }
+        blendVec3Scalar(a, b, weights, i, count);
+    }
+
+    void blendQuatSSE(glm::quat* a, const glm::quat* b, const float* weights, size_t count) {
+        const __m128 signBit = _mm_set1_ps(-0.0f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128 ax = _mm_loadu_ps(&a[i].x), ay = _mm_loadu_ps(&a[i + 1].x), az = _mm_loadu_ps(&a[i + 2].x), aw = _mm_loadu_ps(&a[i + 3].x);
+            __m128 bx = _mm_loadu_ps(&b[i].x), by = _mm_loadu_ps(&b[i + 1].x), bz = _mm_loadu_ps(&b[i + 2].x), bw = _mm_loadu_ps(&b[i + 3].x);
+            _MM_TRANSPOSE4_PS(ax, ay, az, aw);
+            _MM_TRANSPOSE4_PS(bx, by, bz, bw);
+
+            __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_add_ps(_mm_mul_ps(az, bz), _mm_mul_ps(aw, bw)));
+            __m128 flip = _mm_and_ps(_mm_cmplt_ps(dot, zero), signBit);
+            __m128 w = _mm_loadu_ps(weights + i);
+            __m128 x = _mm_add_ps(ax, _mm_mul_ps(_mm_sub_ps(_mm_xor_ps(bx, flip), ax), w));
+            __m128 y = _mm_add_ps(ay, _mm_mul_ps(_mm_sub_ps(_mm_xor_ps(by, flip), ay), w));
+            __m128 z = _mm_add_ps(az, _mm_mul_ps(_mm_sub_ps(_mm_xor_ps(bz, flip), az), w));
+            __m128 qw = _mm_add_ps(aw, _mm_mul_ps(_mm_sub_ps(_mm_xor_ps(bw, flip), aw), w));
+            __m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_add_ps(_mm_mul_ps(z, z), _mm_mul_ps(qw, qw)));
+            __m128 inverseLength = _mm_div_ps(one, _mm_sqrt_ps(lengthSquared));
+            x = _mm_mul_ps(x, inverseLength);
+            y = _mm_mul_ps(y, inverseLength);
+            z = _mm_mul_ps(z, inverseLength);
+            qw = _mm_mul_ps(qw, inverseLength);
+
+            _MM_TRANSPOSE4_PS(x, y, z, qw);
+            _mm_storeu_ps(&a[i].x, x);
+            _mm_storeu_ps(&a[i + 1].x, y);
+            _mm_storeu_ps(&a[i + 2].x, z);
+            _mm_storeu_ps(&a[i + 3].x, qw);
+        }
+        blendQuatScalar(a, b, weights, i, count);
+    }
+#endif
+}
+
+void GLTFTransformKernels::composeTRS(const glm::vec3* translations, const glm::quat* rotations, const glm::vec3* scales,
+    glm::mat4* out, size_t count, const int* indices) {
+    switch (GLTFSimd::getLevel()) {
+#if defined(GLTF_SIMD_X86)
+    case GLTFSimd::Level::AVX2: composeTRSAVX2(translations, rotations, scales, out, count, indices); break;
+    case GLTFSimd::Level::SSE: composeTRSSSE(translations, rotations, scales, out, count, indices); break;
+#endif
+    default: composeTRSScalar(translations, rotations, scales, out, 0, count, indices); break;
+    }
+}
+
+void GLTFTransformKernels::multiplyAffine(const glm::mat4* a, const glm::mat4* b, glm::mat4* out, size_t count) {
+    multiplyArray(a, 1, b, out, count);
+}
+
+void GLTFTransformKernels::multiplyAffine(const glm::mat4& a, const glm::mat4* b, glm::mat4* out, size_t count) {
+    multiplyArray(&a, 0, b, out, count);
+}
+
+void GLTFTransformKernels::computePalette(const glm::mat4* globals, const glm::mat4* inverseBindMatrices, glm::mat4* palette, size_t count) {
+    multiplyArray(globals, 1, inverseBindMatrices, palette, count);
+}
+
+// Blending streams each element once and is bound by memory rather than arithmetic, so AVX2 machines use
+// the SSE kernels too
+void GLTFTransformKernels::blendVec3(glm::vec3* a, const glm::vec3* b, const float* weights, size_t count) {
+    switch (GLTFSimd::getLevel()) {
+#if defined(GLTF_SIMD_X86)
+    case GLTFSimd::Level::AVX2:
+    case GLTFSimd::Level::SSE: blendVec3SSE(a, b, weights, count); break;
+#endif
+    default: blendVec3Scalar(a, b, weights, 0, count); break;
+    }
+}
+
+void GLTFTransformKernels::blendQuat(glm::quat* a, const glm::quat* b, const float* weights, size_t count) {
+    switch (GLTFSimd::getLevel()) {
+#if defined(GLTF_SIMD_X86)
+    case GLTFSimd::Level::AVX2:
+    case GLTFSimd::Level::SSE: blendQuatSSE(a, b, weights, count); break;
+#endif
+    default: blendQuatScalar(a, b, weights, 0, count); break;
+    }
+}
+
+void GLTFTransformKernels::runBenchmark(size_t count, int iterations) {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::vector<glm::vec3> translations(count), scales(count);
+    std::vector<glm::quat> rotations(count);
+    for (size_t i = 0; i < count; ++i) {
+        translations[i] = glm::vec3(unit(rng), unit(rng), unit(rng)) * 10.0f;
+        rotations[i] = glm::normalize(glm::quat(unit(rng), unit(rng), unit(rng), unit(rng)));
+        scales[i] = glm::vec3(1.0f + 0.5f * unit(rng));
+    }
+
+    std::vector<glm::mat4> reference(count), result(count), inverseBind(count), palette(count), referencePalette(count);
+    for (size_t i = 0; i < count; ++i) {
+        inverseBind[i] = glm::inverse(glm::translate(glm::mat4(1.0f), translations[i]) * glm::mat4_cast(rotations[i]));
+    }
+
+    auto time = [&](auto&& body) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int iteration = 0; iteration < iterations; ++iteration) body();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+    };
+    auto maxError = [&](const std::vector<glm::mat4>& a, const std::vector<glm::mat4>& b) {
+        float error = 0.0f;
+        for (size_t i = 0; i < count; ++i) {
+            for (int column = 0; column < 4; ++column) {
+                glm::vec4 d = glm::abs(a[i][column] - b[i][column]);
+                error = std::max(error, std::max(std::max(d.x, d.y), std::max(d.z, d.w)));
+            }
+        }
+        return error;
+    };
+
+    // The path the loader used before: three full products to compose, one more per joint
+    double composeBaseline = time([&] {
+        for (size_t i = 0; i < count; ++i) {
+            reference[i] = glm::translate(glm::mat4(1.0f), translations[i]) * glm::mat4_cast(rotations[i]) * glm::scale(glm::mat4(1.0f), scales[i]);
+        }
+    });
+    double paletteBaseline = time([&] {
+        for (size_t i = 0; i < count; ++i) referencePalette[i] = reference[i] * inverseBind[i];
+    });
+    std::cout << "Transform kernels, " << count << " matrices:" << std::endl;
+    std::cout << "  glm       compose " << composeBaseline << " ms, palette " << paletteBaseline << " ms" << std::endl;
+
+    const GLTFSimd::Level levels[] = { GLTFSimd::Level::Scalar, GLTFSimd::Level::SSE, GLTFSimd::Level::AVX2 };
+    const GLTFSimd::Level supported = GLTFSimd::getLevel();
+    for (GLTFSimd::Level level : levels) {
+        if (level > supported) break;
+        GLTFSimd::setLevelOverride(level);
+        double compose = time([&] { composeTRS(translations.data(), rotations.data(), scales.data(), result.data(), count); });
+        double paletteTime = time([&] { computePalette(reference.data(), inverseBind.data(), palette.data(), count); });
+        std::cout << "  " << GLTFSimd::getLevelName(level) << "  compose " << compose << " ms (x" << composeBaseline / compose
+            << "), palette " << paletteTime << " ms (x" << paletteBaseline / paletteTime << "), max error "
+            << std::max(maxError(result, reference), maxError(palette, referencePalette)) << std::endl;
+    }
+    GLTFSimd::clearLevelOverride();
+}
@@ -0,0 +1,36 @@
+#ifndef GLTF_TRANSFORM_KERNELS_H
+#define GLTF_TRANSFORM_KERNELS_H
+
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Batched transform math for node hierarchies and skinning palettes. Every matrix here is affine (bottom
+// row 0 0 0 1), so only the top three rows are computed. Each call picks a scalar, SSE or AVX2 kernel
+// through GLTFSimd; all of them produce the same results up to float rounding.
+class GLTFTransformKernels {
+public:
+    // out[i] = translate(t[i]) * mat4_cast(r[i]) * scale(s[i]), without the intermediate matrices. With an
+    // index list, only elements indices[0..count) are read and written, in place.
+    static void composeTRS(const glm::vec3* translations, const glm::quat* rotations, const glm::vec3* scales,
+        glm::mat4* out, size_t count, const int* indices = nullptr);
+
+    // out[i] = a[i] * b[i]
+    static void multiplyAffine(const glm::mat4* a, const glm::mat4* b, glm::mat4* out, size_t count);
+    // out[i] = a * b[i]
+    static void multiplyAffine(const glm::mat4& a, const glm::mat4* b, glm::mat4* out, size_t count);
+
+    // Skinning palette: palette[i] = globals[i] * inverseBindMatrices[i]
+    static void computePalette(const glm::mat4* globals, const glm::mat4* inverseBindMatrices, glm::mat4* palette, size_t count);
+
+    // Pose blending, in place: a[i] moves towards b[i] by weights[i] (0 keeps a, 1 gives b). Vectors lerp;
+    // rotations nlerp along the shorter arc, so a and b need not share a hemisphere.
+    static void blendVec3(glm::vec3* a, const glm::vec3* b, const float* weights, size_t count);
+    static void blendQuat(glm::quat* a, const glm::quat* b, const float* weights, size_t count);
+
+    // Times the glm path (translate * mat4_cast * scale, full 4x4 products) against every kernel level the
+    // CPU supports and prints the results
+    static void runBenchmark(size_t count = 100000, int iterations = 20);
+};
+
+#endif // GLTF_TRANSFORM_KERNELS_H
@@ -0,0 +1,358 @@
+#include "GLTFTriangleBVH.h"
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <thread>
+
+namespace {
+    const int kSahBins = 12;
+    const size_t kMaxLeafTriangles = 8;
+    const size_t kParallelThreshold = 4096; // smaller subtrees are not worth a thread
+    // Deeper nodes are made leaves, so a traversal never holds more than one pending node per level plus
+    // the two children of the node being expanded
+    const int kMaxDepth = 60;
+    const int kStackSize = kMaxDepth + 2;
+
+    // Entry distance of the ray into the node's box, or FLT_MAX on a miss
+    inline float intersectBox(const glm::vec3& min, const glm::vec3& max, const glm::vec3& origin,
+        const glm::vec3& inverseDirection, float maxDistance) {
+        glm::vec3 t0 = (min - origin) * inverseDirection;
+        glm::vec3 t1 = (max - origin) * inverseDirection;
+        glm::vec3 tMin = glm::min(t0, t1);
+        glm::vec3 tMax = glm::max(t0, t1);
+        float enter = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0f));
+        float exit = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, maxDistance));
+        return enter <= exit ? enter : FLT_MAX;
+    }
+
+    // Moller-Trumbore; both faces count as hits
+    inline bool intersectTriangle(const glm::vec3& v0, const glm::vec3& edge1, const glm::vec3& edge2,
+        const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float& t, float& u, float& v) {
+        glm::vec3 p = glm::cross(direction, edge2);
+        float determinant = glm::dot(edge1, p);
+        if (std::abs(determinant) < 1e-12f) return false;
+
+        float inverseDeterminant = 1.0f / determinant;
+        glm::vec3 s = origin - v0;
+        u = glm::dot(s, p) * inverseDeterminant;
+        if (u < 0.0f || u > 1.0f) return false;
+
+        glm::vec3 q = glm::cross(s, edge1);
+        v = glm::dot(direction, q) * inverseDeterminant;
+        if (v < 0.0f || u + v > 1.0f) return false;
+
+        t = glm::dot(edge2, q) * inverseDeterminant;
+        return t >= 0.0f && t < maxDistance;
+    }
+}
+
+void GLTFTriangleBVH::build(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices) {
+    clear();
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) return;
+
+    BuildInput input;
+    input.bounds.resize(triangleCount);
+    input.centroids.resize(triangleCount);
+    triangleIds.resize(triangleCount);
+    for (size_t i = 0; i < triangleCount; ++i) {
+        AABB& bounds = input.bounds[i];
+        bounds.expand(positions[indices[i * 3 + 0]]);
+        bounds.expand(positions[indices[i * 3 + 1]]);
+        bounds.expand(positions[indices[i * 3 + 2]]);
+        input.centroids[i] = bounds.center();
+        triangleIds[i] = static_cast<unsigned int>(i);
+    }
+
+    nodes.reserve(triangleCount * 2 / 3);
+    buildRecursive(nodes, input, 0, triangleCount, 0);
+
+    triangleIndices.resize(triangleCount * 3);
+    for (size_t i = 0; i < triangleCount; ++i) {
+        triangleIndices[i * 3 + 0] = indices[triangleIds[i] * 3 + 0];
+        triangleIndices[i * 3 + 1] = indices[triangleIds[i] * 3 + 1];
+        triangleIndices[i * 3 + 2] = indices[triangleIds[i] * 3 + 2];
+    }
+    triangles.resize(triangleCount);
+    updateTriangles(positions);
+}
+
+void GLTFTriangleBVH::buildRecursive(std::vector<Node>& out, const BuildInput& input, size_t begin, size_t end, int depth) {
+    AABB bounds;
+    for (size_t i = begin; i < end; ++i) {
+        bounds.merge(input.bounds[triangleIds[i]]);
+    }
+
+    size_t nodeIndex = out.size();
+    out.push_back(Node{ bounds.min, static_cast<int>(begin), bounds.max, static_cast<int>(end - begin) });
+
+    size_t mid = depth < kMaxDepth ? partitionSAH(input, begin, end, bounds) : begin;
+    if (mid == begin) return; // cheaper as a leaf, or as deep as traversal stacks go
+
+    out[nodeIndex].count = 0;
+
+    // Subtrees work on disjoint ranges of triangleIds, so the left one can be built on another thread
+    // into its own node list and spliced in afterwards
+    static const int maxParallelDepth = [] {
+        unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+        int depth = 0;
+        while ((1u << depth) < threads) depth++;
+        return depth;
+    }();
+
+    if (end - begin >= kParallelThreshold && depth < maxParallelDepth) {
+        std::vector<Node> leftNodes;
+        std::vector<Node> rightNodes;
+        auto left = std::async(std::launch::async, [&] {
+            buildRecursive(leftNodes, input, begin, mid, depth + 1);
+        });
+        buildRecursive(rightNodes, input, mid, end, depth + 1);
+        left.get();
+
+        // Child lists index their right children from 0; shift them to where they land in out
+        int leftOffset = static_cast<int>(out.size());
+        for (Node& node : leftNodes) {
+            if (node.count == 0) node.leftOrFirst += leftOffset;
+        }
+        out.insert(out.end(), leftNodes.begin(), leftNodes.end());
+
+        int rightOffset = static_cast<int>(out.size());
+        for (Node& node : rightNodes) {
+            if (node.count == 0) node.leftOrFirst += rightOffset;
+        }
+        out[nodeIndex].leftOrFirst = rightOffset;
+        out.insert(out.end(), rightNodes.begin(), rightNodes.end());
+    }
+    else {
+        buildRecursive(out, input, begin, mid, depth + 1);
+        out[nodeIndex].leftOrFirst = static_cast<int>(out.size());
+        buildRecursive(out, input, mid, end, depth + 1);
+    }
+}
+
+size_t GLTFTriangleBVH::partitionSAH(const BuildInput& input, size_t begin, size_t end, const AABB& bounds) {
+    size_t count = end - begin;
+    if (count <= 2) return count == 2 ? begin + 1 : begin;
+
+    AABB centroidBounds;
+    for (size_t i = begin; i < end; ++i) {
+        centroidBounds.expand(input.centroids[triangleIds[i]]);
+    }
+
+    // Try every axis; triangle meshes are too irregular for the widest one to always win
+    float bestCost = FLT_MAX;
+    int bestAxis = -1;
+    int bestSplit = -1;
+    for (int axis = 0; axis < 3; ++axis) {
+        float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+        if (extent <= 0.0f) continue;
+        float scale = kSahBins / extent;
+
+        AABB binBounds[kSahBins];
+        size_t binCounts[kSahBins] = {};
+        for (size_t i = begin; i < end; ++i) {
+            unsigned int triangle = triangleIds[i];
+            int bin = std::min(kSahBins - 1, static_cast<int>((input.centroids[triangle][axis] - centroidBounds.min[axis]) * scale));
+            binBounds[bin].merge(input.bounds[triangle]);
+            binCounts[bin]++;
+        }
+
+        float rightCost[kSahBins] = {};
+        AABB accumulated;
+        size_t accumulatedCount = 0;
+        for (int bin = kSahBins - 1; bin > 0; --bin) {
+            accumulated.merge(binBounds[bin]);
+            accumulatedCount += binCounts[bin];
+            rightCost[bin] = accumulated.surfaceArea() * accumulatedCount;
+        }
+
+        accumulated = AABB();
+        accumulatedCount = 0;
+        for (int bin = 0; bin < kSahBins - 1; ++bin) {
+            accumulated.merge(binBounds[bin]);
+            accumulatedCount += binCounts[bin];
+            if (accumulatedCount == 0 || accumulatedCount == count) continue;
+            float cost = accumulated.surfaceArea() * accumulatedCount + rightCost[bin + 1];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = bin;
+            }
+        }
+    }
+
+    // Cost relative to intersecting every triangle here, with one node visit for the split
+    float area = bounds.surfaceArea();
+    if (count <= kMaxLeafTriangles && (bestAxis < 0 || area <= 0.0f || 1.0f + bestCost / area >= static_cast<float>(count))) {
+        return begin;
+    }
+
+    unsigned int* first = triangleIds.data() + begin;
+    unsigned int* last = triangleIds.data() + end;
+    if (bestAxis >= 0) {
+        float scale = kSahBins / (centroidBounds.max[bestAxis] - centroidBounds.min[bestAxis]);
+        unsigned int* middle = std::partition(first, last, [&](unsigned int triangle) {
+            int bin = std::min(kSahBins - 1, static_cast<int>((input.centroids[triangle][bestAxis] - centroidBounds.min[bestAxis]) * scale));
+            return bin <= bestSplit;
+        });
+        size_t split = begin + static_cast<size_t>(middle - first);
+        if (split > begin && split < end) return split;
+    }
+
+    // Coincident centroids; split the list in half so leaves stay small
+    return begin + count / 2;
+}
+
+void GLTFTriangleBVH::refit(const std::vector<glm::vec3>& positions) {
+    if (nodes.empty()) return;
+    updateTriangles(positions);
+
+    // Children always come after their parent, so walking backwards is bottom-up
+    for (size_t i = nodes.size(); i-- > 0;) {
+        Node& node = nodes[i];
+        if (node.count > 0) {
+            AABB bounds;
+            for (int t = node.leftOrFirst; t < node.leftOrFirst + node.count; ++t) {
+                const Triangle& triangle = triangles[t];
+                bounds.expand(triangle.v0);
+                bounds.expand(triangle.v0 + triangle.edge1);
+                bounds.expand(triangle.v0 + triangle.edge2);
+            }
+            node.min = bounds.min;
+            node.max = bounds.max;
+        }
+        else {
+            const Node& left = nodes[i + 1];
+            const Node& right = nodes[node.leftOrFirst];
+            node.min = glm::min(left.min, right.min);
+            node.max = glm::max(left.max, right.max);
+        }
+    }
+}
+
+void GLTFTriangleBVH::updateTriangles(const std::vector<glm::vec3>& positions) {
+    for (size_t i = 0; i < triangles.size(); ++i) {
+        const glm::vec3& a = positions[triangleIndices[i * 3 + 0]];
+        const glm::vec3& b = positions[triangleIndices[i * 3 + 1]];
+        const glm::vec3& c = positions[triangleIndices[i * 3 + 2]];
+        triangles[i] = Triangle{ a, b - a, c - a };
+    }
+}
+
+void GLTFTriangleBVH::clear() {
+    nodes.clear();
+    triangles.clear();
+    triangleIds.clear();
+    triangleIndices.clear();
+}
+
+bool GLTFTriangleBVH::isEmpty() const {
+    return nodes.empty();
+}
+
+bool GLTFTriangleBVH::intersect(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Hit& hit) const {
+    if (nodes.empty()) return false;
+
+    const glm::vec3 inverseDirection = 1.0f / direction;
+    float closest = maxDistance;
+    int closestTriangle = -1;
+    float closestU = 0.0f;
+    float closestV = 0.0f;
+
+    int stack[kStackSize];
+    int stackSize = 0;
+    int nodeIndex = 0;
+    if (intersectBox(nodes[0].min, nodes[0].max, origin, inverseDirection, closest) == FLT_MAX) return false;
+
+    while (true) {
+        const Node& node = nodes[nodeIndex];
+        if (node.count > 0) {
+            for (int i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i) {
+                const Triangle& triangle = triangles[i];
+                float t, u, v;
+                if (intersectTriangle(triangle.v0, triangle.edge1, triangle.edge2, origin, direction, closest, t, u, v)) {
+                    closest = t;
+                    closestTriangle = i;
+                    closestU = u;
+                    closestV = v;
+                }
+            }
+        }
+        else {
+            // Visit the nearer child first so the far one is often rejected by the shortened ray
+            int near = nodeIndex + 1;
+            int far = node.leftOrFirst;
+            float nearDistance = intersectBox(nodes[near].min, nodes[near].max, origin, inverseDirection, closest);
+            float farDistance = intersectBox(nodes[far].min, nodes[far].max, origin, inverseDirection, closest);
+            if (farDistance < nearDistance) {
+                std::swap(near, far);
+                std::swap(nearDistance, farDistance);
+            }
+
+            if (nearDistance != FLT_MAX) {
+                if (farDistance != FLT_MAX) stack[stackSize++] = far;
+                nodeIndex = near;
+                continue;
+            }
+        }
+
+        // Pushed nodes were tested against a longer ray; recheck them against the closest hit so far
+        bool found = false;
+        while (stackSize > 0) {
+            nodeIndex = stack[--stackSize];
+            if (intersectBox(nodes[nodeIndex].min, nodes[nodeIndex].max, origin, inverseDirection, closest) != FLT_MAX) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) break;
+    }
+
+    if (closestTriangle < 0) return false;
+    hit.distance = closest;
+    hit.triangle = static_cast<int>(triangleIds[closestTriangle]);
+    hit.barycentrics = glm::vec2(closestU, closestV);
+    return true;
+}
+
+bool GLTFTriangleBVH::intersectAny(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const {
+    if (nodes.empty()) return false;
+
+    const glm::vec3 inverseDirection = 1.0f / direction;
+    int stack[kStackSize];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        const Node& node = nodes[stack[--stackSize]];
+        if (intersectBox(node.min, node.max, origin, inverseDirection, maxDistance) == FLT_MAX) continue;
+
+        if (node.count > 0) {
+            for (int i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i) {
+                const Triangle& triangle = triangles[i];
+                float t, u, v;
+                if (intersectTriangle(triangle.v0, triangle.edge1, triangle.edge2, origin, direction, maxDistance, t, u, v)) {
+                    return true;
+                }
+            }
+        }
+        else {
+            stack[stackSize++] = node.leftOrFirst;
+            stack[stackSize++] = static_cast<int>(&node - nodes.data()) + 1;
+        }
+    }
+    return false;
+}
+
+AABB GLTFTriangleBVH::getBounds() const {
+    AABB bounds;
+    if (!nodes.empty()) {
+        bounds.min = nodes[0].min;
+        bounds.max = nodes[0].max;
+    }
+    return bounds;
+}
+
+size_t GLTFTriangleBVH::getNodeCount() const {
+    return nodes.size();
+}
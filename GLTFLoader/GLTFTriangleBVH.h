@@ -0,0 +1,66 @@
+#ifndef GLTF_TRIANGLE_BVH_H
+#define GLTF_TRIANGLE_BVH_H
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "GLTFBounds.h"
+
+// Bounding volume hierarchy over the triangles of one primitive, for ray casts and picking. Built with
+// binned SAH, with large subtrees built on worker threads. Skinned primitives keep the topology and only
+// refit the boxes when the pose changes.
+class GLTFTriangleBVH {
+public:
+    struct Hit {
+        float distance = FLT_MAX;             // in units of the ray direction
+        int triangle = -1;                    // index into the primitive's triangle list (indices / 3)
+        glm::vec2 barycentrics = glm::vec2(0.0f); // weights of the triangle's second and third vertex
+    };
+
+    void build(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices);
+    // Same triangles, moved vertices (e.g. a CPU-skinned pose). Tree quality degrades if the pose is far
+    // from the one it was built for, but the results stay exact.
+    void refit(const std::vector<glm::vec3>& positions);
+    void clear();
+    bool isEmpty() const;
+
+    // Closest hit closer than maxDistance; hit is only written when something is found
+    bool intersect(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Hit& hit) const;
+    // Any hit closer than maxDistance, for occlusion and line-of-sight tests
+    bool intersectAny(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const;
+
+    AABB getBounds() const;
+    size_t getNodeCount() const;
+
+private:
+    // Interior nodes keep the left child right after themselves and store the right child in leftOrFirst.
+    // Leaves (count > 0) cover count triangles starting at leftOrFirst.
+    struct Node {
+        glm::vec3 min;
+        int leftOrFirst;
+        glm::vec3 max;
+        int count;
+    };
+
+    // Pre-transformed for the Moller-Trumbore test, in leaf order
+    struct Triangle {
+        glm::vec3 v0;
+        glm::vec3 edge1;
+        glm::vec3 edge2;
+    };
+
+    struct BuildInput {
+        std::vector<AABB> bounds;
+        std::vector<glm::vec3> centroids;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<Triangle> triangles;
+    std::vector<unsigned int> triangleIds;     // leaf order -> original triangle
+    std::vector<unsigned int> triangleIndices; // leaf order, three per triangle, for refits
+
+    void buildRecursive(std::vector<Node>& out, const BuildInput& input, size_t begin, size_t end, int depth);
+    size_t partitionSAH(const BuildInput& input, size_t begin, size_t end, const AABB& bounds); // returns begin for a leaf
+    void updateTriangles(const std::vector<glm::vec3>& positions);
+};
+
+#endif // GLTF_TRIANGLE_BVH_H
@@ -1,5 +1,10 @@
 #include "GameLoop.h"
 #include "GLTF2.h"
+#include "GLTFTransformKernels.h"
+#include "GLTFAnimation.h"
+#include "ModelAsset.h"
+#include "ModelInstanceBatch.h"
+#include <cstring>
 
 COMP_SYSTEM SYS;
 CCamera Camera;
@@ -119,6 +124,25 @@ void loadTestAssets() { // temporary until a more robust resource manager is bui
 
 }
 
+bool hasArgument(int argc, char** argv, const char* name) {
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], name) == 0) return true;
+	}
+	return false;
+}
+
+// Started with --benchmark: prints the micro-benchmarks instead of running the viewer
+void runBenchmarks() {
+	GLTFTransformKernels::runBenchmark();
+	GLTFAnimation::runKeyframeBenchmark();
+	try {
+		ModelInstanceBatch::runBenchmark(ModelAsset::load(ASSETS_DIRECTORY "soldier.glb"));
+	}
+	catch (const std::exception& e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+	}
+}
+
 
 void GameLoop::initialize(int argc, char** argv) {
 	std::cout << "Initializing Game Loop" << std::endl;
@@ -156,6 +180,10 @@ void GameLoop::initialize(int argc, char** argv) {
 	ShowCursor(SYS.COMP_SETTINGS.show);
 	pGL.loadOpenGLFunctions();
 
+	if (hasArgument(argc, argv, "--benchmark")) {
+		runBenchmarks();
+		return;
+	}
 
 	loadTestAssets();
 
@@ -0,0 +1,95 @@
+#include "ModelAsset.h"
+#include "ModelInstance.h"
+
+std::shared_ptr<const ModelAsset> ModelAsset::load(const std::string& filepath, const GLTFLoader::ImportSettings& settings) {
+    std::shared_ptr<ModelAsset> asset(new ModelAsset());
+    asset->loader = std::make_unique<GLTFLoader>();
+    asset->loader->setImportSettings(settings);
+    asset->loader->loadModel(filepath);
+    asset->loader->initialize();
+
+    // The pose the file describes, morph weights included, as the loader captured it before animating
+    const GLTFNode& nodeManager = asset->loader->getNodeManager();
+    const size_t nodeCount = nodeManager.getNodes().size();
+    asset->restPose = asset->loader->getRestPose();
+    asset->parents.resize(nodeCount);
+    for (size_t i = 0; i < nodeCount; ++i) asset->parents[i] = nodeManager.findParentNodeIndex(static_cast<int>(i));
+    asset->evaluationOrder = nodeManager.getTopologicalOrder();
+
+    for (const auto& bone : asset->loader->getSkeleton().getBones()) {
+        asset->joints.push_back({ bone.nodeIndex, bone.skeletonRootParent, bone.inverseBindMatrix });
+    }
+    asset->computeBoneSizes();
+
+    std::cout << "Model asset " << filepath << ": " << nodeCount << " nodes, " << asset->joints.size()
+        << " joints, " << asset->getAnimations().getAnimationCount() << " animations" << std::endl;
+    return asset;
+}
+
+void ModelAsset::computeBoneSizes() {
+    // Bind-pose boxes of what each joint moves, over every primitive, against the box of the whole model
+    std::vector<AABB> jointBoxes(joints.size());
+    AABB modelBox;
+    for (const auto& meshPair : loader->getSkeleton().getPrimitiveGeometry()) {
+        for (const auto& geometry : meshPair.second) {
+            modelBox.merge(geometry.bounds);
+            for (const auto& joint : geometry.jointBounds) {
+                if (joint.joint >= 0 && joint.joint < static_cast<int>(jointBoxes.size())) jointBoxes[joint.joint].merge(joint.bounds);
+            }
+        }
+    }
+    const float modelSize = modelBox.isEmpty() ? 0.0f : glm::length(modelBox.size());
+
+    const auto& nodes = loader->getNodeManager().getNodes();
+    boneSizes.assign(parents.size(), 0.0f);
+    for (size_t i = 0; i < nodes.size() && i < boneSizes.size(); ++i) {
+        if (nodes[i].meshIndex >= 0) boneSizes[i] = 1.0f;
+    }
+    for (size_t j = 0; j < joints.size(); ++j) {
+        int node = joints[j].node;
+        if (node < 0 || node >= static_cast<int>(boneSizes.size()) || jointBoxes[j].isEmpty()) continue;
+        float size = modelSize > 0.0f ? glm::length(jointBoxes[j].size()) / modelSize : 1.0f;
+        boneSizes[node] = std::max(boneSizes[node], size);
+    }
+    // Children before parents, so a parent is at least as large as anything hanging off it
+    for (auto it = evaluationOrder.rbegin(); it != evaluationOrder.rend(); ++it) {
+        int parent = parents[*it];
+        if (parent >= 0) boneSizes[parent] = std::max(boneSizes[parent], boneSizes[*it]);
+    }
+}
+
+void ModelAsset::render(const ModelInstance& instance) const {
+    loader->renderPose(instance.getNodeWorlds(), instance.getJointMatrices(), instance.getTransform());
+}
+
+size_t ModelAsset::getNodeCount() const {
+    return parents.size();
+}
+
+const GLTFAnimation::Pose& ModelAsset::getRestPose() const {
+    return restPose;
+}
+
+const std::vector<int>& ModelAsset::getEvaluationOrder() const {
+    return evaluationOrder;
+}
+
+const std::vector<int>& ModelAsset::getParents() const {
+    return parents;
+}
+
+const std::vector<ModelAsset::Joint>& ModelAsset::getJoints() const {
+    return joints;
+}
+
+const std::vector<float>& ModelAsset::getBoneSizes() const {
+    return boneSizes;
+}
+
+const GLTFAnimation& ModelAsset::getAnimations() const {
+    return loader->getAnimationManager();
+}
+
+const GLTFLoader& ModelAsset::getLoader() const {
+    return *loader;
+}
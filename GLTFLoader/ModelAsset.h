@@ -0,0 +1,54 @@
+#ifndef MODEL_ASSET_H
+#define MODEL_ASSET_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "GLTF2.h"
+
+class ModelInstance;
+
+// Everything about a model that does not change while it plays: parsed buffers, meshes, materials,
+// animation curves, the GL objects and the skeleton's bind data. Loaded once and shared by any number of
+// ModelInstances, which only carry their own pose.
+class ModelAsset {
+public:
+    struct Joint {
+        int node;
+        int rootParent; // node the skeleton is posed relative to, -1 for none
+        glm::mat4 inverseBindMatrix;
+    };
+
+    // Loads, optimizes and uploads the model; needs a current GL context, like GLTFLoader::initialize
+    static std::shared_ptr<const ModelAsset> load(const std::string& filepath,
+        const GLTFLoader::ImportSettings& settings = GLTFLoader::ImportSettings());
+
+    // Draws one instance. Drawing reuses the loader's per-frame scratch, so draws happen on the render
+    // thread one at a time.
+    void render(const ModelInstance& instance) const;
+
+    size_t getNodeCount() const;
+    const GLTFAnimation::Pose& getRestPose() const;            // local TRS and morph weights at load, by node index
+    const std::vector<int>& getEvaluationOrder() const;        // parents before children
+    const std::vector<int>& getParents() const;                // by node index, -1 for roots
+    const std::vector<Joint>& getJoints() const;               // in joint matrix order
+    // By node index: the largest share of the model, by bind-pose box diagonal, that the node or anything
+    // below it deforms. Mesh nodes count as 1. Small values mark fingers, face bones and end sites.
+    const std::vector<float>& getBoneSizes() const;
+    const GLTFAnimation& getAnimations() const;
+    const GLTFLoader& getLoader() const;
+
+private:
+    ModelAsset() = default;
+
+    std::unique_ptr<GLTFLoader> loader;
+    GLTFAnimation::Pose restPose;
+    std::vector<int> evaluationOrder;
+    std::vector<int> parents;
+    std::vector<Joint> joints;
+    std::vector<float> boneSizes;
+
+    void computeBoneSizes();
+};
+
+#endif // MODEL_ASSET_H
@@ -0,0 +1,123 @@
+#include "ModelInstance.h"
+#include "ModelAsset.h"
+#include "GLTFTransformKernels.h"
+
+ModelInstance::ModelInstance(std::shared_ptr<const ModelAsset> asset) : asset(std::move(asset)) {
+    blender.initialize(this->asset->getAnimations(), this->asset->getRestPose());
+    nodeWorlds.resize(this->asset->getNodeCount());
+    jointMatrices.resize(this->asset->getJoints().size());
+    evaluate();
+}
+
+void ModelInstance::setAnimation(const std::string& animationName) {
+    blender.crossfadeTo(asset->getAnimations().findAnimation(animationName), 0.0f);
+    blender.update(0.0f);
+    evaluate();
+}
+
+void ModelInstance::crossfadeTo(const std::string& animationName, float fadeTime) {
+    blender.crossfadeTo(asset->getAnimations().findAnimation(animationName), fadeTime);
+}
+
+void ModelInstance::setTime(float newTime) {
+    blender.setTime(newTime);
+}
+
+float ModelInstance::getTime() const {
+    return blender.getTime();
+}
+
+GLTFAnimationBlender& ModelInstance::getBlender() {
+    return blender;
+}
+
+void ModelInstance::update(float deltaTime) {
+    blender.update(deltaTime);
+    evaluate();
+}
+
+void ModelInstance::evaluate() {
+    evaluate(blender.getPose());
+}
+
+void ModelInstance::evaluate(const GLTFAnimation::Pose& pose) {
+    evaluate(pose, jointMatrices.data());
+    batchPalette = nullptr;
+}
+
+void ModelInstance::evaluate(const GLTFAnimation::Pose& pose, glm::mat4* palette) {
+    // Locals straight into the world array, then world = parent world * local in place: parents come first
+    // in the evaluation order, so each parent is final before its children read it
+    GLTFTransformKernels::composeTRS(pose.translations.data(), pose.rotations.data(), pose.scales.data(),
+        nodeWorlds.data(), nodeWorlds.size());
+    const auto& parents = asset->getParents();
+    for (int node : asset->getEvaluationOrder()) {
+        int parent = parents[node];
+        if (parent >= 0) GLTFTransformKernels::multiplyAffine(nodeWorlds[parent], &nodeWorlds[node], &nodeWorlds[node], 1);
+    }
+    writePalette(nodeWorlds, palette);
+    morphWeights.assign(pose.morphWeights.begin(), pose.morphWeights.end());
+}
+
+void ModelInstance::writePalette(const std::vector<glm::mat4>& worlds, glm::mat4* palette) const {
+    // Same palette as GLTFSkeleton: relative to the node above the skeleton root, then the inverse bind
+    const auto& joints = asset->getJoints();
+    int cachedRootParent = -1;
+    glm::mat4 rootParentInverse(1.0f);
+    for (size_t i = 0; i < joints.size(); ++i) {
+        const auto& joint = joints[i];
+        glm::mat4 global = worlds[joint.node];
+        if (joint.rootParent >= 0) {
+            if (joint.rootParent != cachedRootParent) {
+                cachedRootParent = joint.rootParent;
+                rootParentInverse = glm::inverse(worlds[cachedRootParent]);
+            }
+            global = rootParentInverse * global;
+        }
+        palette[i] = global * joint.inverseBindMatrix;
+    }
+}
+
+void ModelInstance::setTransform(const glm::mat4& newTransform) {
+    transform = newTransform;
+}
+
+const glm::mat4& ModelInstance::getTransform() const {
+    return transform;
+}
+
+const std::vector<glm::mat4>& ModelInstance::getNodeWorlds() const {
+    return nodeWorlds;
+}
+
+const std::vector<float>& ModelInstance::getMorphWeights() const {
+    return morphWeights;
+}
+
+std::span<const glm::mat4> ModelInstance::getJointMatrices() const {
+    if (batchPalette) return std::span<const glm::mat4>(batchPalette, jointMatrices.size());
+    return jointMatrices;
+}
+
+void ModelInstance::render() const {
+    asset->render(*this);
+}
+
+size_t ModelInstance::getMemoryUsage() const {
+    return sizeof(*this)
+        + blender.getMemoryUsage()
+        + batchCursors.capacity() * sizeof(size_t)
+        + (lodFromWorlds.capacity() + lodToWorlds.capacity()) * sizeof(glm::mat4)
+        + (lodFromPalette.capacity() + lodToPalette.capacity()) * sizeof(glm::mat4)
+        + nodeWorlds.capacity() * sizeof(glm::mat4)
+        + jointMatrices.capacity() * sizeof(glm::mat4)
+        + morphWeights.capacity() * sizeof(float)
+        + (detailPose.translations.capacity() + detailPose.scales.capacity()) * sizeof(glm::vec3)
+        + detailPose.rotations.capacity() * sizeof(glm::quat)
+        + detailPose.morphWeights.capacity() * sizeof(float)
+        + detailPose.morphWeightOffsets.capacity() * sizeof(unsigned int);
+}
+
+const ModelAsset& ModelInstance::getAsset() const {
+    return *asset;
+}
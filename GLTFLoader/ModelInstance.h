@@ -0,0 +1,70 @@
+#ifndef MODEL_INSTANCE_H
+#define MODEL_INSTANCE_H
+
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "GLTFAnimationBlender.h"
+
+class ModelAsset;
+
+// One placed, animated copy of a shared ModelAsset. Holds only what differs between copies: the animation
+// state and its local pose, node world matrices, the skinning palette and a placement transform. A few
+// kilobytes for a typical character.
+class ModelInstance {
+public:
+    explicit ModelInstance(std::shared_ptr<const ModelAsset> asset);
+
+    void setAnimation(const std::string& animationName); // unknown names leave the rest pose
+    void crossfadeTo(const std::string& animationName, float fadeTime);
+    void setTime(float time);
+    float getTime() const;
+    // Layers, masks and the like; changes show after the next update
+    GLTFAnimationBlender& getBlender();
+    // Advances the clocks (looping), blends the animations and rebuilds world matrices and the palette
+    void update(float deltaTime);
+
+    void setTransform(const glm::mat4& transform);
+    const glm::mat4& getTransform() const;
+    const std::vector<glm::mat4>& getNodeWorlds() const;    // model space, by node index
+    // Morph target weights from the last evaluation, laid out by the asset's rest pose morphWeightOffsets
+    const std::vector<float>& getMorphWeights() const;
+    // The palette from the last update, or this instance's slot in the palettes of the ModelInstanceBatch
+    // that last evaluated it, valid until that batch evaluates again
+    std::span<const glm::mat4> getJointMatrices() const;
+
+    void render() const;
+    size_t getMemoryUsage() const; // bytes owned by this instance, the shared asset excluded
+    const ModelAsset& getAsset() const;
+
+private:
+    friend class ModelInstanceBatch;
+
+    std::shared_ptr<const ModelAsset> asset;
+    GLTFAnimationBlender blender;
+    int batchAnimation = -1;           // clip batchCursors belong to
+    std::vector<size_t> batchCursors;
+    // Animation LOD: between the batch's evaluations the drawn matrices move from the lodFrom copies to
+    // the lodTo copies over lodPeriod frames
+    std::vector<glm::mat4> lodFromWorlds, lodFromPalette;
+    std::vector<glm::mat4> lodToWorlds, lodToPalette;
+    unsigned long long lodUpdateFrame = 0;
+    unsigned int lodPeriod = 1;
+    // Local pose of the last batch evaluation that sampled every node; detail nodes the LOD skips keep
+    // their values from it. Empty until the batch has a detail bone size.
+    GLTFAnimation::Pose detailPose;
+    std::vector<glm::mat4> nodeWorlds;
+    std::vector<glm::mat4> jointMatrices;
+    std::vector<float> morphWeights;
+    const glm::mat4* batchPalette = nullptr; // drawn instead of jointMatrices when set
+    glm::mat4 transform = glm::mat4(1.0f);
+
+    void evaluate();
+    void evaluate(const GLTFAnimation::Pose& pose); // world matrices and palette from a local pose
+    void evaluate(const GLTFAnimation::Pose& pose, glm::mat4* palette); // palette written to palette[0..joints)
+    void writePalette(const std::vector<glm::mat4>& worlds, glm::mat4* palette) const;
+};
+
+#endif // MODEL_INSTANCE_H
@@ -0,0 +1,360 @@
+#include "ModelInstanceBatch.h"
+#include "ModelAsset.h"
+#include "ModelInstance.h"
+#include "GLTFTransformKernels.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace {
+    // Per worker thread and reused across frames, so a batch allocates only while these grow to the
+    // largest asset
+    struct Scratch {
+        GLTFAnimation::Pose pose;
+        GLTFAnimation::Pose sample;
+        std::vector<float> weights;
+        std::vector<size_t> cursors;
+    };
+    thread_local Scratch scratch;
+
+    void copyPose(const GLTFAnimation::Pose& from, GLTFAnimation::Pose& to) {
+        to.translations.assign(from.translations.begin(), from.translations.end());
+        to.rotations.assign(from.rotations.begin(), from.rotations.end());
+        to.scales.assign(from.scales.begin(), from.scales.end());
+        to.morphWeights.assign(from.morphWeights.begin(), from.morphWeights.end());
+        to.morphWeightOffsets.assign(from.morphWeightOffsets.begin(), from.morphWeightOffsets.end());
+    }
+
+    // Componentwise, so rotations come out slightly short of unit length mid-way; across the few frames
+    // between evaluations that is not visible. out may be from.
+    void lerpMatrices(const glm::mat4* from, const glm::mat4* to, size_t count, float t, glm::mat4* out) {
+        if (count == 0) return;
+        const float* a = &from[0][0][0];
+        const float* b = &to[0][0][0];
+        float* result = &out[0][0][0];
+        for (size_t i = 0; i < count * 16; ++i) result[i] = a[i] + (b[i] - a[i]) * t;
+    }
+}
+
+ModelInstanceBatch::ModelInstanceBatch(GLTFJobPool& pool) : pool(pool) {
+}
+
+void ModelInstanceBatch::evaluate(const std::vector<Entry>& entries) {
+    // Instances and their palette slots, in entry order
+    groupStarts.clear();
+    entryOffsets.resize(entries.size());
+    size_t paletteSize = 0;
+    size_t offset = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (i == 0 || entries[i].instance != entries[i - 1].instance) {
+            groupStarts.push_back(i);
+            offset = paletteSize;
+            paletteSize += entries[i].instance->getJointMatrices().size();
+        }
+        entryOffsets[i] = offset;
+    }
+    groupStarts.push_back(entries.size());
+    palettes.resize(paletteSize);
+
+    // Each level's instances take the frames of its cycle in turn, so every frame evaluates an equal share
+    auto start = std::chrono::high_resolution_clock::now();
+    const size_t instanceCount = groupStarts.size() - 1;
+    groupLevels.resize(instanceCount);
+    groupPhases.resize(instanceCount);
+    groupMasks.resize(instanceCount);
+    size_t levelCounts[kMaxLodLevel + 1] = {};
+    for (size_t group = 0; group < instanceCount; ++group) {
+        int level = getLodLevel(entries[groupStarts[group]]);
+        groupLevels[group] = level;
+        groupPhases[group] = levelCounts[level]++;
+        groupMasks[group] = level > 0 ? getDetailMask(entries[groupStarts[group]].instance->asset) : nullptr;
+    }
+    stats = Stats();
+    stats.instances = instanceCount;
+    pool.parallelFor(instanceCount, kInstancesPerChunk, [&](size_t begin, size_t end) {
+        Stats chunkStats;
+        for (size_t group = begin; group < end; ++group) {
+            size_t first = groupStarts[group];
+            evaluateInstance(&entries[first], groupStarts[group + 1] - first, palettes.data() + entryOffsets[first],
+                groupLevels[group], groupPhases[group], groupMasks[group], chunkStats);
+        }
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.evaluated += chunkStats.evaluated;
+        stats.interpolated += chunkStats.interpolated;
+        stats.skippedNodes += chunkStats.skippedNodes;
+        for (int level = 0; level <= kMaxLodLevel; ++level) stats.instancesPerLevel[level] += chunkStats.instancesPerLevel[level];
+    });
+    stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    ++frame;
+}
+
+int ModelInstanceBatch::getLodLevel(const Entry& entry) const {
+    const float distance = entry.importance > 0.0f ? entry.distance / entry.importance : FLT_MAX;
+    const int levels = std::min(kMaxLodLevel, static_cast<int>(lodSettings.levelDistances.size()));
+    int level = 0;
+    while (level < levels && distance > lodSettings.levelDistances[level]) ++level;
+    return level;
+}
+
+const ModelInstanceBatch::DetailMask* ModelInstanceBatch::getDetailMask(const std::shared_ptr<const ModelAsset>& asset) {
+    if (lodSettings.detailBoneSize <= 0.0f) return nullptr;
+    DetailMask& mask = detailMasks[asset.get()];
+    if (!mask.asset.expired()) return &mask;
+
+    mask.asset = asset;
+    const auto& boneSizes = asset->getBoneSizes();
+    mask.skipNodes.resize(boneSizes.size());
+    mask.nodes.clear();
+    for (size_t node = 0; node < boneSizes.size(); ++node) {
+        mask.skipNodes[node] = boneSizes[node] < lodSettings.detailBoneSize ? 1 : 0;
+        if (mask.skipNodes[node]) mask.nodes.push_back(static_cast<int>(node));
+    }
+    const auto& clips = asset->getAnimations().getAnimations();
+    mask.skippedBindings.assign(clips.size(), 0);
+    for (size_t clip = 0; clip < clips.size(); ++clip) {
+        const auto& bindings = clips[clip].bindings;
+        for (const auto* table : { &bindings.translations, &bindings.rotations, &bindings.scales, &bindings.weights }) {
+            for (const auto& binding : *table) {
+                if (binding.target >= 0 && binding.target < static_cast<int>(boneSizes.size()) && mask.skipNodes[binding.target]) {
+                    ++mask.skippedBindings[clip];
+                }
+            }
+        }
+    }
+    return &mask;
+}
+
+void ModelInstanceBatch::evaluateInstance(const Entry* entries, size_t count, glm::mat4* palette, int level, size_t phase,
+    const DetailMask* mask, Stats& chunkStats) const {
+    ModelInstance& instance = *entries[0].instance;
+    const ModelAsset& asset = *instance.asset;
+
+    // Reduced-rate instances evaluate on their own frame of the cycle. They start with an evaluation when
+    // the last one was at full rate, which leaves nothing to interpolate, and catch up straight away when a
+    // change of level left them waiting longer than a cycle.
+    const unsigned int period = 1u << level;
+    const size_t worldCount = instance.nodeWorlds.size();
+    const size_t jointCount = instance.jointMatrices.size();
+    ++chunkStats.instancesPerLevel[level];
+    instance.batchPalette = palette;
+    const bool due = period == 1 || instance.lodPeriod == 1 || (frame + phase) % period == 0
+        || frame - instance.lodUpdateFrame >= period;
+    if (!due) {
+        float t = std::min(1.0f, static_cast<float>(frame - instance.lodUpdateFrame + 1) / static_cast<float>(instance.lodPeriod));
+        lerpMatrices(instance.lodFromWorlds.data(), instance.lodToWorlds.data(), worldCount, t, instance.nodeWorlds.data());
+        lerpMatrices(instance.lodFromPalette.data(), instance.lodToPalette.data(), jointCount, t, palette);
+        ++chunkStats.interpolated;
+        return;
+    }
+    if (period > 1) {
+        // Interpolation starts from what was drawn last, so a new cycle never jumps. Evaluation overwrites
+        // every world matrix, so the drawn ones can be moved aside rather than copied. The drawn palette
+        // went straight to last frame's slot, so it is rebuilt: from the drawn worlds after a full-rate
+        // frame, otherwise by repeating last frame's interpolation in place.
+        instance.lodFromPalette.resize(jointCount);
+        instance.lodToPalette.resize(jointCount);
+        if (instance.lodPeriod == 1) {
+            instance.writePalette(instance.nodeWorlds, instance.lodFromPalette.data());
+        } else {
+            float t = std::min(1.0f, static_cast<float>(frame - instance.lodUpdateFrame) / static_cast<float>(instance.lodPeriod));
+            lerpMatrices(instance.lodFromPalette.data(), instance.lodToPalette.data(), jointCount, t, instance.lodFromPalette.data());
+        }
+        std::swap(instance.lodFromWorlds, instance.nodeWorlds);
+        instance.nodeWorlds.resize(worldCount);
+    }
+    const GLTFAnimation& animations = asset.getAnimations();
+    const GLTFAnimation::Pose& restPose = asset.getRestPose();
+
+    // Detail nodes are skipped only once there are sampled values for them to keep
+    Scratch& local = scratch;
+    if (instance.detailPose.translations.empty()) mask = nullptr;
+    const std::vector<unsigned char>* skipNodes = mask ? &mask->skipNodes : nullptr;
+    copyPose(restPose, local.pose);
+
+    // The heaviest clip is sampled straight into the pose and keeps its key cursors in the instance, so
+    // steady playback resumes from last frame's keys. The others follow in entry order as the same running
+    // weighted average as the blender's base clips.
+    size_t primary = count;
+    for (size_t i = 0; i < count; ++i) {
+        if (entries[i].weight > 0.0f && (primary == count || entries[i].weight > entries[primary].weight)) primary = i;
+    }
+    float totalWeight = 0.0f;
+    for (size_t k = 0; primary < count && k < count; ++k) {
+        const size_t i = k == 0 ? primary : (k <= primary ? k - 1 : k);
+        const Entry& entry = entries[i];
+        if (entry.weight <= 0.0f) continue;
+        totalWeight += entry.weight;
+        const bool first = k == 0;
+        GLTFAnimation::Pose& target = first ? local.pose : local.sample;
+        if (!first) copyPose(restPose, local.sample);
+
+        if (entry.animation >= 0 && entry.animation < static_cast<int>(animations.getAnimationCount())) {
+            float duration = animations.getDuration(entry.animation);
+            float time = entry.time;
+            if (duration > 0.0f) {
+                time = std::fmod(time, duration);
+                if (time < 0.0f) time += duration;
+            }
+            if (first && instance.batchAnimation != entry.animation) {
+                instance.batchAnimation = entry.animation;
+                instance.batchCursors.clear();
+            }
+            animations.sampleAnimation(entry.animation, time, target, first ? instance.batchCursors : local.cursors, skipNodes);
+            if (mask) chunkStats.skippedNodes += mask->skippedBindings[entry.animation];
+        }
+
+        if (!first) {
+            const size_t nodeCount = local.pose.translations.size();
+            const float share = entry.weight / totalWeight;
+            local.weights.assign(nodeCount, share);
+            GLTFTransformKernels::blendVec3(local.pose.translations.data(), local.sample.translations.data(), local.weights.data(), nodeCount);
+            GLTFTransformKernels::blendQuat(local.pose.rotations.data(), local.sample.rotations.data(), local.weights.data(), nodeCount);
+            GLTFTransformKernels::blendVec3(local.pose.scales.data(), local.sample.scales.data(), local.weights.data(), nodeCount);
+            // As GLTFAnimationBlender::blendMorphWeights with the same weight for every node
+            for (size_t w = 0; w < local.pose.morphWeights.size(); ++w) {
+                local.pose.morphWeights[w] += (local.sample.morphWeights[w] - local.pose.morphWeights[w]) * share;
+            }
+        }
+    }
+
+    // Skipped detail nodes hold their last sampled values rather than falling back to the rest pose
+    if (mask) {
+        const auto& offsets = local.pose.morphWeightOffsets;
+        for (int node : mask->nodes) {
+            local.pose.translations[node] = instance.detailPose.translations[node];
+            local.pose.rotations[node] = instance.detailPose.rotations[node];
+            local.pose.scales[node] = instance.detailPose.scales[node];
+            if (static_cast<size_t>(node) + 1 >= offsets.size()) continue;
+            for (unsigned int w = offsets[node]; w < offsets[node + 1]; ++w) local.pose.morphWeights[w] = instance.detailPose.morphWeights[w];
+        }
+    }
+    else if (lodSettings.detailBoneSize > 0.0f) {
+        copyPose(local.pose, instance.detailPose);
+    }
+
+    ++chunkStats.evaluated;
+    instance.lodUpdateFrame = frame;
+    instance.lodPeriod = period;
+    if (period == 1) {
+        instance.evaluate(local.pose, palette);
+        return;
+    }
+    instance.evaluate(local.pose, instance.lodToPalette.data());
+    std::swap(instance.lodToWorlds, instance.nodeWorlds);
+    instance.nodeWorlds.resize(worldCount);
+    const float t = 1.0f / static_cast<float>(period);
+    lerpMatrices(instance.lodFromWorlds.data(), instance.lodToWorlds.data(), worldCount, t, instance.nodeWorlds.data());
+    lerpMatrices(instance.lodFromPalette.data(), instance.lodToPalette.data(), jointCount, t, palette);
+}
+
+const std::vector<glm::mat4>& ModelInstanceBatch::getPalettes() const {
+    return palettes;
+}
+
+size_t ModelInstanceBatch::getPaletteOffset(size_t entry) const {
+    return entryOffsets[entry];
+}
+
+void ModelInstanceBatch::setLodSettings(const LodSettings& settings) {
+    lodSettings = settings;
+    detailMasks.clear();
+}
+
+const ModelInstanceBatch::Stats& ModelInstanceBatch::getStats() const {
+    return stats;
+}
+
+void ModelInstanceBatch::runBenchmark(std::shared_ptr<const ModelAsset> asset, size_t instanceCount, int frames) {
+    // Morph weights evaluated by a batch against the same clip played by a blender on the loader's rest pose
+    const GLTFLoader& loader = asset->getLoader();
+    const auto& clips = asset->getAnimations().getAnimations();
+    for (size_t clip = 0; clip < clips.size(); ++clip) {
+        if (clips[clip].bindings.weights.empty()) continue;
+        GLTFJobPool pool(1);
+        ModelInstanceBatch batch(pool);
+        ModelInstance instance(asset);
+        GLTFAnimationBlender reference;
+        reference.initialize(loader.getAnimationManager(), loader.getRestPose());
+        reference.crossfadeTo(static_cast<int>(clip), 0.0f);
+        float largestError = 0.0f;
+        for (int step = 0; step < 10; ++step) {
+            const float time = clips[clip].duration * static_cast<float>(step) / 10.0f;
+            Entry entry;
+            entry.instance = &instance;
+            entry.animation = static_cast<int>(clip);
+            entry.time = time;
+            batch.evaluate({ entry });
+            reference.setTime(time);
+            reference.update(0.0f);
+            const auto& expected = reference.getPose().morphWeights;
+            const auto& actual = instance.getMorphWeights();
+            if (actual.size() != expected.size()) {
+                largestError = FLT_MAX;
+                break;
+            }
+            for (size_t i = 0; i < actual.size(); ++i) largestError = std::max(largestError, std::abs(actual[i] - expected[i]));
+        }
+        std::cout << "Morph weights of clip " << clip << " (" << clips[clip].name << "), batch against the loader's blender: "
+            << (largestError < 1e-5f ? "match" : "MISMATCH") << ", largest difference " << largestError << std::endl;
+    }
+
+    std::vector<std::unique_ptr<ModelInstance>> instances;
+    std::vector<Entry> entries(instanceCount);
+    const int animation = asset->getAnimations().getAnimationCount() > 0 ? 0 : -1;
+    for (size_t i = 0; i < instanceCount; ++i) {
+        instances.push_back(std::make_unique<ModelInstance>(asset));
+        entries[i].instance = instances.back().get();
+        entries[i].animation = animation;
+    }
+
+    std::cout << "Batch of " << instanceCount << " instances, " << asset->getNodeCount() << " nodes and "
+        << asset->getJoints().size() << " joints each:" << std::endl;
+    const unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    double singleThread = 0.0;
+    for (unsigned int threads = 1; ; threads = std::min(threads * 2, hardwareThreads)) {
+        GLTFJobPool pool(threads);
+        ModelInstanceBatch batch(pool);
+        for (size_t i = 0; i < instanceCount; ++i) entries[i].time = static_cast<float>(i) * 0.013f;
+        batch.evaluate(entries); // sizes every scratch buffer
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int frame = 0; frame < frames; ++frame) {
+            for (auto& entry : entries) entry.time += 1.0f / 60.0f;
+            batch.evaluate(entries);
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / frames;
+        if (threads == 1) singleThread = ms;
+        std::cout << "  " << threads << " threads: " << ms << " ms per frame (x" << singleThread / ms << ")" << std::endl;
+        if (threads == hardwareThreads) break;
+    }
+
+    // Same crowd spread evenly over distance, so a quarter of it runs at each update rate
+    GLTFJobPool pool(hardwareThreads);
+    ModelInstanceBatch batch(pool);
+    LodSettings lod;
+    lod.levelDistances = { 25.0f, 50.0f, 75.0f };
+    lod.detailBoneSize = 0.05f;
+    batch.setLodSettings(lod);
+    for (size_t i = 0; i < instanceCount; ++i) entries[i].distance = 100.0f * static_cast<float>(i) / static_cast<float>(instanceCount);
+    batch.evaluate(entries);
+
+    Stats total;
+    double ms = 0.0;
+    for (int frame = 0; frame < frames; ++frame) {
+        for (auto& entry : entries) entry.time += 1.0f / 60.0f;
+        batch.evaluate(entries);
+        const Stats& last = batch.getStats();
+        total.evaluated += last.evaluated;
+        total.interpolated += last.interpolated;
+        total.skippedNodes += last.skippedNodes;
+        ms += last.milliseconds;
+    }
+    const Stats& last = batch.getStats();
+    std::cout << "  with animation LOD, " << hardwareThreads << " threads: " << ms / frames << " ms per frame; per frame "
+        << total.evaluated / frames << " evaluated, " << total.interpolated / frames << " interpolated, "
+        << total.skippedNodes / frames << " detail channels skipped; instances at full, 1/2, 1/4, 1/8 rate: "
+        << last.instancesPerLevel[0] << ", " << last.instancesPerLevel[1] << ", " << last.instancesPerLevel[2] << ", "
+        << last.instancesPerLevel[3] << std::endl;
+}
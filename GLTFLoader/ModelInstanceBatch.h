@@ -0,0 +1,97 @@
+#ifndef MODEL_INSTANCE_BATCH_H
+#define MODEL_INSTANCE_BATCH_H
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include "GLTFJobPool.h"
+
+class ModelAsset;
+class ModelInstance;
+
+// Animates many ModelInstances in one call. Local poses, world matrices and skinning palettes are computed
+// per instance in chunks spread over a GLTFJobPool, and every palette lands in one contiguous array ready
+// for a single upload. The clips come from the entries; the instances' own blenders are not used.
+class ModelInstanceBatch {
+public:
+    struct Entry {
+        ModelInstance* instance = nullptr;
+        int animation = -1;  // clip of the instance's asset, -1 for the rest pose
+        float time = 0.0f;   // seconds, wrapped to the clip's duration
+        float weight = 1.0f; // relative to the instance's other entries
+        float distance = 0.0f;   // from the camera, for animation LOD; read from an instance's first entry
+        float importance = 1.0f; // divides distance, so important instances keep full detail for longer
+    };
+
+    // Animation level of detail. An instance whose distance / importance passes levelDistances[k] is
+    // evaluated every 2^(k+1) frames instead of every frame, with instances spread evenly over the frames
+    // of each cycle, and its matrices are interpolated in between. The interpolation trails the evaluated
+    // pose by up to one cycle. No distances evaluates everything every frame.
+    struct LodSettings {
+        std::vector<float> levelDistances; // increasing; the first three give 1/2, 1/4 and 1/8 rate
+        float detailBoneSize = 0.0f;       // at reduced rates, nodes below this ModelAsset::getBoneSizes() share keep their last sampled pose
+    };
+
+    // Cost of the last evaluate() and what the LOD saved
+    struct Stats {
+        size_t instances = 0;
+        size_t evaluated = 0;             // sampled and rebuilt
+        size_t interpolated = 0;          // blended between earlier evaluations instead
+        size_t instancesPerLevel[4] = {}; // by update rate: every frame, 1/2, 1/4, 1/8
+        size_t skippedNodes = 0;          // animated channels of detail nodes left unsampled, over the evaluated instances
+        double milliseconds = 0.0;
+    };
+
+    explicit ModelInstanceBatch(GLTFJobPool& pool);
+
+    // Entries for one instance must be adjacent; their clips are blended by weight like a crossfade.
+    // Each instance keeps its own world matrices for drawing; its getJointMatrices() is its slot in getPalettes().
+    void evaluate(const std::vector<Entry>& entries);
+
+    const std::vector<glm::mat4>& getPalettes() const; // all instances' palettes, back to back
+    size_t getPaletteOffset(size_t entry) const;       // first matrix of that entry's instance
+
+    void setLodSettings(const LodSettings& settings);
+    const Stats& getStats() const;
+
+    // Plays the asset's first clip on instanceCount instances at staggered times, with pools of 1, 2, 4, ...
+    // threads up to the hardware count, and prints the time per frame and the speedup over one thread.
+    // Then repeats on all threads with the instances spread over every LOD level and prints the stats.
+    // First checks the batch's morph weights against the loader's own blender on every clip that has any.
+    static void runBenchmark(std::shared_ptr<const ModelAsset> asset, size_t instanceCount = 10000, int frames = 20);
+
+private:
+    static const size_t kInstancesPerChunk = 16;
+    static const int kMaxLodLevel = 3;
+
+    // The nodes one asset skips at reduced rates, for the current detailBoneSize
+    struct DetailMask {
+        std::weak_ptr<const ModelAsset> asset; // expired if the address now belongs to another asset
+        std::vector<unsigned char> skipNodes;  // by node, for GLTFAnimation::sampleAnimation
+        std::vector<int> nodes;
+        std::vector<size_t> skippedBindings;   // by clip, its bindings that target a skipped node
+    };
+
+    GLTFJobPool& pool;
+    std::vector<size_t> groupStarts; // first entry of each instance, then entries.size()
+    std::vector<size_t> entryOffsets;
+    std::vector<int> groupLevels;    // LOD level of each instance this frame
+    std::vector<size_t> groupPhases; // position among the instances at the same level
+    std::vector<const DetailMask*> groupMasks; // null at full rate or without a detail bone size
+    std::unordered_map<const ModelAsset*, DetailMask> detailMasks; // built on an asset's first use
+    std::vector<glm::mat4> palettes;
+    LodSettings lodSettings;
+    Stats stats;
+    std::mutex statsMutex;
+    unsigned long long frame = 0;
+
+    int getLodLevel(const Entry& entry) const;
+    const DetailMask* getDetailMask(const std::shared_ptr<const ModelAsset>& asset);
+    // phase staggers reduced-rate instances over the frames of their cycle
+    void evaluateInstance(const Entry* entries, size_t count, glm::mat4* palette, int level, size_t phase,
+        const DetailMask* mask, Stats& chunkStats) const;
+};
+
+#endif // MODEL_INSTANCE_BATCH_H